@@ -0,0 +1,89 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "generator.hpp"
+
+#include <convert.hpp>
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cgns_tools::bench {
+
+namespace {
+
+template <typename T>
+std::vector<gridCoordinateDataV> coordinates(const meshOptions &options,
+                                             const unsigned zone) {
+  const std::size_t n = options.nVertex;
+  const std::size_t nk = options.dimension == 3 ? n : 1;
+  const T h = T(1) / static_cast<T>(n - 1);
+
+  static constexpr std::array<const char *, 3> names = {
+      "CoordinateX", "CoordinateY", "CoordinateZ"};
+
+  std::vector<gridCoordinateDataV> arrays{};
+  for (unsigned d = 0; d < options.dimension; ++d) {
+    buffer<T> data(n * n * nk);
+    std::size_t idx = 0;
+    for (std::size_t k = 0; k < nk; ++k) {
+      for (std::size_t j = 0; j < n; ++j) {
+        for (std::size_t i = 0; i < n; ++i, ++idx) {
+          const std::array<std::size_t, 3> ijk = {i, j, k};
+          data[idx] = static_cast<T>(ijk[d]) * h + (d == 0 ? T(zone) : T(0));
+        }
+      }
+    }
+    arrays.emplace_back(dataArray<T>{names[d], std::move(data)});
+  }
+  return arrays;
+}
+
+} // namespace
+
+root generate(const meshOptions &options) {
+  const unsigned dim = options.dimension;
+
+  base b{"Base", dim, dim};
+
+  for (unsigned z = 0; z < options.nZones; ++z) {
+    std::vector<gridCoordinatesT> grids{};
+    grids.emplace_back("GridCoordinates",
+                       options.doublePrecision
+                           ? coordinates<double>(options, z)
+                           : coordinates<float>(options, z));
+
+    zoneStructured zone{"Zone" + std::to_string(z + 1),
+                        std::vector<cgsize_t>(dim, options.nVertex),
+                        std::vector<cgsize_t>(dim, options.nVertex - 1),
+                        std::vector<cgsize_t>(dim, 0), std::move(grids)};
+
+    if (options.unstructured) {
+      b.zones.emplace_back(toUnstructured(std::move(zone)));
+    } else {
+      b.zones.emplace_back(std::move(zone));
+    }
+  }
+
+  root r{};
+  r.bases.push_back(std::move(b));
+  return r;
+}
+
+void generateFile(const std::string &path, const meshOptions &options) {
+  writeFile(path, generate(options));
+}
+
+std::size_t coordinateBytes(const meshOptions &options) {
+  std::size_t nVertex = 1;
+  for (unsigned d = 0; d < options.dimension; ++d) {
+    nVertex *= options.nVertex;
+  }
+  return std::size_t{options.nZones} * nVertex * options.dimension *
+         (options.doublePrecision ? sizeof(double) : sizeof(float));
+}
+
+} // namespace cgns_tools::bench
@@ -0,0 +1,41 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include <cgns-tools.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace cgns_tools::bench {
+
+/// layout of a synthetic mesh
+struct meshOptions {
+  /// number of zones of the single base
+  unsigned nZones = 1;
+
+  /// number of vertices per direction of each zone
+  unsigned nVertex = 33;
+
+  /// 2d (QUAD_4) or 3d (HEXA_8) zones
+  unsigned dimension = 3;
+
+  /// coordinates stored as RealDouble if true, as RealSingle otherwise
+  bool doublePrecision = true;
+
+  /// zones converted to unstructured
+  bool unstructured = false;
+};
+
+/// @brief synthetic cgns hierarchy: a single base of cartesian zones shifted
+/// in x so that they do not overlap
+root generate(const meshOptions &);
+
+/// generate the mesh and write it through fileOut to the given path
+void generateFile(const std::string &path, const meshOptions &);
+
+/// number of bytes of coordinate data of the mesh
+std::size_t coordinateBytes(const meshOptions &);
+
+} // namespace cgns_tools::bench
@@ -0,0 +1,582 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "generator.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cgns-tools.hpp>
+#include <convert.hpp>
+#include <geometry.hpp>
+#include <logger.hpp>
+#include <merge.hpp>
+#include <pipeline.hpp>
+#include <spdlog/sinks/null_sink.h>
+#include <sys/resource.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using namespace cgns_tools;
+
+/// mesh described by the benchmark arguments
+bench::meshOptions meshOf(const benchmark::State &state) {
+  bench::meshOptions options{};
+  options.nZones = static_cast<unsigned>(state.range(0));
+  options.nVertex = static_cast<unsigned>(state.range(1));
+  options.dimension = static_cast<unsigned>(state.range(2));
+  options.doublePrecision = state.range(3) != 0;
+  options.unstructured = state.range(4) != 0;
+  return options;
+}
+
+/// @brief path of a generated file with the given layout, files are written
+/// once per process and removed at exit
+const std::string &meshFile(const bench::meshOptions &options) {
+  struct files {
+    ~files() {
+      for (const auto &[key, path] : paths) {
+        std::filesystem::remove(path);
+      }
+    }
+    std::map<std::string, std::string> paths;
+  };
+  static files generated{};
+
+  const std::string key = fmt::format(
+      "{}z{}v{}d{}{}", options.nZones, options.nVertex, options.dimension,
+      options.doublePrecision ? "r8" : "r4", options.unstructured ? "u" : "s");
+
+  auto it = generated.paths.find(key);
+  if (it == generated.paths.end()) {
+    const auto path = std::filesystem::temp_directory_path() /
+                      ("cgns-tools-bench-" + key + ".cgns");
+    bench::generateFile(path.string(), options);
+    it = generated.paths.emplace(key, path.string()).first;
+  }
+  return it->second;
+}
+
+/// scratch file the write benchmarks write to
+std::string outFile() {
+  return (std::filesystem::temp_directory_path() / "cgns-tools-bench-out.cgns")
+      .string();
+}
+
+/// report throughput of the given mesh processed once per iteration
+void setCounters(benchmark::State &state, const bench::meshOptions &options) {
+  const double iterations = static_cast<double>(state.iterations());
+  state.counters["MB/s"] = benchmark::Counter(
+      iterations * static_cast<double>(bench::coordinateBytes(options)) / 1e6,
+      benchmark::Counter::kIsRate);
+  state.counters["zones/s"] = benchmark::Counter(
+      iterations * options.nZones, benchmark::Counter::kIsRate);
+}
+
+/// peak resident set size of the process in MB
+double peakRSS() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<double>(usage.ru_maxrss) / 1e3;
+}
+
+/// @brief bytes currently allocated from the heap, 0 if unknown (requires
+/// glibc 2.33)
+std::size_t heapInUse() {
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+  const auto info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#endif
+#endif
+  return 0;
+}
+
+/// zone with the size of the given one but without any arrays
+zoneV header(const zoneV &zone) {
+  return std::visit(
+      overloaded{[](const zoneStructured &z) -> zoneV {
+                   return zoneStructured{std::string{z.name},
+                                         std::vector<cgsize_t>{z.nVertex},
+                                         std::vector<cgsize_t>{z.nCell},
+                                         std::vector<cgsize_t>{z.nBoundVertex},
+                                         {}};
+                 },
+                 [](const zoneUnstructured &z) -> zoneV {
+                   return zoneUnstructured{std::string{z.name}, z.nVertex,
+                                           z.nCell, z.nBoundVertex, {}};
+                 }},
+      zone);
+}
+
+const std::vector<gridCoordinatesT> &grids(const zoneV &zone) {
+  return std::visit(
+      [](const auto &z) -> const std::vector<gridCoordinatesT> & {
+        return z.gridCoordinates;
+      },
+      zone);
+}
+
+void BM_parse(benchmark::State &state) {
+  const auto options = meshOf(state);
+  const auto &path = meshFile(options);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parse(path));
+  }
+  setCounters(state, options);
+}
+
+/// @brief parse of 64 zones with state.range(0) reader threads. The reads
+/// only overlap with a library built with CGNS_TOOLS_THREADSAFE_CGNS.
+void BM_parseThreads(benchmark::State &state) {
+  bench::meshOptions options{};
+  options.nZones = 64;
+  const auto &path = meshFile(options);
+
+  parseOptions threads{};
+  threads.nThreads = static_cast<unsigned>(state.range(0));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parse(path, threads));
+  }
+  setCounters(state, options);
+}
+
+/// @brief metadata-only parse, the arrays are not read. Reports the bytes of
+/// bulk data read per parse, which is 0 unless metadata pulls in bulk data.
+void BM_parseLazy(benchmark::State &state) {
+  const auto options = meshOf(state);
+  const auto &path = meshFile(options);
+
+  parseOptions lazy{};
+  lazy.lazy = true;
+
+  std::uint64_t bytesRead = 0;
+  for (auto _ : state) {
+    const auto f = std::make_shared<fileIn>(path, lazy);
+    benchmark::DoNotOptimize(root{f->readBaseInformation()});
+    bytesRead = f->bytesRead();
+  }
+  setCounters(state, options);
+  state.counters["bytesRead"] = static_cast<double>(bytesRead);
+}
+
+void BM_writeFile(benchmark::State &state) {
+  const auto options = meshOf(state);
+  const root r = bench::generate(options);
+  const auto path = outFile();
+  for (auto _ : state) {
+    writeFile(path, r);
+  }
+  setCounters(state, options);
+  std::filesystem::remove(path);
+}
+
+void BM_readZone(benchmark::State &state) {
+  const auto options = meshOf(state);
+  const fileIn f{meshFile(options)};
+  for (auto _ : state) {
+    for (unsigned Z = 1; Z <= options.nZones; ++Z) {
+      benchmark::DoNotOptimize(f.readZone(1, static_cast<int>(Z)));
+    }
+  }
+  setCounters(state, options);
+}
+
+void BM_readZoneGridCoordinates(benchmark::State &state) {
+  const auto options = meshOf(state);
+  const fileIn f{meshFile(options)};
+
+  std::vector<std::vector<cgsize_t>> nVertex{};
+  for (unsigned Z = 1; Z <= options.nZones; ++Z) {
+    nVertex.push_back(f.readZoneVertexSize(1, static_cast<int>(Z)));
+  }
+
+  for (auto _ : state) {
+    for (unsigned Z = 1; Z <= options.nZones; ++Z) {
+      benchmark::DoNotOptimize(
+          f.readZoneGridCoordinates(1, static_cast<int>(Z), nVertex[Z - 1]));
+    }
+  }
+  setCounters(state, options);
+}
+
+void BM_writeZoneInformation(benchmark::State &state) {
+  const auto options = meshOf(state);
+  const root r = bench::generate(options);
+  const auto path = outFile();
+
+  std::optional<fileOut> f{};
+  for (auto _ : state) {
+    state.PauseTiming();
+    f.reset();
+    f.emplace(path);
+    const int B = f->writeBaseHeader(r.bases.front());
+    state.ResumeTiming();
+
+    for (const auto &zone : r.bases.front().zones) {
+      f->writeZoneInformation(B, zone);
+    }
+  }
+  f.reset();
+  setCounters(state, options);
+  std::filesystem::remove(path);
+}
+
+void BM_writeZoneGridCoordinates(benchmark::State &state) {
+  const auto options = meshOf(state);
+  const root r = bench::generate(options);
+  const auto path = outFile();
+
+  const auto &zones = r.bases.front().zones;
+  std::vector<zoneV> headers{};
+  for (const auto &zone : zones) {
+    headers.push_back(header(zone));
+  }
+
+  std::optional<fileOut> f{};
+  for (auto _ : state) {
+    state.PauseTiming();
+    f.reset();
+    f.emplace(path);
+    const int B = f->writeBaseHeader(r.bases.front());
+    for (const auto &zone : headers) {
+      f->writeZoneInformation(B, zone);
+    }
+    state.ResumeTiming();
+
+    for (std::size_t Z = 1; Z <= zones.size(); ++Z) {
+      for (const auto &grid : grids(zones[Z - 1])) {
+        f->writeZoneGridCoordinates(B, static_cast<int>(Z), grid);
+      }
+    }
+  }
+  f.reset();
+  setCounters(state, options);
+  std::filesystem::remove(path);
+}
+
+/// @brief conversion of structured zones to unstructured including the write,
+/// where the connectivity is generated chunk by chunk. The peak RSS is that
+/// of the process, run a single case with --benchmark_filter to isolate it.
+void BM_toUnstructured(benchmark::State &state) {
+  auto options = meshOf(state);
+  options.unstructured = false;
+  const auto path = outFile();
+
+  cgsize_t nCells = options.nZones;
+  for (unsigned d = 0; d < options.dimension; ++d) {
+    nCells *= options.nVertex - 1;
+  }
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    root r = bench::generate(options);
+    state.ResumeTiming();
+
+    writeFile(path, toUnstructured(std::move(r)));
+  }
+  setCounters(state, options);
+  state.counters["cells/s"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * static_cast<double>(nCells),
+      benchmark::Counter::kIsRate);
+  state.counters["peakRSS_MB"] = peakRSS();
+  std::filesystem::remove(path);
+}
+
+/// @brief end to end copy, phased (pipelined = 0): parse then writeFile, or
+/// zone by zone through copyPipelined (pipelined = 1)
+void BM_copy(benchmark::State &state) {
+  bench::meshOptions options{};
+  options.nZones = static_cast<unsigned>(state.range(0));
+  options.nVertex = 65;
+  const auto &path = meshFile(options);
+  const auto out = outFile();
+
+  const bool pipelined = state.range(1) != 0;
+  const pipelineOptions pipeline{};
+
+  // both paths read into the heap, sampled while the zones are in flight
+  parseOptions read{};
+  read.useArena = false;
+
+  const std::size_t baseline = heapInUse();
+  std::size_t peak = baseline;
+  const zoneTransform sample = [&peak](zoneV &&zone) {
+    peak = std::max(peak, heapInUse());
+    return std::move(zone);
+  };
+
+  for (auto _ : state) {
+    if (pipelined) {
+      copyPipelined(path, out, sample, pipeline);
+    } else {
+      root r = parse(path, read);
+      peak = std::max(peak, heapInUse());
+      writeFile(out, std::move(r));
+    }
+  }
+  setCounters(state, options);
+  state.counters["peakRSS_MB"] = peakRSS();
+  state.counters["heapPeak_MB"] = static_cast<double>(peak - baseline) / 1e6;
+  std::filesystem::remove(out);
+
+  // the zones in flight plus two zones of slack for the file handles
+  const std::size_t zoneBytes =
+      bench::coordinateBytes(options) / options.nZones;
+  if (pipelined && peak - baseline > (2 * pipeline.depth + 5) * zoneBytes) {
+    state.SkipWithError("pipelined copy exceeds its bounded memory");
+  }
+}
+
+/// @brief parse and release of a generated file of state.range(0) zones of
+/// state.range(1)^3 vertices, with the bulk data in an arena (arena = 1) or on
+/// the global heap (arena = 0)
+void BM_allocate(benchmark::State &state) {
+  bench::meshOptions options{};
+  options.nZones = static_cast<unsigned>(state.range(0));
+  options.nVertex = static_cast<unsigned>(state.range(1));
+  const auto &path = meshFile(options);
+
+  parseOptions read{};
+  read.useArena = state.range(2) != 0;
+
+  for (auto _ : state) {
+    const root r = parse(path, read);
+    benchmark::DoNotOptimize(r.bases.data());
+  }
+  setCounters(state, options);
+}
+
+/// @brief metrics of a single zone of state.range(0)^3 vertices in double
+/// (double = 1) or single precision, with or without face vectors. The flop
+/// counts follow the kernels: 239 per cell volume and 18 per face vector.
+template <typename T> void metrics(benchmark::State &state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  metricsOptions options{};
+  options.faceVectors = state.range(2) != 0;
+
+  std::vector<T> x(n * n * n), y(n * n * n), z(n * n * n);
+  for (std::size_t k = 0, idx = 0; k < n; ++k) {
+    for (std::size_t j = 0; j < n; ++j) {
+      for (std::size_t i = 0; i < n; ++i, ++idx) {
+        x[idx] = static_cast<T>(i + 0.1 * j);
+        y[idx] = static_cast<T>(j);
+        z[idx] = static_cast<T>(k + 0.1 * i);
+      }
+    }
+  }
+
+  const cgsize_t nv = static_cast<cgsize_t>(n);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        computeMetrics<T>({nv, nv, nv}, x.data(), y.data(), z.data(), options));
+  }
+
+  const double nCells = static_cast<double>((n - 1) * (n - 1) * (n - 1));
+  const double nFaces = 3.0 * static_cast<double>(n * (n - 1) * (n - 1));
+  const double flops =
+      239.0 * nCells + (options.faceVectors ? 18.0 * nFaces : 0.0);
+  state.counters["GFLOP/s"] =
+      benchmark::Counter(static_cast<double>(state.iterations()) * flops / 1e9,
+                         benchmark::Counter::kIsRate);
+  state.counters["cells/s"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * nCells,
+      benchmark::Counter::kIsRate);
+}
+
+void BM_computeMetrics(benchmark::State &state) {
+  if (state.range(1) != 0) {
+    metrics<double>(state);
+  } else {
+    metrics<float>(state);
+  }
+}
+
+/// backend options of the storage benchmarks: file type, compression
+writeOptions storageOf(const benchmark::State &state) {
+  writeOptions options{};
+  options.type = static_cast<fileType>(state.range(0));
+  options.compression = static_cast<int>(state.range(1));
+  return options;
+}
+
+/// mesh of the storage benchmarks
+bench::meshOptions storageMesh() {
+  bench::meshOptions options{};
+  options.nZones = 16;
+  options.nVertex = 65;
+  return options;
+}
+
+/// size of the written file in MB
+void setFileSize(benchmark::State &state, const std::string &path) {
+  state.counters["fileMB"] =
+      static_cast<double>(std::filesystem::file_size(path)) / 1e6;
+}
+
+void BM_writeStorage(benchmark::State &state) {
+  const auto mesh = storageMesh();
+  const auto options = storageOf(state);
+  const root r = bench::generate(mesh);
+  const auto path = outFile();
+  for (auto _ : state) {
+    writeFile(path, r, options);
+  }
+  setCounters(state, mesh);
+  setFileSize(state, path);
+  std::filesystem::remove(path);
+}
+
+void BM_readStorage(benchmark::State &state) {
+  const auto mesh = storageMesh();
+  const auto path = outFile();
+  writeFile(path, bench::generate(mesh), storageOf(state));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parse(path));
+  }
+  setCounters(state, mesh);
+  setFileSize(state, path);
+  std::filesystem::remove(path);
+}
+
+/// @brief parse of a file with 10k small zones at runtime log level
+/// state.range(0). Messages go to a null sink, so only the cost of the
+/// enabled log calls is measured.
+void BM_parseLogLevel(benchmark::State &state) {
+  bench::meshOptions options{};
+  options.nZones = 10000;
+  options.nVertex = 5;
+  const auto &path = meshFile(options);
+
+  const auto previous = spdlog::default_logger();
+  auto logger = std::make_shared<spdlog::logger>(
+      "null", std::make_shared<spdlog::sinks::null_sink_mt>());
+  logger->set_level(static_cast<spdlog::level::level_enum>(state.range(0)));
+  spdlog::set_default_logger(logger);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parse(path));
+  }
+
+  spdlog::set_default_logger(previous);
+  const auto level = spdlog::level::to_string_view(logger->level());
+  state.SetLabel(std::string(level.data(), level.size()));
+  setCounters(state, options);
+}
+
+/// @brief parse of many small zones as generated (merged = 0) and after
+/// merging them into a single unstructured zone (merged = 1)
+void BM_parseMerged(benchmark::State &state) {
+  bench::meshOptions options{};
+  options.nZones = static_cast<unsigned>(state.range(0));
+  options.nVertex = 5;
+
+  const bool merged = state.range(1) != 0;
+  const auto path = merged ? outFile() : meshFile(options);
+  if (merged) {
+    writeFile(path, merge(bench::generate(options)));
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parse(path));
+  }
+  setCounters(state, options);
+  setFileSize(state, path);
+
+  if (merged) {
+    std::filesystem::remove(path);
+  }
+}
+
+/// mesh layouts: zones, vertices per direction, dimension, double, unstructured
+void meshes(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"zones", "vertices", "dim", "double", "unstructured"});
+  b->Args({64, 33, 3, 1, 0});
+  b->Args({64, 33, 3, 0, 0});
+  b->Args({1, 129, 3, 1, 0});
+  b->Args({256, 65, 2, 1, 0});
+  b->Args({64, 33, 3, 1, 1});
+  b->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_parse)->Apply(meshes);
+BENCHMARK(BM_parseLazy)->Apply(meshes);
+BENCHMARK(BM_parseThreads)
+    ->ArgName("threads")
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_writeFile)->Apply(meshes);
+BENCHMARK(BM_readZone)->Apply(meshes);
+BENCHMARK(BM_readZoneGridCoordinates)->Apply(meshes);
+BENCHMARK(BM_writeZoneInformation)->Apply(meshes);
+BENCHMARK(BM_writeZoneGridCoordinates)->Apply(meshes);
+BENCHMARK(BM_toUnstructured)
+    ->ArgNames({"zones", "vertices", "dim", "double", "unstructured"})
+    ->Args({1, 129, 3, 1, 0})
+    ->Args({1, 257, 3, 1, 0})
+    ->Args({64, 33, 3, 1, 0})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_copy)
+    ->ArgNames({"zones", "pipelined"})
+    ->ArgsProduct({{16, 64}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_allocate)
+    ->ArgNames({"zones", "vertices", "arena"})
+    ->ArgsProduct({{4096}, {9}, {0, 1}})
+    ->ArgsProduct({{1}, {129}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_computeMetrics)
+    ->ArgNames({"vertices", "double", "faces"})
+    ->ArgsProduct({{65, 257}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(BM_writeStorage)
+    ->ArgNames({"type", "compression"})
+    ->ArgsProduct({{CG_FILE_HDF5}, {0, 1, 6}})
+    ->Args({CG_FILE_ADF, 0})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_readStorage)
+    ->ArgNames({"type", "compression"})
+    ->ArgsProduct({{CG_FILE_HDF5}, {0, 1, 6}})
+    ->Args({CG_FILE_ADF, 0})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_parseMerged)
+    ->ArgNames({"zones", "merged"})
+    ->ArgsProduct({{1000, 10000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_parseLogLevel)
+    ->ArgName("level")
+    ->DenseRange(SPDLOG_LEVEL_TRACE, SPDLOG_LEVEL_WARN)
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  spdlog::set_level(spdlog::level::warn);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,151 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+// Write bandwidth of the parallel writer against the serial writeFile. Run
+// with mpirun, only rank 0 reports. The iteration times are the maximum over
+// all ranks, so every rank runs the same number of collective iterations.
+
+#include "generator.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cgns-tools-mpi.hpp>
+#include <logger.hpp>
+
+#include <filesystem>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using namespace cgns_tools;
+
+/// reporter of the ranks other than 0
+class nullReporter : public benchmark::BenchmarkReporter {
+public:
+  bool ReportContext(const Context &) override { return true; }
+  void ReportRuns(const std::vector<Run> &) override {}
+};
+
+/// scratch file all ranks write to
+std::string outFile() {
+  return (std::filesystem::temp_directory_path() /
+          "cgns-tools-bench-mpi-out.cgns")
+      .string();
+}
+
+/// mesh described by the benchmark arguments: zones, vertices per direction
+bench::meshOptions meshOf(const benchmark::State &state) {
+  bench::meshOptions options{};
+  options.nZones = static_cast<unsigned>(state.range(0));
+  options.nVertex = static_cast<unsigned>(state.range(1));
+  return options;
+}
+
+/// seconds since start, maximum over all ranks
+double elapsed(const double start) {
+  double seconds = MPI_Wtime() - start;
+  MPI_Allreduce(MPI_IN_PLACE, &seconds, 1, MPI_DOUBLE, MPI_MAX,
+                MPI_COMM_WORLD);
+  return seconds;
+}
+
+void setCounters(benchmark::State &state, const bench::meshOptions &options) {
+  state.counters["MB/s"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) *
+          static_cast<double>(bench::coordinateBytes(options)) / 1e6,
+      benchmark::Counter::kIsRate);
+}
+
+/// whole zones distributed round robin, each rank holds its zones only
+void BM_writeFileParallel(benchmark::State &state) {
+  const auto options = meshOf(state);
+  const auto own = zonesRoundRobin(MPI_COMM_WORLD);
+
+  root r = bench::generate(options);
+  auto &zones = r.bases.front().zones;
+  for (std::size_t z = 0; z < zones.size(); ++z) {
+    if (own(1, static_cast<int>(z + 1), zones[z])) {
+      continue;
+    }
+    // same metadata on all ranks, but no data
+    auto &grid = std::get<zoneStructured>(zones[z]).gridCoordinates.front();
+    for (auto &array : grid.dataArrays) {
+      std::visit(
+          [](auto &da) {
+            using T = typename std::decay_t<decltype(da)>::value_type;
+            da = {std::move(da.name), buffer<T>{}};
+          },
+          array);
+    }
+  }
+
+  const auto path = outFile();
+  for (auto _ : state) {
+    MPI_Barrier(MPI_COMM_WORLD);
+    const double start = MPI_Wtime();
+    writeFileParallel(MPI_COMM_WORLD, path, r, own);
+    state.SetIterationTime(elapsed(start));
+  }
+  setCounters(state, options);
+}
+
+/// the whole mesh written by rank 0 through the serial library
+void BM_writeFile(benchmark::State &state) {
+  const auto options = meshOf(state);
+
+  int rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  const root r = rank == 0 ? bench::generate(options) : root{};
+
+  const auto path = outFile();
+  for (auto _ : state) {
+    MPI_Barrier(MPI_COMM_WORLD);
+    const double start = MPI_Wtime();
+    if (rank == 0) {
+      writeFile(path, r);
+    }
+    state.SetIterationTime(elapsed(start));
+  }
+  setCounters(state, options);
+}
+
+void meshes(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"zones", "vertices"});
+  b->Args({16, 65});
+  b->Args({64, 65});
+  b->Args({4, 257});
+  b->UseManualTime();
+  b->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_writeFileParallel)->Apply(meshes);
+BENCHMARK(BM_writeFile)->Apply(meshes);
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  spdlog::set_level(spdlog::level::warn);
+
+  int rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  benchmark::Initialize(&argc, argv);
+  if (rank == 0) {
+    benchmark::RunSpecifiedBenchmarks();
+  } else {
+    nullReporter reporter{};
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+  }
+  benchmark::Shutdown();
+
+  if (rank == 0) {
+    std::filesystem::remove(outFile());
+  }
+
+  MPI_Finalize();
+  return 0;
+}
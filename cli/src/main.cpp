@@ -2,8 +2,256 @@
 // This code is licensed under MIT license (see LICENSE.txt for details)
 
 #include <cgns-tools.hpp>
+#include <convert.hpp>
+#include <info.hpp>
 #include <iostream>
 #include <logger.hpp>
+#include <merge.hpp>
+#include <quality.hpp>
+#include <split.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+void usage() {
+  std::cerr
+      << "usage: cgns-tools-cli <command> [options] [SPDLOG_LEVEL=<level>]\n"
+      << "\n"
+      << "commands:\n"
+      << "  copy <in> <out>      parse a file and write it again\n"
+      << "  convert <in> <out>   convert structured zones to unstructured\n"
+      << "    --single           write real arrays in single precision\n"
+      << "    --compression <n>  deflate level (0 - 9) of the datasets\n"
+      << "    --alignment <KiB>  align datasets of at least this size\n"
+      << "    --adf              write an ADF instead of an HDF5 file\n"
+      << "  merge <in> <out>     merge the zones of each base into a single\n"
+      << "                       unstructured zone, accepts the convert options\n"
+      << "    --family           merge the zones of each family separately\n"
+      << "  split <in> <out>     split structured zones for load balancing,\n"
+      << "                       accepts the convert options\n"
+      << "    --ranks <n>        number of ranks the zones are distributed to\n"
+      << "    --cells <n>        largest number of cells of a zone\n"
+      << "  info <in>...         print the metadata of files without reading\n"
+      << "                       bulk data\n"
+      << "    --json             print json\n"
+      << "    --threads <n>      number of files inspected concurrently\n"
+      << "  quality <in>         report the cell quality of structured zones\n"
+      << "    --bins <n>         number of histogram bins\n"
+      << "    --threads <n>      number of threads\n"
+      << "    --budget <MiB>     coordinate buffer per zone while streaming\n"
+      << std::endl;
+}
+
+/// value of a numeric option, exits on a malformed value
+unsigned long numeric(const std::string &option, const std::string &value) {
+  try {
+    std::size_t pos = 0;
+    const unsigned long n = std::stoul(value, &pos);
+    if (pos == value.size()) {
+      return n;
+    }
+  } catch (const std::exception &) {
+  }
+  spdlog::error("Invalid value {} of option {}.", value, option);
+  exit(EXIT_FAILURE);
+}
+
+/// @brief split the arguments of copy and convert into the files and the
+/// write options, returns false on unknown options
+bool writeArguments(const std::vector<std::string> &args,
+                    std::vector<std::string> &files,
+                    cgns_tools::writeOptions &options) {
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    const std::string &arg = args[i];
+    if (arg == "--single") {
+      options.precision = cgns_tools::outputPrecision::single;
+    } else if (arg == "--adf") {
+      options.type = cgns_tools::fileType::adf;
+    } else if (arg == "--compression" || arg == "--alignment") {
+      if (i + 1 == args.size()) {
+        return false;
+      }
+      const unsigned long n = numeric(arg, args[++i]);
+      if (arg == "--compression") {
+        options.compression = static_cast<int>(std::min(n, 9ul));
+      } else {
+        options.alignment = n * 1024;
+        options.alignmentThreshold = options.alignment;
+      }
+    } else if (arg.substr(0, 2) == "--") {
+      return false;
+    } else {
+      files.push_back(arg);
+    }
+  }
+  return files.size() == 2;
+}
+
+int copy(const std::vector<std::string> &args) {
+  cgns_tools::writeOptions options{};
+  std::vector<std::string> files{};
+  if (!writeArguments(args, files, options)) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  const auto root = cgns_tools::parse(files[0]);
+  cgns_tools::writeFile(files[1], root, options);
+  return EXIT_SUCCESS;
+}
+
+int convert(const std::vector<std::string> &args) {
+  cgns_tools::writeOptions options{};
+  std::vector<std::string> files{};
+  if (!writeArguments(args, files, options)) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  const auto root = cgns_tools::toUnstructured(cgns_tools::parse(files[0]));
+  cgns_tools::writeFile(files[1], root, options);
+  return EXIT_SUCCESS;
+}
+
+int merge(std::vector<std::string> args) {
+  cgns_tools::mergeOptions mergeOptions{};
+  const auto family = std::find(args.begin(), args.end(), "--family");
+  if (family != args.end()) {
+    mergeOptions.byFamily = true;
+    args.erase(family);
+  }
+
+  cgns_tools::writeOptions options{};
+  std::vector<std::string> files{};
+  if (!writeArguments(args, files, options)) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  const auto root =
+      cgns_tools::merge(cgns_tools::parse(files[0]), mergeOptions);
+  cgns_tools::writeFile(files[1], root, options);
+  return EXIT_SUCCESS;
+}
+
+int split(std::vector<std::string> args) {
+  cgns_tools::splitOptions splitOptions{};
+  for (const std::string option : {"--ranks", "--cells"}) {
+    const auto it = std::find(args.begin(), args.end(), option);
+    if (it == args.end()) {
+      continue;
+    }
+    if (it + 1 == args.end()) {
+      usage();
+      return EXIT_FAILURE;
+    }
+    const unsigned long n = numeric(option, *(it + 1));
+    if (option == "--ranks") {
+      splitOptions.nRanks = static_cast<unsigned>(n);
+    } else {
+      splitOptions.maxCells = static_cast<cgsize_t>(n);
+    }
+    args.erase(it, it + 2);
+  }
+
+  cgns_tools::writeOptions options{};
+  std::vector<std::string> files{};
+  if (!writeArguments(args, files, options)) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  auto root = cgns_tools::split(files[0], splitOptions);
+  std::cout << cgns_tools::balance(root, splitOptions.nRanks);
+
+  // the pieces are read from the input while writing, zone by zone
+  cgns_tools::writeFile(files[1], std::move(root), options);
+  return EXIT_SUCCESS;
+}
+
+int info(const std::vector<std::string> &args) {
+  cgns_tools::infoOptions options{};
+  std::vector<std::string> files{};
+  bool json = false;
+
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    const std::string &arg = args[i];
+    if (arg == "--json") {
+      json = true;
+    } else if (arg == "--threads") {
+      if (i + 1 == args.size()) {
+        usage();
+        return EXIT_FAILURE;
+      }
+      options.nThreads = static_cast<unsigned>(numeric(arg, args[++i]));
+    } else {
+      files.push_back(arg);
+    }
+  }
+
+  if (files.empty()) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  const auto infos = cgns_tools::inspect(files, options);
+
+  if (json) {
+    cgns_tools::writeJson(std::cout, infos);
+  } else {
+    for (const auto &i : infos) {
+      std::cout << i;
+    }
+  }
+
+  const bool failed =
+      std::any_of(infos.begin(), infos.end(),
+                  [](const cgns_tools::fileInfo &i) { return !i.error.empty(); });
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int quality(const std::vector<std::string> &args) {
+  cgns_tools::qualityOptions options{};
+  std::vector<std::string> files{};
+
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    const std::string &arg = args[i];
+    if (arg == "--bins" || arg == "--threads" || arg == "--budget") {
+      if (i + 1 == args.size()) {
+        usage();
+        return EXIT_FAILURE;
+      }
+      const unsigned long n = numeric(arg, args[++i]);
+      if (arg == "--bins") {
+        options.nBins = static_cast<unsigned>(n);
+      } else if (arg == "--threads") {
+        options.nThreads = static_cast<unsigned>(n);
+      } else {
+        options.budgetBytes = n * 1024 * 1024;
+      }
+    } else {
+      files.push_back(arg);
+    }
+  }
+
+  if (files.size() != 1) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  for (const auto &q : cgns_tools::quality(files.front(), options)) {
+    std::cout << q;
+  }
+  return EXIT_SUCCESS;
+}
+
+} // namespace
 
 int main(int argc, char *argv[]) {
 
@@ -11,9 +259,37 @@ int main(int argc, char *argv[]) {
   spdlog::cfg::load_argv_levels(
       argc, argv); // set log levels from argv, e.g. SPDLOG_LEVEL=info
 
-  auto root = cgns_tools::parse(
-      "/home/pascal/workspace/cgns_struct2unstruct/test_new.cgns");
+  // arguments without the log level settings
+  std::vector<std::string> args{};
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    if (arg.substr(0, 13) != "SPDLOG_LEVEL=") {
+      args.emplace_back(arg);
+    }
+  }
+
+  if (args.empty()) {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  const std::string command = args.front();
+  args.erase(args.begin());
+
+  if (command == "copy") {
+    return copy(args);
+  } else if (command == "convert") {
+    return convert(args);
+  } else if (command == "merge") {
+    return merge(args);
+  } else if (command == "split") {
+    return split(args);
+  } else if (command == "info") {
+    return info(args);
+  } else if (command == "quality") {
+    return quality(args);
+  }
 
-  cgns_tools::writeFile(
-      "/home/pascal/workspace/cgns_struct2unstruct/test_out.cgns", root);
+  usage();
+  return EXIT_FAILURE;
 }
@@ -0,0 +1,126 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cgns_tools {
+
+/// @brief memory arena for bulk data. Small allocations are carved out of
+/// large blocks, a block is returned once all allocations in it are freed.
+/// Large allocations get their own mapping which is returned on
+/// deallocation.
+/// Blocks and large mappings are 2 MiB aligned and advised for transparent
+/// huge pages. Thread-safe.
+class arena {
+public:
+  /// constructor, allocations of at least blockBytes / 4 are large
+  explicit arena(const std::size_t blockBytes = 64 * 1024 * 1024);
+
+  /// destructor returning all blocks
+  ~arena();
+
+  arena(const arena &) = delete;
+  arena &operator=(const arena &) = delete;
+
+  /// uninitialised memory of the given size and alignment
+  void *allocate(const std::size_t bytes, const std::size_t alignment);
+
+  /// @brief return memory, large allocations are released immediately, the
+  /// block of small ones with its last allocation
+  void deallocate(void *ptr, const std::size_t bytes) noexcept;
+
+  /// bytes currently mapped by the arena
+  std::size_t bytesMapped() const;
+
+  /// bytes handed out by the arena so far, including released ones
+  std::size_t bytesAllocated() const;
+
+private:
+  bool large(const std::size_t bytes) const { return bytes >= _blockBytes / 4; }
+
+  std::size_t _blockBytes;
+
+  mutable std::mutex _mutex;
+
+  /// live allocations of each block by its first byte
+  std::map<std::byte *, std::size_t> _blocks;
+
+  /// block the small allocations are carved out of, nullptr if none
+  std::byte *_current = nullptr;
+  std::byte *_cursor = nullptr;
+  std::size_t _remaining = 0;
+  std::size_t _largeBytes = 0;
+  std::size_t _allocatedBytes = 0;
+};
+
+/// @brief allocator drawing from a shared arena, or from the global heap if
+/// none is set. Elements are default-initialised, i.e. resizing a vector of
+/// arithmetic values does not zero the memory.
+template <typename T> struct arenaAllocator {
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  arenaAllocator() noexcept = default;
+
+  explicit arenaAllocator(std::shared_ptr<arena> memory) noexcept
+      : memory{std::move(memory)} {}
+
+  template <typename U>
+  arenaAllocator(const arenaAllocator<U> &other) noexcept
+      : memory{other.memory} {}
+
+  T *allocate(const std::size_t n) {
+    if (!memory) {
+      return std::allocator<T>{}.allocate(n);
+    }
+    return static_cast<T *>(memory->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *ptr, const std::size_t n) noexcept {
+    if (!memory) {
+      std::allocator<T>{}.deallocate(ptr, n);
+    } else {
+      memory->deallocate(ptr, n * sizeof(T));
+    }
+  }
+
+  /// default-initialisation instead of value-initialisation
+  template <typename U>
+  void construct(U *ptr) noexcept(
+      std::is_nothrow_default_constructible_v<U>) {
+    ::new (static_cast<void *>(ptr)) U;
+  }
+
+  template <typename U, typename... Args>
+  void construct(U *ptr, Args &&...args) {
+    ::new (static_cast<void *>(ptr)) U(std::forward<Args>(args)...);
+  }
+
+  std::shared_ptr<arena> memory;
+};
+
+template <typename T, typename U>
+bool operator==(const arenaAllocator<T> &a, const arenaAllocator<U> &b) {
+  return a.memory == b.memory;
+}
+
+template <typename T, typename U>
+bool operator!=(const arenaAllocator<T> &a, const arenaAllocator<U> &b) {
+  return !(a == b);
+}
+
+/// storage of bulk data
+template <typename T> using buffer = std::vector<T, arenaAllocator<T>>;
+
+} // namespace cgns_tools
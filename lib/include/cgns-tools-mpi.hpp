@@ -0,0 +1,51 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include "../include/cgns-tools.hpp"
+
+#include <mpi.h>
+
+#include <functional>
+#include <optional>
+#include <string>
+
+namespace cgns_tools {
+
+/// @brief part of a zone handled by one rank: a range of vertex planes along
+/// the slowest index direction (K in 3d, J in 2d, the vertex index for
+/// unstructured zones), 1-based and inclusive
+struct zoneShare {
+  cgsize_t begin;
+  cgsize_t end;
+};
+
+/// share of zone Z of base B handled by the calling rank, if any
+using ownershipFn =
+    std::function<std::optional<zoneShare>(const int B, const int Z,
+                                           const zoneV &zone)>;
+
+/// whole zones distributed round robin, zone Z is handled by rank (Z-1) % size
+ownershipFn zonesRoundRobin(MPI_Comm comm);
+
+/// every zone split into slabs of vertex planes, one per rank of comm
+ownershipFn zoneSlabs(MPI_Comm comm);
+
+/// @brief collectively write the cgns hirarchy with the parallel cgns library.
+/// All ranks pass the same metadata, the coordinate arrays of a rank hold the
+/// data of its share of the zone only (and may be empty otherwise).
+/// Generated and stored fixed-size connectivity is split evenly over all
+/// ranks, other connectivity is written by the rank owning the first vertex
+/// plane. Flow solutions are not written.
+void writeFileParallel(MPI_Comm comm, const std::string &path, const root &,
+                       const ownershipFn &own);
+
+/// @brief collectively parse the file, each rank reads the coordinates of its
+/// share of every zone only. Flow solutions and grids after the first are not
+/// read, element sections are read without their connectivity (see
+/// fileIn::readElements).
+root parseParallel(MPI_Comm comm, const std::string &path,
+                   const ownershipFn &own);
+
+} // namespace cgns_tools
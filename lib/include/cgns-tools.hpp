@@ -3,16 +3,24 @@
 
 #pragma once
 
+#include "../include/arena.hpp"
 #include "../include/aux.hpp"
+#include "../include/parallel.hpp"
 #include <cassert>
 #include <cgnslib.h>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -21,8 +29,24 @@ namespace cgns_tools {
 /// string conversion of given BCType_t
 std::string_view to_string(const BCType_t bc);
 
+/// @brief mutex serializing all calls into the cgns library. The mid-level
+/// library keeps global state and is not thread-safe, not even on different
+/// file handles. It is recursive so that sequences of calls depending on
+/// each other (cg_goto, ...) can hold it as well.
+inline std::recursive_mutex &cgnsMutex() {
+  static std::recursive_mutex mutex;
+  return mutex;
+}
+
+/// @brief number of entries of an array with the given extents. Exits if the
+/// count does not fit into cgsize_t.
+cgsize_t checkedProduct(const std::vector<cgsize_t> &extents);
+
 /// cgns function call with error handling
 template <auto &F, class... Args> void cgnsFn(Args &&...args) {
+#ifndef CGNS_TOOLS_THREADSAFE_CGNS
+  const std::scoped_lock lock{cgnsMutex()};
+#endif
   if (const int ier = F(args...); ier != CG_OK) {
     cg_error_exit();
   }
@@ -43,16 +67,71 @@ struct family {
   std::optional<familyBC> bc;
 };
 
-/// represents DataArray_t
+/// @brief represents DataArray_t. Bulk data is never copied implicitly, a
+/// dataArray can only be moved. Arrays created with a loader are lazy: the
+/// data is read on first access and can be released again.
 template <typename T> struct dataArray {
+  using value_type = T;
+
+  /// loader filling the given buffer of size() elements
+  using loader = std::function<void(T *)>;
+
   /// constructor
-  dataArray(std::string &&name, std::vector<T> &&data)
-      : name{name}, data{std::move(data)} {}
+  dataArray(std::string &&name, buffer<T> &&data)
+      : name{std::move(name)}, _size{data.size()}, _data{std::move(data)},
+        _loaded{true} {}
+
+  /// lazy constructor, data is loaded on first access into storage obtained
+  /// from the given allocator
+  dataArray(std::string &&name, const std::size_t size, loader &&load,
+            const arenaAllocator<T> &allocator = {})
+      : name{std::move(name)}, _size{size}, _data{allocator},
+        _loader{std::move(load)} {}
+
+  dataArray(const dataArray &) = delete;
+  dataArray(dataArray &&) = default;
+  dataArray &operator=(const dataArray &) = delete;
+  dataArray &operator=(dataArray &&) = default;
 
   /// name : Data-name identifier or user defined
   std::string name;
 
-  std::vector<T> data;
+  /// number of elements, known without loading the data
+  std::size_t size() const { return _size; }
+
+  /// true if the data is resident in memory
+  bool loaded() const { return _loaded; }
+
+  /// @brief access the data, loading it if required (not thread-safe)
+  const buffer<T> &data() const {
+    load();
+    return _data;
+  }
+
+  /// @brief access the data, loading it if required (not thread-safe)
+  buffer<T> &data() {
+    load();
+    return _data;
+  }
+
+  /// load the data if not yet resident
+  void load() const {
+    if (!_loaded) {
+      _data.resize(_size);
+      _loader(_data.data());
+      _loaded = true;
+    }
+  }
+
+  /// @brief free the data of a lazy array, it is reloaded on next access.
+  /// Modifications are lost. No-op for arrays without a loader. Data in an
+  /// arena is returned with the last allocation of its block.
+  void release() {
+    if (_loader) {
+      buffer<T>{_data.get_allocator()}.swap(_data);
+      _loaded = false;
+    }
+  }
 
   DataType_t dataType() const {
     if constexpr (std::is_same_v<T, float>) {
@@ -63,13 +142,25 @@ template <typename T> struct dataArray {
       static_assert(always_false<T>::value, "Unknow dataArray data type");
     }
   }
+
+private:
+  std::size_t _size;
+  mutable buffer<T> _data;
+  mutable bool _loaded = false;
+  loader _loader;
 };
 
 /// streaming helper function for dataArray
 template <typename T>
 std::ostream &operator<<(std::ostream &, const dataArray<T> &);
 
-using gridCoordinateDataV = std::variant<dataArray<float>, dataArray<double>>;
+using dataArrayV = std::variant<dataArray<float>, dataArray<double>>;
+
+using gridCoordinateDataV = dataArrayV;
+
+// bulk data can only be moved (std::vector does not propagate this trait)
+static_assert(!std::is_copy_constructible_v<dataArrayV>);
+static_assert(std::is_nothrow_move_constructible_v<dataArrayV>);
 
 /// represents GridCoordinates_t
 struct gridCoordinatesT {
@@ -87,6 +178,57 @@ struct gridCoordinatesT {
 /// streaming helper function for gridCoordinatesT
 std::ostream &operator<<(std::ostream &, const gridCoordinatesT &);
 
+/// represents FlowSolution_t
+struct flowSolution {
+  /// constructor
+  flowSolution(std::string &&name, const GridLocation_t location,
+               std::vector<dataArrayV> &&fields)
+      : name{std::move(name)}, location{location}, fields{std::move(fields)} {}
+
+  /// User defined name
+  std::string name;
+
+  /// location of the fields, Vertex or CellCenter
+  GridLocation_t location;
+
+  std::vector<dataArrayV> fields;
+};
+
+/// streaming helper function for flowSolution
+std::ostream &operator<<(std::ostream &, const flowSolution &);
+
+/// represents BC_t of ZoneBC_t
+struct boundaryCondition {
+  /// constructor
+  boundaryCondition(std::string &&name, const BCType_t type,
+                    const PointSetType_t pointSet,
+                    const GridLocation_t location,
+                    std::vector<cgsize_t> &&points)
+      : name{std::move(name)}, type{type}, pointSet{pointSet},
+        location{location}, points{std::move(points)} {}
+
+  /// User defined name
+  std::string name;
+
+  BCType_t type;
+
+  /// PointRange or PointList
+  PointSetType_t pointSet;
+
+  /// location of the points, e.g. Vertex, FaceCenter or IFaceCenter
+  GridLocation_t location;
+
+  /// @brief index_dim indices per point. A PointRange holds the first and the
+  /// last point of the patch.
+  std::vector<cgsize_t> points;
+
+  /// name of the Family_t of the base the patch belongs to, if any
+  std::optional<std::string> familyName = std::nullopt;
+};
+
+/// streaming helper function for boundaryCondition
+std::ostream &operator<<(std::ostream &, const boundaryCondition &);
+
 /// representing Zone_t
 struct zone {
   virtual ~zone() = default;
@@ -99,35 +241,94 @@ struct zone {
 
   std::vector<gridCoordinatesT> gridCoordinates;
 
+  std::vector<flowSolution> flowSolutions;
+
+  std::vector<boundaryCondition> boundaryConditions;
+
+  /// name of the Family_t of the base the zone belongs to, if any
+  std::optional<std::string> familyName = std::nullopt;
+
 protected:
   /// constructor
   zone(std::string &&name, std::vector<gridCoordinatesT> &&gridCoordinates)
       : name(std::move(name)), gridCoordinates{std::move(gridCoordinates)} {}
+
+  // the virtual destructor suppresses the implicit move operations
+  zone(zone &&) = default;
+  zone &operator=(zone &&) = default;
+};
+
+/// represents GridConnectivity1to1_t
+struct connectivity1to1 {
+  /// constructor
+  connectivity1to1(std::string &&name, std::string &&donorName,
+                   std::vector<cgsize_t> &&range,
+                   std::vector<cgsize_t> &&donorRange,
+                   std::vector<int> &&transform)
+      : name{std::move(name)}, donorName{std::move(donorName)},
+        range{std::move(range)}, donorRange{std::move(donorRange)},
+        transform{std::move(transform)} {}
+
+  /// User defined name
+  std::string name;
+
+  /// name of the donor zone
+  std::string donorName;
+
+  /// first and last vertex of the interface, index_dim entries each
+  std::vector<cgsize_t> range;
+
+  /// vertices of the donor zone matching the first and last vertex of range
+  std::vector<cgsize_t> donorRange;
+
+  /// @brief short form of the transformation matrix: index direction j of the
+  /// zone runs along donor direction |transform[j]| - 1 with the sign of
+  /// transform[j]
+  std::vector<int> transform;
+
+  /// donor vertex (1-based) of the vertex p of the interface
+  template <typename Index> Index donor(const Index &p) const {
+    Index d{};
+    for (std::size_t j = 0; j < transform.size(); ++j) {
+      const std::size_t k = std::abs(transform[j]) - 1;
+      d[k] = donorRange[k] + (transform[j] > 0 ? 1 : -1) * (p[j] - range[j]);
+    }
+    return d;
+  }
 };
 
+/// streaming helper function for connectivity1to1
+std::ostream &operator<<(std::ostream &, const connectivity1to1 &);
+
 /// structured Zone_t
 struct zoneStructured : zone {
 
   /// constructor
-  zoneStructured(std::string &&name, std::vector<unsigned> &&nVertex,
-                 std::vector<unsigned> &&nCell,
-                 std::vector<unsigned> &&nBoundVertex,
+  zoneStructured(std::string &&name, std::vector<cgsize_t> &&nVertex,
+                 std::vector<cgsize_t> &&nCell,
+                 std::vector<cgsize_t> &&nBoundVertex,
                  std::vector<gridCoordinatesT> &&gridCoordinates)
       : zone{std::move(name), std::move(gridCoordinates)}, nVertex{std::move(
                                                                nVertex)},
         nCell{std::move(nCell)}, nBoundVertex{std::move(nBoundVertex)} {}
 
   /// number of vertices in I, J, K (3d) or I, J (2d) direction
-  std::vector<unsigned> nVertex;
+  std::vector<cgsize_t> nVertex;
 
   /// number of cells in I, J, K (3d) or I, J (2d) direction
-  std::vector<unsigned> nCell;
+  std::vector<cgsize_t> nCell;
 
   /// number of boundary vertices in I, J, K (3d) or I, J (2d) direction
-  std::vector<unsigned> nBoundVertex;
+  std::vector<cgsize_t> nBoundVertex;
+
+  /// 1-to-1 interfaces to the neighbouring zones
+  std::vector<connectivity1to1> connectivities;
 
   static constexpr ZoneType_t zonetype() noexcept { return Structured; }
 
+  /// zone size array as passed to cg_zone_write
+  std::vector<cgsize_t> size() const;
+
   /// @brief index dimension for structured zones is the base cell dimension
   unsigned indexDimension() const {
     assert(nVertex.size() == nCell.size() &&
@@ -139,22 +340,133 @@ struct zoneStructured : zone {
 /// streaming helper function for zoneStructured
 std::ostream &operator<<(std::ostream &, const zoneStructured &);
 
+/// @brief cell connectivity of a structured zone as QUAD_4 (2d) or HEXA_8 (3d)
+/// elements. The connectivity is not stored but generated chunk by chunk
+/// when it is written.
+struct structuredConnectivity {
+  /// number of vertices in I, J, K (3d) or I, J (2d) direction
+  std::vector<cgsize_t> nVertex;
+
+  /// upper bound of the connectivity buffer used for a single chunk
+  std::size_t chunkBytes = 64 * 1024 * 1024;
+
+  /// number of threads generating a chunk
+  unsigned nThreads = defaultThreadCount();
+
+  /// QUAD_4 for 2d and HEXA_8 for 3d zones
+  ElementType_t elementType() const;
+
+  /// number of nodes per element
+  unsigned nodesPerElement() const;
+
+  /// total number of elements
+  cgsize_t nElements() const;
+
+  /// @brief number of elements per chunk, a multiple of k-planes (or i-lines
+  /// if a single plane exceeds chunkBytes)
+  cgsize_t chunkElements() const;
+
+  /// @brief fill conn with the connectivity of the elements [first, last]
+  /// (1-based, inclusive) in parallel
+  void fill(const cgsize_t first, const cgsize_t last, cgsize_t *conn) const;
+};
+
+struct fileIn;
+
+/// @brief connectivity of a section left in the file by a lazy parse. It is
+/// read chunk by chunk when it is written, the whole section is never held.
+struct storedConnectivity {
+  /// file the section is read from
+  std::shared_ptr<const fileIn> file;
+
+  /// index of the base, zone and section in the file
+  int B = 0;
+  int Z = 0;
+  int S = 0;
+
+  /// first element index of the section in the file
+  cgsize_t start = 1;
+
+  /// number of connectivity entries (ElementConnectivity) of the section
+  cgsize_t dataSize = 0;
+
+  /// @brief number of elements per chunk so that the connectivity and
+  /// offsets of a chunk stay below chunkBytes
+  cgsize_t chunkElements(const std::size_t chunkBytes) const;
+
+  /// @brief read the connectivity of the elements [first, last] (1-based
+  /// within the section, inclusive), see fileIn::readElements
+  void read(const cgsize_t first, const cgsize_t last,
+            std::vector<cgsize_t> &conn, std::vector<cgsize_t> &offsets) const;
+};
+
+using connectivityV = std::variant<std::vector<cgsize_t>,
+                                   structuredConnectivity, storedConnectivity>;
+
+/// @brief true for the element types with a variable number of nodes per
+/// element (MIXED, NGON_n, NFACE_n), which are stored with ElementStartOffset
+bool hasStartOffset(const ElementType_t);
+
+/// represents Elements_t
+struct elementSection {
+  /// constructor
+  elementSection(std::string &&name, const ElementType_t type,
+                 const cgsize_t start, const cgsize_t end,
+                 connectivityV &&connectivity)
+      : name{std::move(name)}, type{type}, start{start}, end{end},
+        connectivity{std::move(connectivity)} {}
+
+  /// User defined name
+  std::string name;
+
+  ElementType_t type;
+
+  /// first element index of the section (1-based)
+  cgsize_t start;
+
+  /// last element index of the section (inclusive)
+  cgsize_t end;
+
+  /// index of the last boundary element, 0 if unsorted
+  int nBoundary = 0;
+
+  connectivityV connectivity;
+
+  /// @brief ElementStartOffset of MIXED, NGON_n and NFACE_n sections,
+  /// nElements() + 1 entries starting at 0. Empty for fixed-size elements
+  /// and stored connectivity.
+  std::vector<cgsize_t> offsets;
+
+  /// number of elements of the section
+  cgsize_t nElements() const { return end - start + 1; }
+};
+
+/// streaming helper function for elementSection
+std::ostream &operator<<(std::ostream &, const elementSection &);
+
 /// unstructured Zone_t
 struct zoneUnstructured : zone {
 
   /// constructor
-  zoneUnstructured(std::string &&name, const unsigned nVertex,
-                   const unsigned nCell, const unsigned nBoundVertex,
-                   std::vector<gridCoordinatesT> &&gridCoordinates)
+  zoneUnstructured(std::string &&name, const cgsize_t nVertex,
+                   const cgsize_t nCell, const cgsize_t nBoundVertex,
+                   std::vector<gridCoordinatesT> &&gridCoordinates,
+                   std::vector<elementSection> &&sections = {})
       : zone{std::move(name), std::move(gridCoordinates)}, nVertex{nVertex},
-        nCell{nCell}, nBoundVertex{nBoundVertex} {}
+        nCell{nCell}, nBoundVertex{nBoundVertex}, sections{
+                                                      std::move(sections)} {}
+
+  cgsize_t nVertex;
+  cgsize_t nCell;
+  cgsize_t nBoundVertex;
 
-  unsigned nVertex;
-  unsigned nCell;
-  unsigned nBoundVertex;
+  std::vector<elementSection> sections;
 
   static constexpr ZoneType_t zonetype() noexcept { return Unstructured; }
 
+  /// zone size array as passed to cg_zone_write
+  std::vector<cgsize_t> size() const;
+
   /// index dimension for unstructured zone is always 1
   static constexpr unsigned indexDimension = 1;
 };
@@ -164,6 +476,8 @@ std::ostream &operator<<(std::ostream &, const zoneUnstructured &);
 
 using zoneV = std::variant<zoneStructured, zoneUnstructured>;
 
+static_assert(std::is_nothrow_move_constructible_v<zoneV>);
+
 // representing CGNSBase_t
 struct base {
 
@@ -218,45 +532,309 @@ protected:
   /// constructor
   file(const std::string &path, fileMode);
 
+  /// @brief content hash stored with the DataArray_t name below node P of
+  /// type parentLabel (GridCoordinates_t, FlowSolution_t) of zone Z, if any
+  std::optional<std::uint64_t> readContentHash(const int B, const int Z,
+                                               const char *parentLabel,
+                                               const int P,
+                                               const std::string &name) const;
+
+  /// store the content hash of a DataArray_t as Descriptor_t child
+  void writeContentHash(const int B, const int Z, const char *parentLabel,
+                        const int P, const std::string &name,
+                        const std::uint64_t hash) const;
+
   /// cgns file handle
   int _handle;
 };
 
-/// cgns read file
-struct fileIn : file {
+/// options for reading a cgns file
+struct parseOptions {
+  /// @brief defer reading bulk data until first access, only metadata is read
+  /// while parsing. The connectivity of element sections is left in the file
+  /// as storedConnectivity.
+  bool lazy = false;
+
+  /// @brief number of threads reading the zones of a base concurrently, each
+  /// through its own file handle. The reads only overlap if the library is
+  /// built with CGNS_TOOLS_THREADSAFE_CGNS, otherwise the cgns calls are
+  /// serialized.
+  unsigned nThreads = 1;
+
+  /// @brief names of the FlowSolution_t fields to read, all fields if not set.
+  /// Fields not selected are never read from disk.
+  std::optional<std::vector<std::string>> fields = std::nullopt;
+
+  /// @brief read the connectivity of the element sections of unstructured
+  /// zones. Otherwise only the section headers are read, the connectivity can
+  /// be streamed with fileIn::readElements.
+  bool sections = true;
+
+  /// @brief place the bulk data of eager parses in an arena created per parse
+  /// if memory is not set, otherwise on the heap. Lazy parses always use the
+  /// heap without memory, so released arrays are returned right away.
+  bool useArena = true;
+
+  /// @brief arena holding the bulk data, shared by all arrays read through the
+  /// file. A block of it is returned once all arrays in it are freed.
+  std::shared_ptr<arena> memory = nullptr;
+};
+
+/// @brief cgns read file. Lazy arrays keep a reference to the file, therefore
+/// it must be owned by a std::shared_ptr when reading lazily.
+struct fileIn : file, std::enable_shared_from_this<fileIn> {
 
   /// construct a new file based on the path
-  fileIn(const std::string &path);
+  fileIn(const std::string &path, const parseOptions & = {});
+
+  /// destructor
+  ~fileIn() override;
+
+  /// @brief files open for reading on the given path and owned by a
+  /// std::shared_ptr, e.g. the files lazy arrays read from
+  static std::vector<std::shared_ptr<fileIn>>
+  openFiles(const std::string &path);
+
+  /// @brief close the handle, e.g. while the file is modified. Nothing may be
+  /// read, including lazy arrays, until the file is reopened.
+  void close();
+
+  /// open the handle closed by close() again
+  void reopen();
+
+  /// @brief number of bytes of bulk data read from the file so far, including
+  /// the reads of the worker handles of a multi-threaded parse. Arrays loaded
+  /// lazily later on are counted on the handle that read their zone.
+  std::uint64_t bytesRead() const { return _bytesRead; }
 
   /// read base information
   std::vector<base> readBaseInformation() const;
 
+  /// number of bases
+  int nBases() const;
+
+  /// number of zones of base B
+  int nZones(const int B) const;
+
+  /// read name, dimensions and families of base B without its zones
+  base readBaseHeader(const int B) const;
+
   /// read base information
   std::vector<zoneV> readZoneInformation(const int B) const;
 
+  /// read a single zone
+  zoneV readZone(const int B, const int Z) const;
+
   /// read Zone Grids Coordinates
   /// nVertex.size() = 1 : Unstructured
   /// nVertex.size() = 2 : 2D Structured
   /// nVertex.size() = 3 : 3D Structured
   std::vector<gridCoordinatesT>
   readZoneGridCoordinates(const int B, const int Z,
-                          const std::vector<unsigned> &nVertex) const;
+                          const std::vector<cgsize_t> &nVertex) const;
+
+  /// @brief read the number of vertices of a zone in each index direction
+  /// (a single entry for unstructured zones) without reading any bulk data
+  std::vector<cgsize_t> readZoneVertexSize(const int B, const int Z) const;
+
+  /// read the name of a zone
+  std::string readZoneName(const int B, const int Z) const;
+
+  /// read the type of a zone
+  ZoneType_t readZoneType(const int B, const int Z) const;
+
+  /// @brief read the zone size array as returned by cg_zone_read: vertex, cell
+  /// and boundary vertex counts per index direction
+  std::vector<cgsize_t> readZoneSize(const int B, const int Z) const;
+
+  /// number of grids (GridCoordinates_t) of a zone
+  int nGrids(const int B, const int Z) const;
+
+  /// name of grid G
+  std::string readGridName(const int B, const int Z, const int G) const;
+
+  /// names and data types of the coordinate arrays of grid G
+  std::vector<std::pair<std::string, DataType_t>>
+  readGridArrayInfo(const int B, const int Z, const int G) const;
+
+  /// @brief read coordinate array A of grid G converted to memType into data
+  /// of length elements. Exits if the stored array has a different length.
+  void readGridArray(const int B, const int Z, const int G, const int A,
+                     const DataType_t memType, const std::size_t length,
+                     void *data) const;
+
+  /// read the names of the coordinates of the first grid of a zone
+  std::vector<std::string> readCoordinateNames(const int B, const int Z) const;
+
+  /// names and data types of the coordinates of the first grid of a zone
+  std::vector<std::pair<std::string, DataType_t>>
+  readCoordinateInfo(const int B, const int Z) const;
+
+  /// @brief read the hyperslab [rangeMin, rangeMax] (1-based, inclusive) of a
+  /// coordinate array converted to memType into data
+  void readCoordinates(const int B, const int Z, const std::string &coordname,
+                       const DataType_t memType, const cgsize_t *rangeMin,
+                       const cgsize_t *rangeMax, void *data) const;
+
+  /// number of flow solutions of a zone
+  int nSolutions(const int B, const int Z) const;
+
+  /// name and grid location of flow solution S
+  std::pair<std::string, GridLocation_t> readSolutionInfo(const int B,
+                                                          const int Z,
+                                                          const int S) const;
+
+  /// names and data types of the fields of flow solution S
+  std::vector<std::pair<std::string, DataType_t>>
+  readFieldInfo(const int B, const int Z, const int S) const;
+
+  /// number of element sections of a zone
+  int nSections(const int B, const int Z) const;
+
+  /// @brief read name, type, range and boundary index of section S, the
+  /// connectivity is left empty
+  elementSection readSectionHeader(const int B, const int Z,
+                                   const int S) const;
+
+  /// @brief read the element sections of a zone including their
+  /// connectivity, which is only referenced if lazy
+  std::vector<elementSection> readElementSections(const int B,
+                                                  const int Z) const;
+
+  /// number of connectivity entries (ElementConnectivity) of section S
+  cgsize_t readElementDataSize(const int B, const int Z, const int S) const;
+
+  /// @brief number of elements of section S read per chunk so that the
+  /// connectivity and offsets of a chunk stay below chunkBytes. Based on the
+  /// mean element size for MIXED, NGON_n and NFACE_n sections.
+  cgsize_t sectionChunkElements(const int B, const int Z, const int S,
+                                const std::size_t chunkBytes) const;
+
+  /// @brief read the connectivity of the elements [first, last] (1-based,
+  /// inclusive, in the numbering of the zone) of section S. The offsets are
+  /// only read for MIXED, NGON_n and NFACE_n sections and start at 0. Both
+  /// buffers are resized, so they can be reused for all chunks.
+  void readElements(const int B, const int Z, const int S,
+                    const cgsize_t first, const cgsize_t last,
+                    std::vector<cgsize_t> &conn,
+                    std::vector<cgsize_t> &offsets) const;
+
+  /// read the flow solutions of a zone, restricted to the selected fields
+  std::vector<flowSolution> readFlowSolutions(const int B, const int Z) const;
+
+  /// @brief read the hyperslab [rangeMin, rangeMax] (1-based, inclusive) of a
+  /// solution field converted to memType into data
+  void readField(const int B, const int Z, const int S,
+                 const std::string &fieldname, const DataType_t memType,
+                 const cgsize_t *rangeMin, const cgsize_t *rangeMax,
+                 void *data) const;
+
+  /// read the FamilyName of a zone, if any
+  std::optional<std::string> readZoneFamilyName(const int B,
+                                                const int Z) const;
+
+  /// read the 1-to-1 interfaces (GridConnectivity1to1_t) of a zone
+  std::vector<connectivity1to1> readConnectivity1to1(const int B,
+                                                     const int Z) const;
+
+  /// read the boundary conditions (ZoneBC_t) of a zone
+  std::vector<boundaryCondition> readBoundaryConditions(const int B,
+                                                        const int Z) const;
 
   /// read Family Definition
   std::vector<family> readFamilyDefinition(const int B) const;
 
   /// read Family Boundary Condition
   familyBC readFamilyBoundaryCondition(const int B, const int Fam) const;
+
+private:
+  /// read (or prepare the lazy read of) a coordinate array
+  template <typename T>
+  dataArray<T> readCoordinateArray(const int B, const int Z,
+                                   std::string &&coordname,
+                                   const std::vector<cgsize_t> &nVertex) const;
+
+  /// read (or prepare the lazy read of) a solution field
+  template <typename T>
+  dataArray<T> readFieldArray(const int B, const int Z, const int S,
+                              std::string &&fieldname,
+                              const std::vector<cgsize_t> &dims) const;
+
+  /// @brief read an array of the given length through read(file, ptr) now or,
+  /// if lazy, on first access
+  template <typename T, typename Read>
+  dataArray<T> readArray(std::string &&name, const std::size_t length,
+                         Read &&read) const;
+
+  /// true if the field is selected by the parse options
+  bool selected(const std::string &fieldname) const;
+
+  /// owner of this file kept by lazy arrays and stored connectivity
+  std::shared_ptr<const fileIn> shared() const;
+
+  std::string _path;
+
+  parseOptions _options;
+
+  mutable std::atomic<std::uint64_t> _bytesRead = 0;
+};
+
+/// precision of real-valued arrays in a written file
+enum class outputPrecision { keep, single };
+
+/// enum mapping for the storage backends of a written file
+enum class fileType {
+  hdf5 = CG_FILE_HDF5,
+  adf = CG_FILE_ADF,
+  adf2 = CG_FILE_ADF2
+};
+
+/// @brief options of writing a cgns file. The backend settings are global
+/// settings of the cgns library. The file type and alignment are applied
+/// when a fileOut is opened, the compression is re-applied for every dataset
+/// written, so several open writers keep their own compression.
+struct writeOptions {
+  /// @brief precision of grid coordinates and solution fields. Double arrays
+  /// are converted to RealSingle while writing if single.
+  outputPrecision precision = outputPrecision::keep;
+
+  /// upper bound of the staging buffer of converted writes
+  std::size_t stagingBytes = 64 * 1024 * 1024;
+
+  /// storage backend of the file
+  fileType type = fileType::hdf5;
+
+  /// @brief deflate level (0 - 9) of the HDF5 datasets. Compressed datasets
+  /// are stored chunked, uncompressed ones contiguous.
+  int compression = 0;
+
+  /// @brief HDF5 alignment of all objects of at least alignmentThreshold
+  /// bytes, e.g. the stripe size of a parallel file system. 0 keeps the
+  /// HDF5 default.
+  std::size_t alignment = 0;
+
+  /// smallest object aligned to alignment
+  std::size_t alignmentThreshold = 1;
+
+  /// upper bound of the connectivity written with a single partial write
+  std::size_t sectionChunkBytes = 64 * 1024 * 1024;
+
+  /// @brief store a content hash with every coordinate array and field
+  /// written in its own precision, see update()
+  bool contentHashes = false;
 };
 
 /// cgns read file
 struct fileOut : file {
 
   /// construct a new file based on the path
-  fileOut(const std::string &path);
+  fileOut(const std::string &path, const writeOptions & = {});
 
   /// write base information of root to file
-  void writeBaseInformation(root) const;
+  void writeBaseInformation(const root &) const;
+
+  /// write name and dimensions of a base, returns its index
+  int writeBaseHeader(const base &) const;
 
   /// write base information
   void writeZoneInformation(const int B, const zoneV &) const;
@@ -267,18 +845,86 @@ struct fileOut : file {
 
   void writeDataArray() const;
 
-  /// write zone grid coordinate data
+  /// write zone grid coordinate data of grid G
   void writeZoneGridCoordinateData(const int B, const int Z,
-                                   const gridCoordinateDataV &data) const;
+                                   const gridCoordinateDataV &data,
+                                   const int G = 1) const;
+
+  /// @brief write the hyperslab [rangeMin, rangeMax] (1-based, inclusive) of a
+  /// coordinate array of the first grid from data of type memType. The array
+  /// is created on the first write.
+  void writeCoordinates(const int B, const int Z, const std::string &coordname,
+                        const DataType_t memType, const cgsize_t *rangeMin,
+                        const cgsize_t *rangeMax, const void *data) const;
+
+  /// write flow solution including all its fields
+  void writeFlowSolution(const int B, const int Z,
+                         const flowSolution &solution) const;
+
+  /// @brief write element section, the connectivity is written in chunks of
+  /// at most sectionChunkBytes using partial writes
+  void writeElementSection(const int B, const int Z,
+                           const elementSection &section) const;
+
+  /// @brief create the Elements_t node of a section holding dataSize
+  /// connectivity entries without writing the connectivity, returns its index.
+  /// The connectivity of section is ignored.
+  int writeSectionHeader(const int B, const int Z,
+                         const elementSection &section,
+                         const cgsize_t dataSize) const;
+
+  /// @brief write the connectivity of the elements [first, last] (1-based,
+  /// inclusive, in the numbering of the zone) of section S. offsets (starting
+  /// at 0) are required for MIXED, NGON_n and NFACE_n sections only.
+  void writeElements(const int B, const int Z, const int S,
+                     const ElementType_t type, const cgsize_t first,
+                     const cgsize_t last, const cgsize_t *conn,
+                     const cgsize_t *offsets = nullptr) const;
+
+  /// write the FamilyName of a zone
+  void writeZoneFamilyName(const int B, const int Z,
+                           const std::string &familyName) const;
+
+  /// write a 1-to-1 interface of a structured zone
+  void writeConnectivity1to1(const int B, const int Z,
+                             const connectivity1to1 &) const;
+
+  /// write a boundary condition including its grid location and family
+  void writeBoundaryCondition(const int B, const int Z,
+                              const boundaryCondition &bc) const;
 
   /// write family definition including the optional BC
   void writeFamilyDefinition(const int B, const family &family) const;
+
+private:
+  /// @brief write a double array with the given dimensions (i fastest) as
+  /// RealSingle if requested by the options. The array is converted in slabs
+  /// through the staging buffer, write(rangeMin, rangeMax, slab) writes a
+  /// single slab. Returns false if the array is not converted.
+  template <typename T, typename Write>
+  bool writeNarrowed(const dataArray<T> &, const std::vector<cgsize_t> &dims,
+                     Write &&write) const;
+
+  /// @brief lock of the cgns library with the compression of this file
+  /// applied, cgns reads it when a dataset is created
+  std::unique_lock<std::recursive_mutex> compressed() const;
+
+  writeOptions _options;
+
+  /// reused for all converted writes
+  mutable std::vector<float> _staging;
 };
 
 /// parse file and return a root to the cgns hirarchy
-root parse(const std::string &path);
+root parse(const std::string &path, const parseOptions & = {});
 
 /// write cgns hirachy to the give file path
-void writeFile(const std::string &path, root);
+void writeFile(const std::string &path, const root &,
+               const writeOptions & = {});
+
+/// @brief write cgns hirachy to the give file path, the bulk data of every
+/// zone is freed once the zone is written. Lazy arrays are thus only resident
+/// while their zone is written.
+void writeFile(const std::string &path, root &&, const writeOptions & = {});
 
 } // namespace cgns_tools
\ No newline at end of file
@@ -0,0 +1,36 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include "../include/cgns-tools.hpp"
+
+#include <cstddef>
+
+namespace cgns_tools {
+
+/// options of the structured to unstructured conversion
+struct conversionOptions {
+  /// upper bound of the connectivity buffer used while writing a section
+  std::size_t chunkBytes = 64 * 1024 * 1024;
+
+  /// number of threads generating the connectivity
+  unsigned nThreads = defaultThreadCount();
+
+  /// @brief convert the PointRange boundary conditions into QUAD_4 (3d) or
+  /// BAR_2 (2d) boundary element sections referenced by the converted BCs
+  bool boundarySections = true;
+};
+
+/// @brief convert a structured zone into an unstructured zone with a single
+/// QUAD_4 (2d) or HEXA_8 (3d) element section. The grid coordinates are moved
+/// as the vertex ordering is kept, the connectivity is generated when written.
+/// Each PointRange BC patch becomes a boundary section numbered after the
+/// cells, the patches are extracted in parallel.
+zoneUnstructured toUnstructured(zoneStructured &&,
+                                const conversionOptions & = {});
+
+/// convert all structured zones of the cgns hirarchy
+root toUnstructured(root &&, const conversionOptions & = {});
+
+} // namespace cgns_tools
@@ -0,0 +1,66 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include "../include/cgns-tools.hpp"
+
+#include <array>
+#include <vector>
+
+namespace cgns_tools {
+
+/// axis aligned bounding box
+struct boundingBox {
+  std::array<double, 3> min = {0.0, 0.0, 0.0};
+  std::array<double, 3> max = {0.0, 0.0, 0.0};
+};
+
+/// options of the geometric kernels
+struct metricsOptions {
+  /// compute the face area vectors, only volumes and extents otherwise
+  bool faceVectors = true;
+
+  /// number of threads, the work is distributed over k-planes
+  unsigned nThreads = defaultThreadCount();
+};
+
+/// @brief geometric metrics of a 3d structured zone. All arrays are ordered
+/// i fastest, like the coordinates.
+template <typename T> struct structuredMetrics {
+  /// number of vertices in I, J, K direction
+  std::array<cgsize_t, 3> nVertex = {0, 0, 0};
+
+  /// cell volumes, (ni-1) x (nj-1) x (nk-1)
+  std::vector<T> volume;
+
+  /// @brief face area vectors [direction][component], pointing in positive
+  /// index direction. I-faces are ni x (nj-1) x (nk-1), J-faces
+  /// (ni-1) x nj x (nk-1) and K-faces (ni-1) x (nj-1) x nk.
+  std::array<std::array<std::vector<T>, 3>, 3> faceVectors;
+
+  /// bounding box of all vertices
+  boundingBox bbox;
+
+  /// volume weighted centroid
+  std::array<double, 3> centroid = {0.0, 0.0, 0.0};
+
+  /// sum of all cell volumes
+  double totalVolume = 0.0;
+};
+
+/// @brief compute the metrics from raw coordinate arrays of a 3d structured
+/// zone. Faces are bilinear, the cell volume follows from the divergence
+/// theorem.
+template <typename T>
+structuredMetrics<T> computeMetrics(const std::array<cgsize_t, 3> &nVertex,
+                                    const T *x, const T *y, const T *z,
+                                    const metricsOptions & = {});
+
+/// @brief compute the metrics of a 3d structured zone from its first
+/// GridCoordinates_t. The coordinates have to be stored as T.
+template <typename T>
+structuredMetrics<T> computeMetrics(const zoneStructured &,
+                                    const metricsOptions & = {});
+
+} // namespace cgns_tools
@@ -0,0 +1,81 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace cgns_tools {
+
+/// name of the Descriptor_t holding the content hash of a DataArray_t
+inline constexpr const char *contentHashDescriptor = "ContentHash";
+
+/// @brief 64-bit content hash of a byte range (xxHash64 construction). Four
+/// independent lanes over 8-byte words keep the loop at memory bandwidth.
+/// Not a cryptographic hash.
+inline std::uint64_t contentHash(const void *data, const std::size_t bytes) {
+  constexpr std::uint64_t p1 = 0x9E3779B185EBCA87ULL;
+  constexpr std::uint64_t p2 = 0xC2B2AE3D27D4EB4FULL;
+  constexpr std::uint64_t p3 = 0x165667B19E3779F9ULL;
+  constexpr std::uint64_t p4 = 0x85EBCA77C2B2AE63ULL;
+  constexpr std::uint64_t p5 = 0x27D4EB2F165667C5ULL;
+
+  const auto rotl = [](const std::uint64_t x, const int r) {
+    return (x << r) | (x >> (64 - r));
+  };
+  const auto round = [&](std::uint64_t acc, const std::uint64_t word) {
+    acc += word * p2;
+    return rotl(acc, 31) * p1;
+  };
+  const auto merge = [&](std::uint64_t h, const std::uint64_t lane) {
+    h ^= round(0, lane);
+    return h * p1 + p4;
+  };
+
+  const auto *p = static_cast<const unsigned char *>(data);
+  const unsigned char *const end = p + bytes;
+
+  const auto word = [](const unsigned char *q) {
+    std::uint64_t w;
+    std::memcpy(&w, q, sizeof(w));
+    return w;
+  };
+
+  std::uint64_t h = 0;
+  if (bytes >= 32) {
+    std::uint64_t v[4] = {p1 + p2, p2, 0, 0 - p1};
+    for (; p + 32 <= end; p += 32) {
+      for (int l = 0; l < 4; ++l) {
+        v[l] = round(v[l], word(p + 8 * l));
+      }
+    }
+    h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18);
+    for (int l = 0; l < 4; ++l) {
+      h = merge(h, v[l]);
+    }
+  } else {
+    h = p5;
+  }
+
+  h += bytes;
+
+  for (; p + 8 <= end; p += 8) {
+    h ^= round(0, word(p));
+    h = rotl(h, 27) * p1 + p4;
+  }
+  for (; p < end; ++p) {
+    h ^= *p * p5;
+    h = rotl(h, 11) * p1;
+  }
+
+  h ^= h >> 33;
+  h *= p2;
+  h ^= h >> 29;
+  h *= p3;
+  h ^= h >> 32;
+  return h;
+}
+
+} // namespace cgns_tools
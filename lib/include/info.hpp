@@ -0,0 +1,83 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include "../include/cgns-tools.hpp"
+#include "../include/parallel.hpp"
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cgns_tools {
+
+/// options of the metadata inspection
+struct infoOptions {
+  /// number of files inspected concurrently, each through its own handle
+  unsigned nThreads = defaultThreadCount();
+};
+
+/// name and data type of a DataArray_t
+using arrayInfo = std::pair<std::string, DataType_t>;
+
+/// metadata of a FlowSolution_t
+struct solutionInfo {
+  std::string name;
+  GridLocation_t location = GridLocationNull;
+  std::vector<arrayInfo> fields;
+};
+
+/// metadata of a Zone_t
+struct zoneInfo {
+  std::string name;
+  ZoneType_t type = ZoneTypeNull;
+
+  /// vertex, cell and boundary vertex counts per index direction
+  std::vector<cgsize_t> size;
+
+  /// names of all GridCoordinates_t
+  std::vector<std::string> grids;
+
+  /// coordinates of the first grid
+  std::vector<arrayInfo> coordinates;
+
+  std::vector<solutionInfo> solutions;
+
+  int nSections = 0;
+};
+
+/// metadata of a CGNSBase_t
+struct baseInfo {
+  std::string name;
+  unsigned cellDimension = 0;
+  unsigned physicalDimension = 0;
+  std::vector<zoneInfo> zones;
+  std::vector<family> families;
+};
+
+/// @brief metadata of a cgns file. Files which are not valid cgns files get
+/// an error message and no bases.
+struct fileInfo {
+  std::string path;
+  std::string error;
+  std::vector<baseInfo> bases;
+};
+
+/// @brief read the metadata of a file, only header calls are made and no
+/// bulk data is read
+fileInfo inspect(const std::string &path);
+
+/// inspect several files concurrently, the results are in the given order
+std::vector<fileInfo> inspect(const std::vector<std::string> &paths,
+                              const infoOptions & = {});
+
+/// streaming helper function for fileInfo
+std::ostream &operator<<(std::ostream &, const fileInfo &);
+
+/// write the files as a json array
+void writeJson(std::ostream &, const std::vector<fileInfo> &);
+
+} // namespace cgns_tools
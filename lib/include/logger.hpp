@@ -9,6 +9,62 @@
 
 #include <string_view>
 
+/// @brief lowest level compiled into the library (a SPDLOG_LEVEL_* value).
+/// Calls below it are removed completely, calls at or above it are checked
+/// against the runtime level before their arguments are evaluated.
+#ifndef CGNS_TOOLS_ACTIVE_LEVEL
+#define CGNS_TOOLS_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+
+/// log at the given level, the arguments are only evaluated if enabled
+#define CGNS_TOOLS_LOG(level, ...)                                             \
+  do {                                                                         \
+    if (spdlog::should_log(level)) {                                           \
+      spdlog::log(level, __VA_ARGS__);                                         \
+    }                                                                          \
+  } while (false)
+
+namespace cgns_tools::detail {
+/// swallows the arguments of a disabled log call
+template <typename... Args> constexpr void unused(const Args &...) noexcept {}
+} // namespace cgns_tools::detail
+
+/// @brief disabled log call, the arguments are never evaluated but still
+/// count as used
+#define CGNS_TOOLS_DISABLED(...)                                               \
+  do {                                                                         \
+    if (false) {                                                               \
+      cgns_tools::detail::unused(__VA_ARGS__);                                 \
+    }                                                                          \
+  } while (false)
+
+#if CGNS_TOOLS_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define CGNS_TOOLS_TRACE(...) CGNS_TOOLS_LOG(spdlog::level::trace, __VA_ARGS__)
+#else
+#define CGNS_TOOLS_TRACE(...) CGNS_TOOLS_DISABLED(__VA_ARGS__)
+#endif
+
+#if CGNS_TOOLS_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define CGNS_TOOLS_DEBUG(...) CGNS_TOOLS_LOG(spdlog::level::debug, __VA_ARGS__)
+#else
+#define CGNS_TOOLS_DEBUG(...) CGNS_TOOLS_DISABLED(__VA_ARGS__)
+#endif
+
+#if CGNS_TOOLS_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define CGNS_TOOLS_INFO(...) CGNS_TOOLS_LOG(spdlog::level::info, __VA_ARGS__)
+#else
+#define CGNS_TOOLS_INFO(...) CGNS_TOOLS_DISABLED(__VA_ARGS__)
+#endif
+
+#if CGNS_TOOLS_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
+#define CGNS_TOOLS_WARN(...) CGNS_TOOLS_LOG(spdlog::level::warn, __VA_ARGS__)
+#else
+#define CGNS_TOOLS_WARN(...) CGNS_TOOLS_DISABLED(__VA_ARGS__)
+#endif
+
+// errors precede an exit and are never removed
+#define CGNS_TOOLS_ERROR(...) CGNS_TOOLS_LOG(spdlog::level::err, __VA_ARGS__)
+
 namespace cgns_tools {
 
 template <typename... Args>
@@ -18,4 +74,4 @@ std::string indent(const unsigned indent, std::string_view format_str,
       .append(fmt::format(format_str, std::forward<Args>(args)...));
 }
 
-} // namespace cgns_tools
\ No newline at end of file
+} // namespace cgns_tools
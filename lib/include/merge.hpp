@@ -0,0 +1,37 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include "../include/cgns-tools.hpp"
+#include "../include/convert.hpp"
+#include "../include/numbering.hpp"
+
+namespace cgns_tools {
+
+/// options of the zone merging
+struct mergeOptions {
+  /// @brief merge the zones of every FamilyName separately, zones without a
+  /// family form a group of their own. All zones are merged into one otherwise.
+  bool byFamily = false;
+
+  /// matching of the vertices shared by several zones
+  numberingOptions numbering{};
+
+  /// conversion of the structured zones
+  conversionOptions conversion{};
+};
+
+/// @brief merge the zones of a base into a single unstructured zone (or one
+/// per family). Shared vertices are welded through numberVertices and the
+/// coordinates concatenated. Volume elements (of the cell dimension of the
+/// base) are collected in one section per element type, boundary elements in
+/// one section per BC family (or BC name) referenced by a single BC, or per
+/// section if no BC references them. Flow solutions are kept if all zones
+/// have the same solutions. NGON_n and NFACE_n sections are not supported.
+base merge(base &&, const mergeOptions & = {});
+
+/// merge the zones of all bases of the cgns hirarchy
+root merge(root &&, const mergeOptions & = {});
+
+} // namespace cgns_tools
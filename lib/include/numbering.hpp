@@ -0,0 +1,45 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include "../include/cgns-tools.hpp"
+
+#include <vector>
+
+namespace cgns_tools {
+
+/// options of the global vertex numbering
+struct numberingOptions {
+  /// @brief weld vertices by their coordinates if any zone of the base has no
+  /// 1-to-1 interfaces
+  bool weld = true;
+
+  /// largest distance of two welded vertices
+  double tolerance = 1e-8;
+
+  /// number of threads of the spatial hash weld
+  unsigned nThreads = defaultThreadCount();
+};
+
+/// global vertex numbering of the zones of a base
+struct vertexNumbering {
+  /// @brief 0-based global id of every vertex of each zone, in the vertex
+  /// order of the zone (i fastest)
+  std::vector<std::vector<cgsize_t>> ids;
+
+  /// number of distinct vertices
+  cgsize_t nVertex = 0;
+
+  /// number of vertices of all zones, including duplicates
+  cgsize_t nZoneVertex = 0;
+};
+
+/// @brief number the vertices of all zones of a base so that vertices shared
+/// by several zones get a single id. Vertices are matched through the 1-to-1
+/// interfaces of structured zones. Zones without interfaces are welded by a
+/// spatial hash of the zone surface (all vertices of unstructured zones).
+/// Ids are assigned in the order of first occurrence.
+vertexNumbering numberVertices(const base &, const numberingOptions & = {});
+
+} // namespace cgns_tools
@@ -0,0 +1,67 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace cgns_tools {
+
+/// number of threads used if not specified otherwise
+inline unsigned defaultThreadCount() {
+  const unsigned n = std::thread::hardware_concurrency();
+  return n == 0 ? 1 : n;
+}
+
+/// @brief call fn(first, last) on contiguous blocks [first, last) of the range
+/// [begin, end), one block per thread
+template <typename F>
+void parallelForBlocks(const std::size_t begin, const std::size_t end, F &&fn,
+                       const unsigned nThreads = defaultThreadCount()) {
+  if (end <= begin) {
+    return;
+  }
+
+  const std::size_t n = end - begin;
+  const std::size_t nBlocks =
+      std::min<std::size_t>(std::max(nThreads, 1u), n);
+
+  if (nBlocks == 1) {
+    fn(begin, end);
+    return;
+  }
+
+  std::vector<std::thread> threads{};
+  threads.reserve(nBlocks - 1);
+
+  for (std::size_t t = 1; t < nBlocks; ++t) {
+    threads.emplace_back([&fn, begin, n, nBlocks, t]() {
+      fn(begin + n * t / nBlocks, begin + n * (t + 1) / nBlocks);
+    });
+  }
+
+  fn(begin, begin + n / nBlocks);
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+/// call fn(i) for every i in [begin, end) distributed over nThreads threads
+template <typename F>
+void parallelFor(const std::size_t begin, const std::size_t end, F &&fn,
+                 const unsigned nThreads = defaultThreadCount()) {
+  parallelForBlocks(
+      begin, end,
+      [&fn](const std::size_t first, const std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+          fn(i);
+        }
+      },
+      nThreads);
+}
+
+} // namespace cgns_tools
@@ -0,0 +1,93 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include "../include/cgns-tools.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace cgns_tools {
+
+/// @brief blocking queue holding at most capacity items, used to connect the
+/// stages of a pipeline
+template <typename T> class boundedQueue {
+public:
+  explicit boundedQueue(const std::size_t capacity)
+      : _capacity{capacity == 0 ? 1 : capacity} {}
+
+  /// append an item, blocks while the queue is full
+  void push(T &&item) {
+    std::unique_lock lock{_mutex};
+    _notFull.wait(lock, [this] { return _items.size() < _capacity; });
+    _items.emplace_back(std::move(item));
+    _notEmpty.notify_one();
+  }
+
+  /// @brief take the next item, blocks while the queue is empty. Returns
+  /// nullopt once the queue is closed and drained.
+  std::optional<T> pop() {
+    std::unique_lock lock{_mutex};
+    _notEmpty.wait(lock, [this] { return !_items.empty() || _closed; });
+    if (_items.empty()) {
+      return std::nullopt;
+    }
+    std::optional<T> item{std::move(_items.front())};
+    _items.pop_front();
+    _notFull.notify_one();
+    return item;
+  }
+
+  /// no more items will be pushed
+  void close() {
+    const std::scoped_lock lock{_mutex};
+    _closed = true;
+    _notEmpty.notify_all();
+  }
+
+private:
+  std::size_t _capacity;
+  std::deque<T> _items;
+  bool _closed = false;
+  std::mutex _mutex;
+  std::condition_variable _notFull;
+  std::condition_variable _notEmpty;
+};
+
+/// transformation applied to every zone between reading and writing
+using zoneTransform = std::function<zoneV(zoneV &&)>;
+
+/// transformation passing the zone through unchanged
+inline zoneV identityTransform(zoneV &&zone) { return std::move(zone); }
+
+/// options of the pipelined copy
+struct pipelineOptions {
+  /// @brief maximum number of zones waiting between two stages. At most
+  /// 2 * depth + 3 zones are in memory at once, the zones are read into the
+  /// heap unless read.memory is set.
+  std::size_t depth = 2;
+
+  /// options of the reading stage
+  parseOptions read = {};
+
+  /// options of the writing stage
+  writeOptions write = {};
+};
+
+/// @brief copy a cgns file zone by zone in a three stage pipeline with
+/// bounded memory: zone N+1 is read and zone N is transformed while zone N-1
+/// is written. The cgns calls of the read and write stages take the global
+/// cgns lock, so only the transform overlaps with them unless the library is
+/// built with CGNS_TOOLS_THREADSAFE_CGNS. Base headers and families are copied
+/// before the zones.
+void copyPipelined(const std::string &in, const std::string &out,
+                   const zoneTransform &transform = identityTransform,
+                   const pipelineOptions &options = {});
+
+} // namespace cgns_tools
@@ -0,0 +1,101 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include "../include/cgns-tools.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace cgns_tools {
+
+/// @brief fixed-bin histogram with summary statistics. Values outside
+/// [lower, upper] are counted in the first or last bin.
+struct histogram {
+  /// constructor
+  histogram(const double lower = 0.0, const double upper = 1.0,
+            const unsigned nBins = 10);
+
+  /// add a value
+  void add(const double value);
+
+  /// add all values of another histogram with the same bins
+  void merge(const histogram &);
+
+  /// mean of all values, 0 if empty
+  double mean() const { return count == 0 ? 0.0 : sum / count; }
+
+  double lower;
+  double upper;
+  std::vector<std::uint64_t> bins;
+
+  double min;
+  double max;
+  double sum = 0.0;
+  std::uint64_t count = 0;
+};
+
+/// streaming helper function for histogram
+std::ostream &operator<<(std::ostream &, const histogram &);
+
+/// options of the mesh quality pass
+struct qualityOptions {
+  /// number of histogram bins
+  unsigned nBins = 10;
+
+  /// upper bound of the aspect ratio histogram
+  double maxAspectRatio = 100.0;
+
+  /// upper bound of the growth rate histogram
+  double maxGrowthRate = 2.0;
+
+  /// upper bound of the coordinate buffers of a zone tile when streaming
+  std::size_t budgetBytes = 256 * 1024 * 1024;
+
+  /// @brief number of threads, distributed over the zones and within the
+  /// zones over k-planes
+  unsigned nThreads = defaultThreadCount();
+};
+
+/// @brief quality of the cells of a 3d structured zone
+/// skewness     : equiangle skewness of the corner angles, 0 is orthogonal
+/// aspectRatio  : longest over shortest mean edge length of the directions
+/// growthRate   : largest volume ratio to the next cell in I, J or K
+/// nNegativeJacobian : cells with a negative jacobian at any corner
+struct zoneQuality {
+  /// constructor setting up empty histograms
+  explicit zoneQuality(const qualityOptions & = {});
+
+  /// add the statistics of another part of the zone
+  void merge(const zoneQuality &);
+
+  std::string name;
+  int B = 0;
+  int Z = 0;
+
+  std::uint64_t nCell = 0;
+  std::uint64_t nNegativeJacobian = 0;
+
+  histogram skewness;
+  histogram aspectRatio;
+  histogram growthRate;
+};
+
+/// streaming helper function for zoneQuality
+std::ostream &operator<<(std::ostream &, const zoneQuality &);
+
+/// @brief quality of all 3d structured zones of a cgns hirarchy held in
+/// memory, lazy arrays are loaded on access. Other zones are skipped.
+std::vector<zoneQuality> quality(const root &, const qualityOptions & = {});
+
+/// @brief quality of all 3d structured zones of a file. The coordinates are
+/// streamed in tiles of at most budgetBytes, the file is never resident as a
+/// whole. Other zones are skipped.
+std::vector<zoneQuality> quality(const std::string &path,
+                                 const qualityOptions & = {});
+
+} // namespace cgns_tools
@@ -0,0 +1,20 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+/// @brief compile a kernel for several instruction sets, the best one
+/// supported by the cpu is selected at load time
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define CGNS_TOOLS_SIMD_CLONES                                                 \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define CGNS_TOOLS_SIMD_CLONES
+#endif
+
+/// pointer not aliased by any other pointer of the kernel
+#if defined(__GNUC__)
+#define CGNS_TOOLS_RESTRICT __restrict__
+#else
+#define CGNS_TOOLS_RESTRICT
+#endif
@@ -0,0 +1,90 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include "../include/cgns-tools.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace cgns_tools {
+
+/// @brief streams the grids (GridCoordinates_t) of a zone, e.g. the snapshots
+/// of a deforming mesh, holding a single snapshot in memory at a time. In
+/// delta mode the first grid is kept as reference and all further grids are
+/// returned as displacements from it.
+template <typename T> class gridStream {
+public:
+  /// coordinates of grid G, ordered as the coordinates of the first grid
+  struct snapshot {
+    int G;
+    const std::string &name;
+    const std::vector<std::vector<T>> &coordinates;
+  };
+
+  /// input iterator over all grids of the zone
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = snapshot;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = snapshot;
+
+    iterator(gridStream *stream, const int G) : _stream{stream}, _G{G} {}
+
+    snapshot operator*() const { return _stream->read(_G); }
+
+    iterator &operator++() {
+      ++_G;
+      return *this;
+    }
+
+    bool operator==(const iterator &other) const { return _G == other._G; }
+    bool operator!=(const iterator &other) const { return _G != other._G; }
+
+  private:
+    gridStream *_stream;
+    int _G;
+  };
+
+  /// constructor reading the zone metadata, the file must outlive the stream
+  gridStream(const fileIn &file, const int B, const int Z,
+             const bool delta = false);
+
+  /// number of grids of the zone
+  int nGrids() const { return _nGrids; }
+
+  /// coordinate names in the order of the buffers
+  const std::vector<std::string> &coordinateNames() const { return _names; }
+
+  /// @brief read grid G (1-based) into the reused buffers, as displacement
+  /// from the first grid in delta mode (except for G = 1)
+  snapshot read(const int G);
+
+  iterator begin() { return {this, 1}; }
+  iterator end() { return {this, _nGrids + 1}; }
+
+private:
+  const fileIn &_file;
+  int _B;
+  int _Z;
+  bool _delta;
+  int _nGrids;
+  std::size_t _length = 1;
+  std::vector<std::string> _names;
+
+  std::string _name;
+  std::vector<std::vector<T>> _buffers;
+
+  /// first grid, kept in delta mode only
+  std::vector<std::vector<T>> _reference;
+};
+
+extern template class gridStream<float>;
+extern template class gridStream<double>;
+
+} // namespace cgns_tools
@@ -0,0 +1,64 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include "../include/cgns-tools.hpp"
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace cgns_tools {
+
+/// options of the structured zone splitting
+struct splitOptions {
+  /// @brief largest number of cells of a zone. Derived from nRanks if 0:
+  /// the total number of cells divided by nRanks.
+  cgsize_t maxCells = 0;
+
+  /// number of ranks the zones are distributed to
+  unsigned nRanks = 1;
+
+  /// smallest number of cells of a piece in a split direction
+  cgsize_t minCells = 1;
+};
+
+/// distribution of the zones of a hierarchy to ranks
+struct loadBalance {
+  /// number of zones
+  std::size_t nZones = 0;
+
+  /// number of cells of the largest zone
+  cgsize_t maxZoneCells = 0;
+
+  /// @brief cells per rank, the zones are assigned largest first to the rank
+  /// with the fewest cells
+  std::vector<cgsize_t> rankCells;
+
+  /// @brief largest number of cells of a rank over the mean, 1 if perfectly
+  /// balanced
+  double imbalance = 1.0;
+};
+
+/// distribute the zones of all bases greedily to nRanks ranks
+loadBalance balance(const root &, const unsigned nRanks);
+
+/// streaming helper function for loadBalance
+std::ostream &operator<<(std::ostream &, const loadBalance &);
+
+/// @brief split the structured zones of a hierarchy by recursive bisection
+/// along the longest index direction until no zone exceeds the target cell
+/// count. The coordinates and vertex or cell centred fields are copied into
+/// the pieces. Neighbouring pieces are connected by 1-to-1 interfaces, the
+/// existing interfaces and BCs are divided among the pieces.
+root split(root &&, const splitOptions & = {});
+
+/// @brief split the structured zones of a file like split(root&&). Only
+/// metadata is read, the arrays of the pieces are read as hyperslabs of the
+/// original arrays on first access.
+root split(const std::string &path, const splitOptions & = {},
+           const parseOptions & = {});
+
+} // namespace cgns_tools
@@ -0,0 +1,121 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include "../include/cgns-tools.hpp"
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace cgns_tools {
+
+/// index-space tile of a structured zone, 1-based inclusive vertex ranges
+struct tile {
+  std::array<cgsize_t, 3> rangeMin = {1, 1, 1};
+  std::array<cgsize_t, 3> rangeMax = {1, 1, 1};
+
+  /// number of vertices in direction d
+  cgsize_t extent(const unsigned d) const {
+    return rangeMax[d] - rangeMin[d] + 1;
+  }
+
+  /// number of vertices of the tile
+  cgsize_t nVertex() const { return extent(0) * extent(1) * extent(2); }
+};
+
+/// options of the tiled zone reader
+struct tileOptions {
+  /// upper bound of the coordinate buffers of a single tile
+  std::size_t budgetBytes = 256 * 1024 * 1024;
+
+  /// @brief number of vertex layers shared by neighbouring tiles. With an
+  /// overlap of 1 every cell is contained completely in exactly one tile.
+  unsigned overlap = 0;
+};
+
+/// @brief streams the coordinates of a structured zone as index-space tiles.
+/// Tiles are k-slabs if a single k-plane fits into the byte budget and i/j/k
+/// bricks otherwise. The coordinate buffers are reused for all tiles.
+template <typename T> class tileReader {
+public:
+  /// coordinates of the current tile, i fastest
+  struct tileData {
+    const tile &range;
+    const std::vector<std::vector<T>> &coordinates;
+  };
+
+  /// input iterator over all tiles of the zone
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = tileData;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = tileData;
+
+    iterator(tileReader *reader, const std::size_t n)
+        : _reader{reader}, _n{n} {}
+
+    tileData operator*() const { return _reader->read(_n); }
+
+    iterator &operator++() {
+      ++_n;
+      return *this;
+    }
+
+    bool operator==(const iterator &other) const { return _n == other._n; }
+    bool operator!=(const iterator &other) const { return _n != other._n; }
+
+  private:
+    tileReader *_reader;
+    std::size_t _n;
+  };
+
+  /// constructor reading the zone metadata, the file must outlive the reader
+  tileReader(const fileIn &file, const int B, const int Z,
+             const tileOptions &options = {});
+
+  /// number of vertices in I, J, K (3d) or I, J (2d) direction
+  const std::vector<cgsize_t> &nVertex() const { return _nVertex; }
+
+  /// coordinate names in the order of the buffers
+  const std::vector<std::string> &coordinateNames() const { return _names; }
+
+  /// number of tiles
+  std::size_t nTiles() const {
+    return _nTiles[0] * _nTiles[1] * _nTiles[2];
+  }
+
+  /// index range of tile n
+  tile tileAt(const std::size_t n) const;
+
+  /// read tile n into the reused buffers
+  tileData read(const std::size_t n);
+
+  iterator begin() { return {this, 0}; }
+  iterator end() { return {this, nTiles()}; }
+
+private:
+  const fileIn &_file;
+  int _B;
+  int _Z;
+  unsigned _overlap;
+  std::vector<cgsize_t> _nVertex;
+  std::vector<std::string> _names;
+
+  /// vertex step between tiles and number of tiles per direction
+  std::array<cgsize_t, 3> _step = {1, 1, 1};
+  std::array<std::size_t, 3> _nTiles = {1, 1, 1};
+
+  tile _current;
+  std::vector<std::vector<T>> _buffers;
+};
+
+extern template class tileReader<float>;
+extern template class tileReader<double>;
+
+} // namespace cgns_tools
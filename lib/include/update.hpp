@@ -0,0 +1,85 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include "../include/cgns-tools.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace cgns_tools {
+
+/// options of updating a file in place
+struct updateOptions {
+  /// @brief arrays of a lazy root which were never loaded are taken as
+  /// unchanged. Only valid if the root was parsed from the updated file.
+  bool skipUnloaded = true;
+
+  /// @brief store the content hash with every compared array, later updates
+  /// then compare against it instead of reading the array
+  bool storeHashes = true;
+};
+
+/// statistics of an update
+struct updateStats {
+  /// number of compared arrays
+  std::size_t nArrays = 0;
+
+  /// number of rewritten arrays
+  std::size_t nWritten = 0;
+
+  /// bulk data written and read to compare arrays without a stored hash
+  std::uint64_t bytesWritten = 0;
+  std::uint64_t bytesRead = 0;
+};
+
+/// streaming helper function for updateStats
+std::ostream &operator<<(std::ostream &, const updateStats &);
+
+/// @brief cgns file opened in modify mode. Rewrites coordinate arrays and
+/// solution fields whose content differs from the file. No fileIn may be open
+/// on the same path, update() takes care of lazily parsed hierarchies.
+struct fileModify : file {
+
+  /// open an existing file
+  fileModify(const std::string &path, const updateOptions & = {});
+
+  /// @brief compare and, if changed, rewrite all coordinate arrays of grid G
+  /// of zone Z. The zone has to match the zone in the file.
+  void updateGridCoordinates(const int B, const int Z, const int G,
+                             const gridCoordinatesT &);
+
+  /// compare and, if changed, rewrite all fields of flow solution S
+  void updateFlowSolution(const int B, const int Z, const int S,
+                          const flowSolution &);
+
+  /// compare and rewrite all zones of the hierarchy
+  void update(const root &);
+
+  const updateStats &stats() const { return _stats; }
+
+private:
+  /// @brief true if the array differs from the stored one of the given data
+  /// type, read(ptr) reads the stored array if no hash is stored
+  template <typename T, typename Read>
+  bool changed(const int B, const int Z, const char *parentLabel, const int P,
+               const dataArray<T> &, const DataType_t stored, Read &&read);
+
+  updateOptions _options;
+
+  updateStats _stats;
+};
+
+/// @brief update an existing file to the given hierarchy, only arrays whose
+/// content changed are rewritten. The structure (bases, zones, grids,
+/// solutions) has to match the file. Files open for reading on the path, e.g.
+/// of a lazy parse of the hierarchy, are closed during the update and
+/// reopened afterwards.
+updateStats update(const std::string &path, const root &,
+                   const updateOptions & = {});
+
+} // namespace cgns_tools
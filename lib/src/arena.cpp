@@ -0,0 +1,148 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "../include/arena.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace cgns_tools {
+
+namespace {
+
+/// huge page size and alignment of all mappings
+constexpr std::size_t hugePage = 2 * 1024 * 1024;
+
+std::size_t roundUp(const std::size_t bytes, const std::size_t alignment) {
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+/// map bytes (a multiple of hugePage) aligned to hugePage
+void *map(const std::size_t bytes) {
+#ifdef __linux__
+  // over-allocate and trim to get the alignment
+  void *raw = mmap(nullptr, bytes + hugePage, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) {
+    throw std::bad_alloc{};
+  }
+
+  const auto begin = reinterpret_cast<std::uintptr_t>(raw);
+  const auto aligned = roundUp(begin, hugePage);
+
+  if (aligned > begin) {
+    munmap(raw, aligned - begin);
+  }
+  if (const std::size_t tail = hugePage - (aligned - begin); tail > 0) {
+    munmap(reinterpret_cast<void *>(aligned + bytes), tail);
+  }
+
+  void *ptr = reinterpret_cast<void *>(aligned);
+  madvise(ptr, bytes, MADV_HUGEPAGE);
+  return ptr;
+#else
+  return ::operator new(bytes, std::align_val_t{hugePage});
+#endif
+}
+
+void unmap(void *ptr, const std::size_t bytes) noexcept {
+#ifdef __linux__
+  munmap(ptr, bytes);
+#else
+  ::operator delete(ptr, std::align_val_t{hugePage});
+#endif
+}
+
+} // namespace
+
+arena::arena(const std::size_t blockBytes)
+    : _blockBytes{roundUp(blockBytes, hugePage)} {}
+
+arena::~arena() {
+  for (const auto &[block, live] : _blocks) {
+    unmap(block, _blockBytes);
+  }
+}
+
+void *arena::allocate(const std::size_t bytes, const std::size_t alignment) {
+  if (this->large(bytes)) {
+    const std::size_t mapped = roundUp(bytes, hugePage);
+    void *ptr = map(mapped);
+
+    const std::scoped_lock lock{_mutex};
+    _largeBytes += mapped;
+    _allocatedBytes += bytes;
+    return ptr;
+  }
+
+  const std::scoped_lock lock{_mutex};
+  _allocatedBytes += bytes;
+
+  const auto cursor = reinterpret_cast<std::uintptr_t>(_cursor);
+  std::size_t padding = roundUp(cursor, alignment) - cursor;
+
+  if (_current == nullptr || padding + bytes > _remaining) {
+    _current = static_cast<std::byte *>(map(_blockBytes));
+    _blocks.emplace(_current, 0);
+    _cursor = _current;
+    _remaining = _blockBytes;
+    padding = 0;
+  }
+
+  ++_blocks[_current];
+
+  void *ptr = _cursor + padding;
+  _cursor += padding + bytes;
+  _remaining -= padding + bytes;
+  return ptr;
+}
+
+void arena::deallocate(void *ptr, const std::size_t bytes) noexcept {
+  if (this->large(bytes)) {
+    const std::size_t mapped = roundUp(bytes, hugePage);
+    unmap(ptr, mapped);
+
+    const std::scoped_lock lock{_mutex};
+    _largeBytes -= mapped;
+    return;
+  }
+
+  const std::scoped_lock lock{_mutex};
+
+  // the block starting at or before ptr
+  auto it = _blocks.upper_bound(static_cast<std::byte *>(ptr));
+  if (it == _blocks.begin()) {
+    return;
+  }
+  --it;
+
+  if (--it->second > 0) {
+    return;
+  }
+
+  if (it->first == _current) {
+    _current = nullptr;
+    _cursor = nullptr;
+    _remaining = 0;
+  }
+  unmap(it->first, _blockBytes);
+  _blocks.erase(it);
+}
+
+std::size_t arena::bytesMapped() const {
+  const std::scoped_lock lock{_mutex};
+  return _blocks.size() * _blockBytes + _largeBytes;
+}
+
+std::size_t arena::bytesAllocated() const {
+  const std::scoped_lock lock{_mutex};
+  return _allocatedBytes;
+}
+
+} // namespace cgns_tools
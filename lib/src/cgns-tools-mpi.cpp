@@ -0,0 +1,462 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "../include/cgns-tools-mpi.hpp"
+
+#include <cgnslib.h>
+#include <pcgnslib.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <variant>
+#include <vector>
+
+#include "../include/logger.hpp"
+#include "spdlog/spdlog.h"
+
+namespace cgns_tools {
+
+namespace {
+
+int rank(MPI_Comm comm) {
+  int r = 0;
+  MPI_Comm_rank(comm, &r);
+  return r;
+}
+
+int nRanks(MPI_Comm comm) {
+  int n = 0;
+  MPI_Comm_size(comm, &n);
+  return n;
+}
+
+/// number of vertices in each index direction
+std::vector<cgsize_t> vertexSize(const zoneV &zone) {
+  return std::visit(
+      overloaded{[](const zoneStructured &z) { return z.nVertex; },
+                 [](const zoneUnstructured &z) {
+                   return std::vector<cgsize_t>{z.nVertex};
+                 }},
+      zone);
+}
+
+/// hyperslab of the coordinates covered by a share
+void shareRange(const std::vector<cgsize_t> &nVertex, const zoneShare &share,
+                std::vector<cgsize_t> &rangeMin,
+                std::vector<cgsize_t> &rangeMax) {
+  rangeMin.assign(nVertex.size(), 1);
+  rangeMax = nVertex;
+  rangeMin.back() = share.begin;
+  rangeMax.back() = share.end;
+}
+
+/// number of vertices covered by a share
+std::size_t shareLength(const std::vector<cgsize_t> &nVertex,
+                        const zoneShare &share) {
+  std::size_t length = share.end - share.begin + 1;
+  for (std::size_t i = 0; i + 1 < nVertex.size(); ++i) {
+    length *= nVertex[i];
+  }
+  return length;
+}
+
+/// upper bound of the connectivity of a stored section read per chunk
+constexpr std::size_t storedChunkBytes = 64 * 1024 * 1024;
+
+/// @brief write the fixed-size elements of section S split evenly over all
+/// ranks in chunks of nChunk elements, fill(first, last) returns the
+/// connectivity of the elements [first, last] (1-based within the section)
+template <typename Fill>
+void writeElementsSplit(MPI_Comm comm, const int fn, const int B, const int Z,
+                        const int S, const elementSection &section,
+                        const cgsize_t nChunk, Fill &&fill) {
+  const cgsize_t nElements = section.end - section.start + 1;
+  const int r = rank(comm);
+  const int n = nRanks(comm);
+  const cgsize_t first = 1 + nElements * r / n;
+  const cgsize_t last = nElements * (r + 1) / n;
+
+  // the collective calls must match over all ranks
+  const cgsize_t nMaxShare = (nElements + n - 1) / n;
+  const cgsize_t nCalls = (nMaxShare + nChunk - 1) / nChunk;
+
+  for (cgsize_t c = 0; c < nCalls; ++c) {
+    const cgsize_t begin = first + c * nChunk;
+    const cgsize_t end = std::min(begin + nChunk - 1, last);
+
+    if (begin <= end) {
+      cgnsFn<cgp_elements_write_data>(fn, B, Z, S, section.start + begin - 1,
+                                      section.start + end - 1,
+                                      fill(begin, end));
+    } else {
+      cgnsFn<cgp_elements_write_data>(fn, B, Z, S, section.start,
+                                      section.start, nullptr);
+    }
+  }
+}
+
+void writeSectionParallel(MPI_Comm comm, const int fn, const int B,
+                          const int Z, const elementSection &section,
+                          const bool ownsFirstPlane) {
+  int S = 0;
+
+  if (hasStartOffset(section.type)) {
+    // explicit MIXED, NGON_n and NFACE_n connectivity, written by one rank
+    std::vector<cgsize_t> storedConn{};
+    std::vector<cgsize_t> storedOffsets{};
+
+    const std::vector<cgsize_t> *conn = nullptr;
+    const std::vector<cgsize_t> *offsets = &section.offsets;
+    cgsize_t dataSize = 0;
+
+    if (const auto *stored =
+            std::get_if<storedConnectivity>(&section.connectivity)) {
+      if (ownsFirstPlane) {
+        stored->read(1, section.end - section.start + 1, storedConn,
+                     storedOffsets);
+      }
+      conn = &storedConn;
+      offsets = &storedOffsets;
+      dataSize = stored->dataSize;
+    } else {
+      conn = &std::get<std::vector<cgsize_t>>(section.connectivity);
+      dataSize = static_cast<cgsize_t>(conn->size());
+    }
+
+    cgnsFn<cgp_poly_section_write>(fn, B, Z, section.name.c_str(),
+                                   section.type, section.start, section.end,
+                                   dataSize, section.nBoundary, &S);
+    if (ownsFirstPlane) {
+      cgnsFn<cgp_poly_elements_write_data>(fn, B, Z, S, section.start,
+                                           section.end, conn->data(),
+                                           offsets->data());
+    } else {
+      cgnsFn<cgp_poly_elements_write_data>(fn, B, Z, S, section.start,
+                                           section.end, nullptr, nullptr);
+    }
+    return;
+  }
+
+  cgnsFn<cgp_section_write>(fn, B, Z, section.name.c_str(), section.type,
+                            section.start, section.end, section.nBoundary,
+                            &S);
+
+  std::visit(
+      overloaded{
+          [fn, B, Z, S, &section,
+           ownsFirstPlane](const std::vector<cgsize_t> &conn) {
+            if (ownsFirstPlane) {
+              cgnsFn<cgp_elements_write_data>(fn, B, Z, S, section.start,
+                                              section.end, conn.data());
+            } else {
+              cgnsFn<cgp_elements_write_data>(fn, B, Z, S, section.start,
+                                              section.end, nullptr);
+            }
+          },
+          [comm, fn, B, Z, S, &section](const structuredConnectivity &conn) {
+            // even split of the elements, every rank generates its part
+            // a single buffer is reused for all chunks
+            std::vector<cgsize_t> buffer{};
+            const std::size_t npe = conn.nodesPerElement();
+
+            writeElementsSplit(comm, fn, B, Z, S, section,
+                               conn.chunkElements(),
+                               [&](const cgsize_t first, const cgsize_t last) {
+                                 buffer.resize((last - first + 1) * npe);
+                                 conn.fill(first, last, buffer.data());
+                                 return buffer.data();
+                               });
+          },
+          [comm, fn, B, Z, S, &section](const storedConnectivity &stored) {
+            // even split of the elements, every rank reads its part
+            std::vector<cgsize_t> buffer{};
+            std::vector<cgsize_t> offsets{};
+
+            writeElementsSplit(comm, fn, B, Z, S, section,
+                               stored.chunkElements(storedChunkBytes),
+                               [&](const cgsize_t first, const cgsize_t last) {
+                                 stored.read(first, last, buffer, offsets);
+                                 return buffer.data();
+                               });
+          }},
+      section.connectivity);
+}
+
+} // namespace
+
+ownershipFn zonesRoundRobin(MPI_Comm comm) {
+  const int r = rank(comm);
+  const int n = nRanks(comm);
+
+  return [r, n](const int, const int Z,
+                const zoneV &zone) -> std::optional<zoneShare> {
+    if ((Z - 1) % n != r) {
+      return std::nullopt;
+    }
+    return zoneShare{1, vertexSize(zone).back()};
+  };
+}
+
+ownershipFn zoneSlabs(MPI_Comm comm) {
+  const int r = rank(comm);
+  const int n = nRanks(comm);
+
+  return [r, n](const int, const int,
+                const zoneV &zone) -> std::optional<zoneShare> {
+    const cgsize_t nPlanes = vertexSize(zone).back();
+    const zoneShare share{1 + nPlanes * r / n, nPlanes * (r + 1) / n};
+
+    if (share.begin > share.end) {
+      return std::nullopt;
+    }
+    return share;
+  };
+}
+
+void writeFileParallel(MPI_Comm comm, const std::string &path, const root &r,
+                       const ownershipFn &own) {
+  CGNS_TOOLS_INFO("Openening CGNS file in parallel : {}", path);
+
+  cgnsFn<cgp_mpi_comm>(comm);
+
+  int fn = 0;
+  cgnsFn<cgp_open>(path.c_str(), CG_MODE_WRITE, &fn);
+
+  for (const auto &base : r.bases) {
+    int B = 0;
+    cgnsFn<cg_base_write>(fn, base.name.c_str(), base.cellDimension,
+                          base.physicalDimension, &B);
+
+    CGNS_TOOLS_INFO(indent(2, "Writing Base {}", B));
+
+    for (const auto &zone : base.zones) {
+      const auto &z = std::visit(
+          [](const auto &z) -> const cgns_tools::zone & { return z; }, zone);
+
+      const std::vector<cgsize_t> size =
+          std::visit([](const auto &z) { return z.size(); }, zone);
+      const ZoneType_t zonetype =
+          std::visit([](const auto &z) { return z.zonetype(); }, zone);
+
+      int Z = 0;
+      cgnsFn<cg_zone_write>(fn, B, z.name.c_str(), size.data(), zonetype, &Z);
+
+      const auto share = own(B, Z, zone);
+      const auto nVertex = vertexSize(zone);
+
+      CGNS_TOOLS_INFO(indent(4, "Writing Zone {} Block {}", Z, B));
+
+      if (z.familyName.has_value()) {
+        const std::scoped_lock lock{cgnsMutex()};
+        cgnsFn<cg_goto>(fn, B, "Zone_t", Z, "end");
+        cgnsFn<cg_famname_write>(z.familyName->c_str());
+      }
+
+      if (share) {
+        CGNS_TOOLS_DEBUG(
+            indent(6, "share : [{}, {}]", share->begin, share->end));
+      }
+
+      std::vector<cgsize_t> rangeMin{};
+      std::vector<cgsize_t> rangeMax{};
+      if (share) {
+        shareRange(nVertex, *share, rangeMin, rangeMax);
+      }
+
+      if (!z.flowSolutions.empty()) {
+        CGNS_TOOLS_WARN("Flow solutions of Zone {} Block {} are not written "
+                        "in parallel.",
+                        Z, B);
+      }
+
+      if (z.gridCoordinates.size() > 1) {
+        CGNS_TOOLS_WARN("Multiple grids in Zone {} Block {}. Only the first "
+                        "grid is written in parallel.",
+                        Z, B);
+      }
+
+      for (const auto &grid : z.gridCoordinates) {
+        for (const auto &data : grid.dataArrays) {
+          std::visit(
+              [&](const auto &da) {
+                int C = 0;
+                cgnsFn<cgp_coord_write>(fn, B, Z, da.dataType(),
+                                        da.name.c_str(), &C);
+
+                if (!share) {
+                  cgnsFn<cgp_coord_write_data>(fn, B, Z, C, nullptr, nullptr,
+                                               nullptr);
+                  return;
+                }
+
+                if (da.size() != shareLength(nVertex, *share)) {
+                  CGNS_TOOLS_ERROR("Coordinate {} of Zone {} Block {} holds "
+                                   "{} values, its share requires {}.",
+                                   da.name, Z, B, da.size(),
+                                   shareLength(nVertex, *share));
+                  exit(EXIT_FAILURE);
+                }
+
+                cgnsFn<cgp_coord_write_data>(fn, B, Z, C, rangeMin.data(),
+                                             rangeMax.data(),
+                                             da.data().data());
+              },
+              data);
+        }
+        break;
+      }
+
+      if (const auto *u = std::get_if<zoneUnstructured>(&zone)) {
+        for (const auto &section : u->sections) {
+          writeSectionParallel(comm, fn, B, Z, section,
+                               share && share->begin == 1);
+        }
+      }
+
+      // boundary conditions are metadata, written collectively by all ranks
+      for (const auto &bc : z.boundaryConditions) {
+        int BC = 0;
+        cgnsFn<cg_boco_write>(
+            fn, B, Z, bc.name.c_str(), bc.type, bc.pointSet,
+            static_cast<cgsize_t>(bc.points.size() / nVertex.size()),
+            bc.points.data(), &BC);
+        cgnsFn<cg_boco_gridlocation_write>(fn, B, Z, BC, bc.location);
+
+        if (bc.familyName.has_value()) {
+          const std::scoped_lock lock{cgnsMutex()};
+          cgnsFn<cg_goto>(fn, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC,
+                          "end");
+          cgnsFn<cg_famname_write>(bc.familyName->c_str());
+        }
+      }
+
+      if (const auto *s = std::get_if<zoneStructured>(&zone)) {
+        for (const auto &conn : s->connectivities) {
+          int I = 0;
+          cgnsFn<cg_1to1_write>(fn, B, Z, conn.name.c_str(),
+                                conn.donorName.c_str(), conn.range.data(),
+                                conn.donorRange.data(), conn.transform.data(),
+                                &I);
+        }
+      }
+    }
+
+    for (const auto &family : base.families) {
+      int Fam = 0;
+      cgnsFn<cg_family_write>(fn, B, family.name.c_str(), &Fam);
+
+      if (family.bc.has_value()) {
+        int BC = 0;
+        cgnsFn<cg_fambc_write>(fn, B, Fam, family.bc->name.c_str(),
+                               family.bc->bcType, &BC);
+      }
+    }
+  }
+
+  cgnsFn<cgp_close>(fn);
+}
+
+root parseParallel(MPI_Comm comm, const std::string &path,
+                   const ownershipFn &own) {
+  // metadata through the serial library, no bulk data is read, flow
+  // solutions are skipped and only the headers of the element sections are
+  // read
+  parseOptions options{};
+  options.lazy = true;
+  options.fields = std::vector<std::string>{};
+  options.sections = false;
+
+  root r = parse(path, options);
+
+  // shares and coordinate names, the lazy arrays are dropped before the file
+  // is opened in parallel
+  struct coordinate {
+    int B;
+    int Z;
+    int C;
+    std::optional<zoneShare> share;
+    std::vector<cgsize_t> nVertex;
+    gridCoordinateDataV *data;
+  };
+  std::vector<coordinate> coordinates{};
+
+  for (std::size_t b = 0; b < r.bases.size(); ++b) {
+    auto &zones = r.bases[b].zones;
+
+    for (std::size_t z = 0; z < zones.size(); ++z) {
+      const int B = static_cast<int>(b) + 1;
+      const int Z = static_cast<int>(z) + 1;
+
+      const auto share = own(B, Z, zones[z]);
+      const auto nVertex = vertexSize(zones[z]);
+
+      auto &grids =
+          std::visit([](auto &z) -> std::vector<gridCoordinatesT> & {
+            return z.gridCoordinates;
+          }, zones[z]);
+
+      if (grids.empty()) {
+        continue;
+      }
+
+      // the lazy arrays of further grids would keep the serial file open
+      if (grids.size() > 1) {
+        CGNS_TOOLS_WARN("Multiple grids in Zone {} Block {}. Only the first "
+                        "grid is read in parallel.",
+                        Z, B);
+        grids.erase(grids.begin() + 1, grids.end());
+      }
+
+      auto &dataArrays = grids.front().dataArrays;
+      for (std::size_t c = 0; c < dataArrays.size(); ++c) {
+        std::visit(
+            [](auto &da) {
+              using T = typename std::decay_t<decltype(da)>::value_type;
+              da = {std::move(da.name), buffer<T>{}};
+            },
+            dataArrays[c]);
+
+        coordinates.push_back(
+            {B, Z, static_cast<int>(c) + 1, share, nVertex, &dataArrays[c]});
+      }
+    }
+  }
+
+  CGNS_TOOLS_INFO("Openening CGNS file in parallel : {}", path);
+
+  cgnsFn<cgp_mpi_comm>(comm);
+
+  int fn = 0;
+  cgnsFn<cgp_open>(path.c_str(), CG_MODE_READ, &fn);
+
+  for (auto &c : coordinates) {
+    std::visit(
+        [&](auto &da) {
+          using T = typename std::decay_t<decltype(da)>::value_type;
+
+          if (!c.share) {
+            cgnsFn<cgp_coord_read_data>(fn, c.B, c.Z, c.C, nullptr, nullptr,
+                                        nullptr);
+            return;
+          }
+
+          std::vector<cgsize_t> rangeMin{};
+          std::vector<cgsize_t> rangeMax{};
+          shareRange(c.nVertex, *c.share, rangeMin, rangeMax);
+
+          buffer<T> data(shareLength(c.nVertex, *c.share));
+          cgnsFn<cgp_coord_read_data>(fn, c.B, c.Z, c.C, rangeMin.data(),
+                                      rangeMax.data(), data.data());
+
+          da = {std::move(da.name), std::move(data)};
+        },
+        *c.data);
+  }
+
+  cgnsFn<cgp_close>(fn);
+
+  return r;
+}
+
+} // namespace cgns_tools
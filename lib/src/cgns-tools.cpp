@@ -6,15 +6,26 @@
 #include <cgnslib.h>
 #include <cgnstypes.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <filesystem>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <variant>
 #include <vector>
 
+#include "../include/hash.hpp"
 #include "../include/logger.hpp"
+#include "../include/simd.hpp"
 #include "spdlog/spdlog.h"
 
 namespace cgns_tools {
@@ -75,54 +86,332 @@ std::string_view to_string(const BCType_t bc) {
   case FamilySpecified:
     return "FamilySpecified";
   default:
-    spdlog::error("Unknown  BCType_t ({}) encountered.", bc);
+    CGNS_TOOLS_ERROR("Unknown  BCType_t ({}) encountered.", bc);
     exit(EXIT_FAILURE);
   }
 }
 
+cgsize_t checkedProduct(const std::vector<cgsize_t> &extents) {
+  cgsize_t n = 1;
+  for (const auto i : extents) {
+    if (i < 0 || (i > 0 && n > std::numeric_limits<cgsize_t>::max() / i)) {
+      CGNS_TOOLS_ERROR("Array of extents [{}] exceeds the range of cgsize_t.",
+                       fmt::join(extents, " , "));
+      exit(EXIT_FAILURE);
+    }
+    n *= i;
+  }
+  return n;
+}
+
+std::vector<cgsize_t> zoneStructured::size() const {
+  std::vector<cgsize_t> size = {};
+  size.reserve(9);
+
+  assert(nVertex.size() == nCell.size() &&
+         nVertex.size() == nBoundVertex.size());
+
+  for (const auto i : nVertex) {
+    size.emplace_back(i);
+  }
+  for (const auto i : nCell) {
+    size.emplace_back(i);
+  }
+  for (const auto i : nBoundVertex) {
+    size.emplace_back(i);
+  }
+
+  return size;
+}
+
+std::vector<cgsize_t> zoneUnstructured::size() const {
+  return {nVertex, nCell, nBoundVertex};
+}
+
 file::file(const std::string &path, const fileMode mode) {
-  spdlog::info("Openening CGNS file : {}", path);
+  CGNS_TOOLS_INFO("Openening CGNS file : {}", path);
 
   cgnsFn<cg_open>(path.c_str(), static_cast<int>(mode), &_handle);
 
-  spdlog::info("File opened successfully");
+  CGNS_TOOLS_INFO("File opened successfully");
 
-  spdlog::debug("filename : {}", path);
+  CGNS_TOOLS_DEBUG("filename : {}", path);
 
   switch (mode) {
   case fileMode::read:
-    spdlog::debug("mode : {}", "CG_MODE_READ");
+    CGNS_TOOLS_DEBUG("mode : {}", "CG_MODE_READ");
     break;
   case fileMode::write:
-    spdlog::debug("mode : {}", "CG_MODE_WRITE");
+    CGNS_TOOLS_DEBUG("mode : {}", "CG_MODE_WRITE");
     break;
   case fileMode::modify:
-    spdlog::debug("mode : {}", "CG_MODE_MODIFY");
+    CGNS_TOOLS_DEBUG("mode : {}", "CG_MODE_MODIFY");
+    break;
   default:
-    spdlog::error("Unknown cgns file mode");
+    CGNS_TOOLS_ERROR("Unknown cgns file mode");
   }
 }
 
 file::~file() { cgnsFn<cg_close>(_handle); }
 
-fileIn::fileIn(const std::string &path) : file{path, fileMode::read} {}
+std::optional<std::uint64_t>
+file::readContentHash(const int B, const int Z, const char *parentLabel,
+                      const int P, const std::string &name) const {
+  // cg_goto sets a global position, the sequence must not be interleaved
+  const std::scoped_lock lock{cgnsMutex()};
+
+  cgnsFn<cg_goto>(_handle, B, "Zone_t", Z, parentLabel, P, name.c_str(), 0,
+                  "end");
+
+  int ndescriptors = 0;
+  cgnsFn<cg_ndescriptors>(&ndescriptors);
+
+  for (int D = 1; D <= ndescriptors; ++D) {
+    char descname[33] = "";
+    char *text = nullptr;
+    cgnsFn<cg_descriptor_read>(D, descname, &text);
+
+    const std::string value{text};
+    cg_free(text);
+
+    if (std::string_view{descname} == contentHashDescriptor) {
+      return std::stoull(value, nullptr, 16);
+    }
+  }
+
+  return std::nullopt;
+}
+
+void file::writeContentHash(const int B, const int Z, const char *parentLabel,
+                            const int P, const std::string &name,
+                            const std::uint64_t hash) const {
+  const std::scoped_lock lock{cgnsMutex()};
+
+  cgnsFn<cg_goto>(_handle, B, "Zone_t", Z, parentLabel, P, name.c_str(), 0,
+                  "end");
+  cgnsFn<cg_descriptor_write>(contentHashDescriptor,
+                              fmt::format("{:016x}", hash).c_str());
+}
+
+namespace {
+
+/// read files open in this process by their canonical path
+struct fileRegistry {
+  std::mutex mutex;
+  std::multimap<std::string, fileIn *> files;
+};
+
+fileRegistry &registry() {
+  static fileRegistry files{};
+  return files;
+}
+
+std::string canonical(const std::string &path) {
+  return std::filesystem::weakly_canonical(path).string();
+}
+
+} // namespace
+
+fileIn::fileIn(const std::string &path, const parseOptions &options)
+    : file{path, fileMode::read}, _path{path}, _options{options} {
+  if (!_options.memory && _options.useArena && !_options.lazy) {
+    _options.memory = std::make_shared<arena>();
+  }
+
+  auto &open = registry();
+  const std::scoped_lock lock{open.mutex};
+  open.files.emplace(canonical(_path), this);
+}
+
+fileIn::~fileIn() {
+  auto &open = registry();
+  const std::scoped_lock lock{open.mutex};
+  const auto [first, last] = open.files.equal_range(canonical(_path));
+  for (auto it = first; it != last; ++it) {
+    if (it->second == this) {
+      open.files.erase(it);
+      break;
+    }
+  }
+}
+
+std::vector<std::shared_ptr<fileIn>>
+fileIn::openFiles(const std::string &path) {
+  std::vector<std::shared_ptr<fileIn>> files{};
+
+  auto &open = registry();
+  const std::scoped_lock lock{open.mutex};
+  const auto [first, last] = open.files.equal_range(canonical(path));
+  for (auto it = first; it != last; ++it) {
+    // files only referenced by lazy arrays are owned by a shared_ptr
+    if (auto f = it->second->weak_from_this().lock()) {
+      files.emplace_back(std::move(f));
+    }
+  }
+  return files;
+}
+
+void fileIn::close() {
+  cgnsFn<cg_close>(_handle);
+  CGNS_TOOLS_DEBUG("Closed {} until reopened", _path);
+}
+
+void fileIn::reopen() {
+  cgnsFn<cg_open>(_path.c_str(), CG_MODE_READ, &_handle);
+  CGNS_TOOLS_DEBUG("Reopened {}", _path);
+}
+
+namespace {
+
+/// @brief apply the global backend settings of the write options, returns
+/// the path so that it can be used before the file is opened
+const std::string &configured(const std::string &path,
+                              const writeOptions &options) {
+  const std::scoped_lock lock{cgnsMutex()};
+
+  cgnsFn<cg_set_file_type>(static_cast<int>(options.type));
 
-fileOut::fileOut(const std::string &path) : file{path, fileMode::write} {}
+  // the compression is read per dataset and applied by fileOut::compressed
+  if (options.type == fileType::hdf5) {
+    // threshold and alignment as passed to H5Pset_alignment, 1 and 1 are the
+    // HDF5 defaults and reset the setting of a previous file
+    std::size_t alignment[2] = {1, 1};
+    if (options.alignment > 0) {
+      alignment[0] = options.alignmentThreshold;
+      alignment[1] = options.alignment;
+    }
+    cgnsFn<cg_configure>(CG_CONFIG_HDF5_ALIGNMENT, &alignment[0]);
+  }
+
+  CGNS_TOOLS_DEBUG("file type : {}", static_cast<int>(options.type));
+  CGNS_TOOLS_DEBUG("compression : {}", options.compression);
+  CGNS_TOOLS_DEBUG("alignment : {}", options.alignment);
+
+  return path;
+}
+
+} // namespace
+
+fileOut::fileOut(const std::string &path, const writeOptions &options)
+    : file{configured(path, options), fileMode::write}, _options{options} {}
+
+std::unique_lock<std::recursive_mutex> fileOut::compressed() const {
+  std::unique_lock lock{cgnsMutex()};
+
+  if (_options.type == fileType::hdf5) {
+    cgnsFn<cg_configure>(CG_CONFIG_HDF5_COMPRESS,
+                         reinterpret_cast<void *>(
+                             static_cast<std::intptr_t>(_options.compression)));
+  }
+
+  return lock;
+}
+
+namespace {
+
+/// convert n doubles to float
+CGNS_TOOLS_SIMD_CLONES void narrow(const double *CGNS_TOOLS_RESTRICT src,
+                                   const std::size_t n,
+                                   float *CGNS_TOOLS_RESTRICT dst) {
+  for (std::size_t i = 0; i < n; ++i) {
+    dst[i] = static_cast<float>(src[i]);
+  }
+}
+
+/// @brief split an array with the given dimensions (i fastest) into slabs of
+/// at most maxElements which are contiguous in memory: the full extent in
+/// the fast directions, a range in one direction and single indices in the
+/// slow directions. Calls fn(rangeMin, rangeMax, offset, count) per slab.
+template <typename F>
+void forEachSlab(const std::vector<cgsize_t> &dims,
+                 const std::size_t maxElements, F &&fn) {
+  const std::size_t nDim = dims.size();
+
+  // slowest direction d whose faster directions fit into a slab
+  std::size_t d = nDim - 1;
+  std::size_t inner = 1;
+  for (std::size_t e = 0; e < d; ++e) {
+    inner *= dims[e];
+  }
+  while (d > 0 && inner > maxElements) {
+    inner /= dims[--d];
+  }
+
+  const cgsize_t step = static_cast<cgsize_t>(
+      std::min<std::size_t>(std::max<std::size_t>(maxElements / inner, 1),
+                            dims[d]));
+
+  std::size_t nOuter = 1;
+  for (std::size_t e = d + 1; e < nDim; ++e) {
+    nOuter *= dims[e];
+  }
+
+  std::vector<cgsize_t> rangeMin(nDim, 1);
+  std::vector<cgsize_t> rangeMax(dims);
+
+  for (std::size_t o = 0; o < nOuter; ++o) {
+    for (std::size_t e = d + 1, rest = o; e < nDim; ++e) {
+      rangeMin[e] = rangeMax[e] = 1 + static_cast<cgsize_t>(rest % dims[e]);
+      rest /= dims[e];
+    }
 
-void fileOut::writeBaseInformation(const root root) const {
+    for (cgsize_t first = 1; first <= dims[d]; first += step) {
+      rangeMin[d] = first;
+      rangeMax[d] = std::min(first + step - 1, dims[d]);
+
+      const std::size_t count = inner * (rangeMax[d] - first + 1);
+      const std::size_t offset = inner * (o * dims[d] + first - 1);
+      fn(rangeMin, rangeMax, offset, count);
+    }
+  }
+}
+
+} // namespace
+
+template <typename T, typename Write>
+bool fileOut::writeNarrowed(const dataArray<T> &da,
+                            const std::vector<cgsize_t> &dims,
+                            Write &&write) const {
+  if constexpr (!std::is_same_v<T, double>) {
+    return false;
+  } else {
+    if (_options.precision != outputPrecision::single) {
+      return false;
+    }
+
+    const std::size_t maxElements =
+        std::max<std::size_t>(_options.stagingBytes / sizeof(float), 1);
+
+    // grows to the largest slab once and is reused afterwards
+    const std::size_t staging = std::min(da.size(), maxElements);
+    if (_staging.size() < staging) {
+      _staging.resize(staging);
+    }
+
+    const double *data = da.data().data();
+
+    forEachSlab(dims, maxElements,
+                [&](const std::vector<cgsize_t> &rangeMin,
+                    const std::vector<cgsize_t> &rangeMax,
+                    const std::size_t offset, const std::size_t count) {
+                  narrow(data + offset, count, _staging.data());
+                  write(rangeMin.data(), rangeMax.data(), _staging.data());
+                });
+
+    CGNS_TOOLS_DEBUG(indent(10, "{} converted to RealSingle", da.name));
+    return true;
+  }
+}
+
+void fileOut::writeBaseInformation(const root &root) const {
   const auto nbases = root.bases.size();
 
-  spdlog::debug(indent(2, "nbases : {}", nbases));
+  CGNS_TOOLS_DEBUG(indent(2, "nbases : {}", nbases));
 
-  for (const auto base : root.bases) {
-    int B = 0;
-    cgnsFn<cg_base_write>(_handle, base.name.c_str(), base.cellDimension,
-                          base.physicalDimension, &B);
-    spdlog::info(indent(2, "Writing Base {}", B));
-    spdlog::debug(indent(4, "basename: {}", base.name));
-    spdlog::debug(indent(4, "cell_dim : {}", base.cellDimension));
-    spdlog::debug(indent(4, "phys_dim : {}", base.physicalDimension));
-    spdlog::debug(indent(4, "nZone : {}", base.zones.size()));
+  for (const auto &base : root.bases) {
+    const int B = this->writeBaseHeader(base);
+
+    CGNS_TOOLS_DEBUG(indent(4, "nZone : {}", base.zones.size()));
 
     for (const auto &zone : base.zones) {
       this->writeZoneInformation(B, zone);
@@ -134,58 +423,88 @@ void fileOut::writeBaseInformation(const root root) const {
   }
 }
 
+int fileOut::writeBaseHeader(const base &base) const {
+  int B = 0;
+  cgnsFn<cg_base_write>(_handle, base.name.c_str(), base.cellDimension,
+                        base.physicalDimension, &B);
+  CGNS_TOOLS_INFO(indent(2, "Writing Base {}", B));
+  CGNS_TOOLS_DEBUG(indent(4, "basename: {}", base.name));
+  CGNS_TOOLS_DEBUG(indent(4, "cell_dim : {}", base.cellDimension));
+  CGNS_TOOLS_DEBUG(indent(4, "phys_dim : {}", base.physicalDimension));
+
+  return B;
+}
+
 void fileOut::writeZoneInformation(const int B, const zoneV &zone) const {
   std::visit(
       overloaded{
           [this, handle = _handle, B](const zoneStructured &zone) {
-            std::vector<cgsize_t> size = {};
-            size.reserve(9);
-
-            assert(zone.nVertex.size() == zone.nCell.size() &&
-                   zone.nVertex.size() == zone.nBoundVertex.size());
-
-            for (const auto i : zone.nVertex) {
-              size.emplace_back(i);
-            }
-            for (const auto i : zone.nCell) {
-              size.emplace_back(i);
-            }
-            for (const auto i : zone.nBoundVertex) {
-              size.emplace_back(i);
-            }
+            const std::vector<cgsize_t> size = zone.size();
 
             int Z = 0;
 
             cgnsFn<cg_zone_write>(handle, B, zone.name.c_str(), size.data(),
                                   zone.zonetype(), &Z);
 
-            spdlog::info(indent(4, "Writing Zone {} Block {}", Z, B));
-            spdlog::debug(indent(6, "zonetype : Structured"));
-            spdlog::debug(indent(6, "zonename : {}", zone.name));
-            spdlog::debug(indent(6, "size : [{}]", fmt::join(size, " , ")));
+            CGNS_TOOLS_INFO(indent(4, "Writing Zone {} Block {}", Z, B));
+            CGNS_TOOLS_DEBUG(indent(6, "zonetype : Structured"));
+            CGNS_TOOLS_DEBUG(indent(6, "zonename : {}", zone.name));
+            CGNS_TOOLS_DEBUG(indent(6, "size : [{}]", fmt::join(size, " , ")));
+
+            if (zone.familyName.has_value()) {
+              this->writeZoneFamilyName(B, Z, *zone.familyName);
+            }
 
             for (const auto &grid : zone.gridCoordinates) {
               this->writeZoneGridCoordinates(B, Z, grid);
             }
+
+            for (const auto &solution : zone.flowSolutions) {
+              this->writeFlowSolution(B, Z, solution);
+            }
+
+            for (const auto &bc : zone.boundaryConditions) {
+              this->writeBoundaryCondition(B, Z, bc);
+            }
+
+            for (const auto &conn : zone.connectivities) {
+              this->writeConnectivity1to1(B, Z, conn);
+            }
           },
           [this, handle = _handle, B](const zoneUnstructured &zone) {
             int Z = 0;
 
-            std::vector<cgsize_t> size = {zone.nVertex, zone.nCell,
-                                          zone.nBoundVertex};
+            const std::vector<cgsize_t> size = zone.size();
 
             cgnsFn<cg_zone_write>(handle, B, zone.name.c_str(), size.data(),
                                   zone.zonetype(), &Z);
 
-            spdlog::info(indent(4, "Writing Zone {}", Z));
-            spdlog::debug(indent(6, "Z : {}", Z));
-            spdlog::debug(indent(6, "zonetype : Unstructured"));
-            spdlog::debug(indent(6, "zonename : {}", zone.name));
-            spdlog::debug(indent(6, "size : {}", fmt::join(size, " , ")));
+            CGNS_TOOLS_INFO(indent(4, "Writing Zone {}", Z));
+            CGNS_TOOLS_DEBUG(indent(6, "Z : {}", Z));
+            CGNS_TOOLS_DEBUG(indent(6, "zonetype : Unstructured"));
+            CGNS_TOOLS_DEBUG(indent(6, "zonename : {}", zone.name));
+            CGNS_TOOLS_DEBUG(indent(6, "size : {}", fmt::join(size, " , ")));
+            CGNS_TOOLS_DEBUG(indent(6, "nsections : {}", zone.sections.size()));
+
+            if (zone.familyName.has_value()) {
+              this->writeZoneFamilyName(B, Z, *zone.familyName);
+            }
 
             for (const auto &grid : zone.gridCoordinates) {
               this->writeZoneGridCoordinates(B, Z, grid);
             }
+
+            for (const auto &solution : zone.flowSolutions) {
+              this->writeFlowSolution(B, Z, solution);
+            }
+
+            for (const auto &section : zone.sections) {
+              this->writeElementSection(B, Z, section);
+            }
+
+            for (const auto &bc : zone.boundaryConditions) {
+              this->writeBoundaryCondition(B, Z, bc);
+            }
           }},
       zone);
 }
@@ -195,313 +514,1266 @@ void fileOut::writeZoneGridCoordinates(const int B, const int Z,
   int G = 0;
   cgnsFn<cg_grid_write>(_handle, B, Z, grid.name.c_str(), &G);
 
-  spdlog::info(
+  CGNS_TOOLS_INFO(
       indent(6, "Writing Grid Coordinates {} Zone {} Block {}", G, Z, B));
-  spdlog::debug(indent(8, "G : {}", G));
-  spdlog::debug(indent(8, "GridCoordName : {}", grid.name));
-  spdlog::debug(indent(8, "ncoords : {}", grid.dataArrays.size()));
+  CGNS_TOOLS_DEBUG(indent(8, "G : {}", G));
+  CGNS_TOOLS_DEBUG(indent(8, "GridCoordName : {}", grid.name));
+  CGNS_TOOLS_DEBUG(indent(8, "ncoords : {}", grid.dataArrays.size()));
 
   for (const auto &data : grid.dataArrays) {
-    this->writeZoneGridCoordinateData(B, Z, data);
+    this->writeZoneGridCoordinateData(B, Z, data, G);
   }
 }
 
-void fileOut::writeZoneGridCoordinateData(
-    const int B, const int Z, const gridCoordinateDataV &data) const {
+void fileOut::writeZoneGridCoordinateData(const int B, const int Z,
+                                          const gridCoordinateDataV &data,
+                                          const int G) const {
   int C = 0;
   std::visit(
-      [handle = _handle, B, Z, &C](const auto &da) {
-        cgnsFn<cg_coord_write>(handle, B, Z, da.dataType(), da.name.c_str(),
-                               da.data.data(), &C);
-
-        spdlog::info(
+      [this, handle = _handle, B, Z, G, &C](const auto &da) {
+        int index_dim = 0;
+        cgnsFn<cg_index_dim>(handle, B, Z, &index_dim);
+
+        char zonename[33];
+        cgsize_t size[9];
+        cgnsFn<cg_zone_read>(handle, B, Z, zonename, &size[0]);
+
+        const std::vector<cgsize_t> dims(&size[0], &size[index_dim]);
+
+        const bool narrowed = this->writeNarrowed(
+            da, dims,
+            [&](const cgsize_t *rangeMin, const cgsize_t *rangeMax,
+                const float *slab) {
+              const auto lock = this->compressed();
+
+              if (G == 1) {
+                cgnsFn<cg_coord_partial_write>(handle, B, Z, RealSingle,
+                                               da.name.c_str(), rangeMin,
+                                               rangeMax, slab, &C);
+                return;
+              }
+
+              // cg_coord_partial_write only addresses the first grid
+              cgsize_t count = 1;
+              for (int d = 0; d < index_dim; ++d) {
+                count *= rangeMax[d] - rangeMin[d] + 1;
+              }
+              const cgsize_t first = 1;
+
+              cgnsFn<cg_goto>(handle, B, "Zone_t", Z, "GridCoordinates_t",
+                              G, "end");
+              cgnsFn<cg_array_general_write>(
+                  da.name.c_str(), RealSingle, index_dim, &size[0],
+                  rangeMin, rangeMax, RealSingle, 1, &count, &first, &count,
+                  slab);
+            });
+
+        if (narrowed) {
+          // written in slabs
+        } else if (G == 1) {
+          const auto lock = this->compressed();
+          cgnsFn<cg_coord_write>(handle, B, Z, da.dataType(), da.name.c_str(),
+                                 da.data().data(), &C);
+        } else {
+          // cg_coord_write only addresses the first grid
+          const auto lock = this->compressed();
+
+          cgnsFn<cg_goto>(handle, B, "Zone_t", Z, "GridCoordinates_t", G,
+                          "end");
+          cgnsFn<cg_array_write>(da.name.c_str(), da.dataType(), index_dim,
+                                 &size[0], da.data().data());
+        }
+
+        if (!narrowed && _options.contentHashes) {
+          this->writeContentHash(
+              B, Z, "GridCoordinates_t", G, da.name,
+              contentHash(da.data().data(), da.size() * sizeof(da.data()[0])));
+        }
+
+        CGNS_TOOLS_INFO(
             indent(8, "Writing Data {} Grid Coordinates {} Zone {} Block {}", C,
-                   1, Z, B));
-        spdlog::debug(indent(10, "C : {}", C));
-        spdlog::debug(indent(10, "CoordName : {}", da.name));
-        spdlog::debug(indent(10, "size : {}", da.data.size()));
+                   G, Z, B));
+        CGNS_TOOLS_DEBUG(indent(10, "C : {}", C));
+        CGNS_TOOLS_DEBUG(indent(10, "CoordName : {}", da.name));
+        CGNS_TOOLS_DEBUG(indent(10, "size : {}", da.size()));
       },
       data);
 }
 
+void fileOut::writeCoordinates(const int B, const int Z,
+                               const std::string &coordname,
+                               const DataType_t memType,
+                               const cgsize_t *rangeMin,
+                               const cgsize_t *rangeMax,
+                               const void *data) const {
+  int C = 0;
+  const auto lock = this->compressed();
+  cgnsFn<cg_coord_partial_write>(_handle, B, Z, memType, coordname.c_str(),
+                                 rangeMin, rangeMax, data, &C);
+}
+
+void fileOut::writeFlowSolution(const int B, const int Z,
+                                const flowSolution &solution) const {
+  int S = 0;
+  cgnsFn<cg_sol_write>(_handle, B, Z, solution.name.c_str(), solution.location,
+                       &S);
+
+  CGNS_TOOLS_INFO(
+      indent(6, "Writing Flow Solution {} Zone {} Block {}", S, Z, B));
+  CGNS_TOOLS_DEBUG(indent(8, "S : {}", S));
+  CGNS_TOOLS_DEBUG(indent(8, "SolutionName : {}", solution.name));
+  CGNS_TOOLS_DEBUG(
+      indent(8, "GridLocation : {}", cg_GridLocationName(solution.location)));
+  CGNS_TOOLS_DEBUG(indent(8, "nfields : {}", solution.fields.size()));
+
+  // dimensions of the fields, depending on the grid location
+  int data_dim = 0;
+  cgsize_t dims[3];
+  cgnsFn<cg_sol_size>(_handle, B, Z, S, &data_dim, &dims[0]);
+
+  for (const auto &field : solution.fields) {
+    std::visit(
+        [this, handle = _handle, B, Z, S,
+         fieldDims = std::vector<cgsize_t>(&dims[0], &dims[data_dim])](
+            const auto &da) {
+          int F = 0;
+          const bool narrowed = this->writeNarrowed(
+              da, fieldDims,
+              [&](const cgsize_t *rangeMin, const cgsize_t *rangeMax,
+                  const float *slab) {
+                const auto lock = this->compressed();
+                cgnsFn<cg_field_partial_write>(handle, B, Z, S, RealSingle,
+                                               da.name.c_str(), rangeMin,
+                                               rangeMax, slab, &F);
+              });
+
+          if (!narrowed) {
+            const auto lock = this->compressed();
+            cgnsFn<cg_field_write>(handle, B, Z, S, da.dataType(),
+                                   da.name.c_str(), da.data().data(), &F);
+
+            if (_options.contentHashes) {
+              this->writeContentHash(B, Z, "FlowSolution_t", S, da.name,
+                                     contentHash(da.data().data(),
+                                                 da.size() *
+                                                     sizeof(da.data()[0])));
+            }
+          }
+
+          CGNS_TOOLS_DEBUG(indent(10, "{} : {}", da.name, da.size()));
+        },
+        field);
+  }
+}
+
+void fileOut::writeElementSection(const int B, const int Z,
+                                  const elementSection &section) const {
+  const cgsize_t nElements = section.nElements();
+  const cgsize_t budget =
+      std::max<cgsize_t>(1, static_cast<cgsize_t>(_options.sectionChunkBytes /
+                                                  sizeof(cgsize_t)));
+
+  std::visit(
+      overloaded{
+          [this, B, Z, &section, nElements,
+           budget](const std::vector<cgsize_t> &conn) {
+            const int S = this->writeSectionHeader(
+                B, Z, section, static_cast<cgsize_t>(conn.size()));
+
+            if (!hasStartOffset(section.type)) {
+              int npe = 0;
+              cgnsFn<cg_npe>(section.type, &npe);
+
+              const cgsize_t nChunk = std::max<cgsize_t>(1, budget / npe);
+
+              for (cgsize_t first = 0; first < nElements; first += nChunk) {
+                const cgsize_t last = std::min(first + nChunk, nElements) - 1;
+
+                this->writeElements(B, Z, S, section.type,
+                                    section.start + first,
+                                    section.start + last,
+                                    conn.data() + first * npe);
+              }
+              return;
+            }
+
+            if (section.offsets.size() !=
+                static_cast<std::size_t>(nElements + 1)) {
+              CGNS_TOOLS_ERROR("Section {} has {} offsets, expected {}.",
+                               section.name, section.offsets.size(),
+                               nElements + 1);
+              exit(EXIT_FAILURE);
+            }
+
+            // chunks of whole elements, the offsets are rebased per chunk
+            std::vector<cgsize_t> offsets{};
+
+            for (cgsize_t first = 0; first < nElements;) {
+              cgsize_t last = first;
+              while (last + 1 < nElements &&
+                     section.offsets[last + 2] - section.offsets[first] +
+                             (last - first + 3) <=
+                         budget) {
+                ++last;
+              }
+
+              offsets.assign(section.offsets.begin() + first,
+                             section.offsets.begin() + last + 2);
+              const cgsize_t base = offsets.front();
+              for (auto &offset : offsets) {
+                offset -= base;
+              }
+
+              this->writeElements(B, Z, S, section.type,
+                                  section.start + first, section.start + last,
+                                  conn.data() + base, offsets.data());
+
+              first = last + 1;
+            }
+          },
+          [this, B, Z, &section,
+           nElements](const structuredConnectivity &conn) {
+            const int S = this->writeSectionHeader(
+                B, Z, section, nElements * conn.nodesPerElement());
+
+            const cgsize_t nChunk = conn.chunkElements();
+
+            // a single buffer is reused for all chunks
+            std::vector<cgsize_t> buffer(
+                static_cast<std::size_t>(std::min(nChunk, nElements)) *
+                conn.nodesPerElement());
+
+            CGNS_TOOLS_DEBUG(indent(8, "chunk : {} elements", nChunk));
+
+            for (cgsize_t first = 1; first <= nElements; first += nChunk) {
+              const cgsize_t last = std::min(first + nChunk - 1, nElements);
+
+              conn.fill(first, last, buffer.data());
+
+              this->writeElements(B, Z, S, section.type,
+                                  section.start + first - 1,
+                                  section.start + last - 1, buffer.data());
+            }
+          },
+          [this, B, Z, &section,
+           nElements](const storedConnectivity &stored) {
+            const int S =
+                this->writeSectionHeader(B, Z, section, stored.dataSize);
+
+            const cgsize_t nChunk =
+                stored.chunkElements(_options.sectionChunkBytes);
+
+            // the buffers are reused for all chunks
+            std::vector<cgsize_t> conn{};
+            std::vector<cgsize_t> offsets{};
+
+            CGNS_TOOLS_DEBUG(indent(8, "chunk : {} elements", nChunk));
+
+            for (cgsize_t first = 1; first <= nElements; first += nChunk) {
+              const cgsize_t last = std::min(first + nChunk - 1, nElements);
+
+              stored.read(first, last, conn, offsets);
+
+              this->writeElements(B, Z, S, section.type,
+                                  section.start + first - 1,
+                                  section.start + last - 1, conn.data(),
+                                  offsets.empty() ? nullptr : offsets.data());
+            }
+          }},
+      section.connectivity);
+}
+
+int fileOut::writeSectionHeader(const int B, const int Z,
+                                const elementSection &section,
+                                const cgsize_t dataSize) const {
+  constexpr DataType_t connectivityType =
+      sizeof(cgsize_t) == sizeof(std::int64_t) ? LongInteger : Integer;
+
+  int S = 0;
+  const auto lock = this->compressed();
+  cgnsFn<cg_section_general_write>(_handle, B, Z, section.name.c_str(),
+                                   section.type, connectivityType,
+                                   section.start, section.end, dataSize,
+                                   section.nBoundary, &S);
+
+  CGNS_TOOLS_INFO(indent(6, "Writing Section {} Zone {} Block {}", S, Z, B));
+  CGNS_TOOLS_DEBUG(indent(8, "S : {}", S));
+  CGNS_TOOLS_DEBUG(indent(8, "SectionName : {}", section.name));
+  CGNS_TOOLS_DEBUG(indent(8, "ElementType : {}",
+                          cg_ElementTypeName(section.type)));
+  CGNS_TOOLS_DEBUG(indent(8, "range : [{}, {}]", section.start, section.end));
+  CGNS_TOOLS_DEBUG(indent(8, "ElementDataSize : {}", dataSize));
+
+  return S;
+}
+
+void fileOut::writeElements(const int B, const int Z, const int S,
+                            const ElementType_t type, const cgsize_t first,
+                            const cgsize_t last, const cgsize_t *conn,
+                            const cgsize_t *offsets) const {
+  if (hasStartOffset(type)) {
+    if (offsets == nullptr) {
+      CGNS_TOOLS_ERROR("Writing {} elements requires offsets.",
+                       cg_ElementTypeName(type));
+      exit(EXIT_FAILURE);
+    }
+    cgnsFn<cg_poly_elements_partial_write>(_handle, B, Z, S, first, last,
+                                           conn, offsets);
+  } else {
+    cgnsFn<cg_elements_partial_write>(_handle, B, Z, S, first, last, conn);
+  }
+
+  CGNS_TOOLS_DEBUG(indent(10, "written : [{}, {}]", first, last));
+}
+
+void fileOut::writeZoneFamilyName(const int B, const int Z,
+                                  const std::string &familyName) const {
+  const std::scoped_lock lock{cgnsMutex()};
+  cgnsFn<cg_goto>(_handle, B, "Zone_t", Z, "end");
+  cgnsFn<cg_famname_write>(familyName.c_str());
+
+  CGNS_TOOLS_DEBUG(indent(6, "FamilyName : {}", familyName));
+}
+
+void fileOut::writeConnectivity1to1(const int B, const int Z,
+                                    const connectivity1to1 &conn) const {
+  int I = 0;
+  cgnsFn<cg_1to1_write>(_handle, B, Z, conn.name.c_str(),
+                        conn.donorName.c_str(), conn.range.data(),
+                        conn.donorRange.data(), conn.transform.data(), &I);
+
+  CGNS_TOOLS_DEBUG(indent(6, "I : {}", I));
+  CGNS_TOOLS_DEBUG(indent(6, "connectname : {}", conn.name));
+  CGNS_TOOLS_DEBUG(indent(6, "donorname : {}", conn.donorName));
+}
+
+void fileOut::writeBoundaryCondition(const int B, const int Z,
+                                     const boundaryCondition &bc) const {
+  int index_dim = 0;
+  cgnsFn<cg_index_dim>(_handle, B, Z, &index_dim);
+
+  const cgsize_t npnts = static_cast<cgsize_t>(bc.points.size()) / index_dim;
+
+  int BC = 0;
+  cgnsFn<cg_boco_write>(_handle, B, Z, bc.name.c_str(), bc.type, bc.pointSet,
+                        npnts, bc.points.data(), &BC);
+  cgnsFn<cg_boco_gridlocation_write>(_handle, B, Z, BC, bc.location);
+
+  CGNS_TOOLS_DEBUG(indent(6, "BC : {}", BC));
+  CGNS_TOOLS_DEBUG(indent(6, "BCName : {}", bc.name));
+  CGNS_TOOLS_DEBUG(indent(6, "BCType : {}", to_string(bc.type)));
+  CGNS_TOOLS_DEBUG(indent(6, "npnts : {}", npnts));
+
+  if (bc.familyName.has_value()) {
+    const std::scoped_lock lock{cgnsMutex()};
+    cgnsFn<cg_goto>(_handle, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC, "end");
+    cgnsFn<cg_famname_write>(bc.familyName->c_str());
+
+    CGNS_TOOLS_DEBUG(indent(6, "FamilyName : {}", *bc.familyName));
+  }
+}
+
 void fileOut::writeFamilyDefinition(const int B, const family &family) const {
   int Fam = 0;
   cgnsFn<cg_family_write>(_handle, B, family.name.c_str(), &Fam);
 
-  spdlog::debug(indent(4, "Fam : {}", Fam));
-  spdlog::debug(indent(4, "FamilyName : {}", family.name));
+  CGNS_TOOLS_DEBUG(indent(4, "Fam : {}", Fam));
+  CGNS_TOOLS_DEBUG(indent(4, "FamilyName : {}", family.name));
 
   if (family.bc.has_value()) {
     const auto &famBc = *family.bc;
-    spdlog::debug(indent(4, "nFamBC : 1"));
+    CGNS_TOOLS_DEBUG(indent(4, "nFamBC : 1"));
 
     int BC = 0;
     cgnsFn<cg_fambc_write>(_handle, B, Fam, famBc.name.c_str(), famBc.bcType,
                            &BC);
 
-    spdlog::debug(indent(4, "FamBCName : {}", famBc.name));
-    spdlog::debug(indent(4, "BCType : {}", to_string(famBc.bcType)));
+    CGNS_TOOLS_DEBUG(indent(4, "FamBCName : {}", famBc.name));
+    CGNS_TOOLS_DEBUG(indent(4, "BCType : {}", to_string(famBc.bcType)));
   } else {
-    spdlog::debug(indent(4, "nFamBC : 0"));
+    CGNS_TOOLS_DEBUG(indent(4, "nFamBC : 0"));
   }
 }
 
 std::vector<base> fileIn::readBaseInformation() const {
   std::vector<base> bases{};
 
-  int nbases = 0;
-  cgnsFn<cg_nbases>(_handle, &nbases);
+  const int nbases = this->nBases();
 
-  spdlog::debug(indent(2, "nbases : {}", nbases));
+  CGNS_TOOLS_DEBUG(indent(2, "nbases : {}", nbases));
 
   bases.reserve(nbases);
 
   for (int B = 1; B <= nbases; ++B) {
-    spdlog::info(indent(2, "Reading Base {}", B));
+    base base = this->readBaseHeader(B);
+    base.zones = this->readZoneInformation(B);
+    bases.emplace_back(std::move(base));
+  }
 
-    spdlog::debug(indent(2, "B : {}", B));
+  return bases;
+}
+
+int fileIn::nBases() const {
+  int nbases = 0;
+  cgnsFn<cg_nbases>(_handle, &nbases);
+  return nbases;
+}
+
+int fileIn::nZones(const int B) const {
+  int nzones = 0;
+  cgnsFn<cg_nzones>(_handle, B, &nzones);
+  return nzones;
+}
 
-    char basename[33] = "";
-    int cell_dim = 0;
-    int phys_dim = 0;
-    cgnsFn<cg_base_read>(_handle, B, basename, &cell_dim, &phys_dim);
+base fileIn::readBaseHeader(const int B) const {
+  CGNS_TOOLS_INFO(indent(2, "Reading Base {}", B));
 
-    spdlog::debug(indent(4, "basename: {}", basename));
-    spdlog::debug(indent(4, "cell_dim : {}", cell_dim));
-    spdlog::debug(indent(4, "phys_dim : {}", phys_dim));
+  CGNS_TOOLS_DEBUG(indent(2, "B : {}", B));
 
-    std::vector<zoneV> zones = this->readZoneInformation(B);
+  char basename[33] = "";
+  int cell_dim = 0;
+  int phys_dim = 0;
+  cgnsFn<cg_base_read>(_handle, B, basename, &cell_dim, &phys_dim);
 
-    auto families = this->readFamilyDefinition(B);
+  CGNS_TOOLS_DEBUG(indent(4, "basename: {}", basename));
+  CGNS_TOOLS_DEBUG(indent(4, "cell_dim : {}", cell_dim));
+  CGNS_TOOLS_DEBUG(indent(4, "phys_dim : {}", phys_dim));
 
-    bases.emplace_back(basename, cell_dim, phys_dim, std::move(zones),
-                       std::move(families));
-  }
+  auto families = this->readFamilyDefinition(B);
 
-  return bases;
+  return {basename, static_cast<unsigned>(cell_dim),
+          static_cast<unsigned>(phys_dim), {}, std::move(families)};
 }
 
 std::vector<zoneV> fileIn::readZoneInformation(const int B) const {
   std::vector<zoneV> zones{};
 
-  int nzones = 0;
-  cgnsFn<cg_nzones>(_handle, B, &nzones);
+  const int nzones = this->nZones(B);
 
-  spdlog::debug(indent(4, "nzones : {}", nzones));
+  CGNS_TOOLS_DEBUG(indent(4, "nzones : {}", nzones));
 
   zones.reserve(nzones);
 
-  for (int Z = 1; Z <= nzones; ++Z) {
-    spdlog::info(indent(4, "Reading Zone {} of Base {}", Z, B));
+  const unsigned nThreads =
+      std::min<unsigned>(_options.nThreads, static_cast<unsigned>(nzones));
 
-    spdlog::debug(indent(6, "Z : {}", Z));
+  if (nThreads <= 1) {
+    for (int Z = 1; Z <= nzones; ++Z) {
+      zones.emplace_back(this->readZone(B, Z));
+    }
+    return zones;
+  }
 
-    ZoneType_t zonetype;
-    cgnsFn<cg_zone_type>(_handle, B, Z, &zonetype);
+  CGNS_TOOLS_INFO(
+      indent(4, "Reading {} Zones with {} threads", nzones, nThreads));
 
-    switch (zonetype) {
-    case Structured:
-      spdlog::debug(indent(6, "zonetype : Structured"));
-      break;
-    case Unstructured:
-      spdlog::debug(indent(6, "zonetype : Unstructured"));
-      break;
-    default:
-      spdlog::error("Unknown zonetype ({}) encountered.", zonetype);
-      exit(EXIT_FAILURE);
-    }
+  // each worker reads through its own file handle, the zones are assigned
+  // dynamically as their sizes vary strongly
+  std::vector<std::optional<zoneV>> read(nzones);
+  std::vector<std::uint64_t> bytesRead(nThreads, 0);
+  std::atomic<int> next = 1;
 
-    int index_dim = 0;
-    cgnsFn<cg_index_dim>(_handle, B, Z, &index_dim);
+  parallelForBlocks(
+      0, nThreads,
+      [this, B, nzones, &read, &bytesRead, &next](std::size_t worker,
+                                                  std::size_t) {
+        parseOptions options = _options;
+        options.nThreads = 1;
 
-    spdlog::debug(indent(6, "index_dim : {}", index_dim));
+        const auto f = std::make_shared<fileIn>(_path, options);
 
-    char zonename[33];
+        for (int Z = next++; Z <= nzones; Z = next++) {
+          read[Z - 1].emplace(f->readZone(B, Z));
+        }
 
-    cgsize_t size[9];
-    cgnsFn<cg_zone_read>(_handle, B, Z, zonename, &size[0]);
+        bytesRead[worker] = f->bytesRead();
+      },
+      nThreads);
 
-    spdlog::debug(indent(6, "zonename : {}", zonename));
-    spdlog::debug(indent(6, "size : {}", size[0]));
-    for (int i = 1; i < 9; ++i) {
-      spdlog::debug(indent(6, "       {}", size[i]));
-    }
+  // the workers read through their own handles
+  for (const auto bytes : bytesRead) {
+    _bytesRead += bytes;
+  }
 
-    if (zonetype == Structured) {
-      unsigned VertexSize[3] = {};
-      unsigned CellSize[3] = {};
-      unsigned VertexSizeBoundary[3] = {};
-
-      if (index_dim == 2) {
-        VertexSize[0] = static_cast<unsigned int>(size[0]);
-        VertexSize[1] = static_cast<unsigned int>(size[1]);
-
-        CellSize[0] = static_cast<unsigned int>(size[2]);
-        CellSize[1] = static_cast<unsigned int>(size[3]);
-
-        VertexSizeBoundary[0] = static_cast<unsigned int>(size[4]);
-        VertexSizeBoundary[1] = static_cast<unsigned int>(size[5]);
-
-        spdlog::debug(indent(6, "VertexSize : {}", VertexSize[0]));
-        spdlog::debug(indent(6, "             {}", VertexSize[1]));
-
-        spdlog::debug(indent(6, "CellSize : {}", CellSize[0]));
-        spdlog::debug(indent(6, "           {}", CellSize[1]));
-
-        spdlog::debug(
-            indent(6, "VertexSizeBoundary : {}", VertexSizeBoundary[0]));
-        spdlog::debug(
-            indent(6, "                     {}", VertexSizeBoundary[1]));
-      } else if (index_dim == 3) {
-        VertexSize[0] = static_cast<unsigned int>(size[0]);
-        VertexSize[1] = static_cast<unsigned int>(size[1]);
-        VertexSize[2] = static_cast<unsigned int>(size[2]);
-
-        CellSize[0] = static_cast<unsigned int>(size[3]);
-        CellSize[1] = static_cast<unsigned int>(size[4]);
-        CellSize[2] = static_cast<unsigned int>(size[5]);
-
-        VertexSizeBoundary[0] = static_cast<unsigned int>(size[6]);
-        VertexSizeBoundary[1] = static_cast<unsigned int>(size[7]);
-        VertexSizeBoundary[2] = static_cast<unsigned int>(size[8]);
-
-        spdlog::debug(indent(6, "VertexSize : {}", VertexSize[0]));
-        spdlog::debug(indent(6, "             {}", VertexSize[1]));
-        spdlog::debug(indent(6, "             {}", VertexSize[2]));
-
-        spdlog::debug(indent(6, "CellSize : {}", CellSize[0]));
-        spdlog::debug(indent(6, "           {}", CellSize[1]));
-        spdlog::debug(indent(6, "           {}", CellSize[2]));
-
-        spdlog::debug(
-            indent(6, "VertexSizeBoundary : {}", VertexSizeBoundary[0]));
-        spdlog::debug(
-            indent(6, "                     {}", VertexSizeBoundary[1]));
-        spdlog::debug(
-            indent(6, "                     {}", VertexSizeBoundary[2]));
-      } else {
-        spdlog::error("Unexpected index_dim ({}) encountered.", index_dim);
-        exit(EXIT_FAILURE);
-      }
+  for (auto &zone : read) {
+    zones.emplace_back(std::move(*zone));
+  }
 
-      std::vector<unsigned> nVertex{};
-      nVertex.reserve(index_dim);
+  return zones;
+}
 
-      std::vector<unsigned> nCell{};
-      nCell.reserve(index_dim);
+zoneV fileIn::readZone(const int B, const int Z) const {
+  CGNS_TOOLS_INFO(indent(4, "Reading Zone {} of Base {}", Z, B));
 
-      std::vector<unsigned> nBoundVertex{};
-      nBoundVertex.reserve(index_dim);
+  CGNS_TOOLS_DEBUG(indent(6, "Z : {}", Z));
 
-      for (int i = 0; i < index_dim; ++i) {
-        nVertex.emplace_back(VertexSize[i]);
-        nCell.emplace_back(CellSize[i]);
-        nBoundVertex.emplace_back(VertexSizeBoundary[i]);
-      }
+  ZoneType_t zonetype;
+  cgnsFn<cg_zone_type>(_handle, B, Z, &zonetype);
 
-      auto gridCoordinates = this->readZoneGridCoordinates(B, Z, nVertex);
+  switch (zonetype) {
+  case Structured:
+    CGNS_TOOLS_DEBUG(indent(6, "zonetype : Structured"));
+    break;
+  case Unstructured:
+    CGNS_TOOLS_DEBUG(indent(6, "zonetype : Unstructured"));
+    break;
+  default:
+    CGNS_TOOLS_ERROR("Unknown zonetype ({}) encountered.", zonetype);
+    exit(EXIT_FAILURE);
+  }
 
-      zones.emplace_back(
-          zoneStructured{zonename, std::move(nVertex), std::move(nCell),
-                         std::move(nBoundVertex), std::move(gridCoordinates)});
-    } else if (zonetype == Unstructured) {
-      unsigned VertexSize = static_cast<unsigned int>(size[0]);
-      unsigned CellSize = static_cast<unsigned int>(size[1]);
-      unsigned VertexSizeBoundary = static_cast<unsigned int>(size[2]);
+  int index_dim = 0;
+  cgnsFn<cg_index_dim>(_handle, B, Z, &index_dim);
 
-      auto gridCoordinates = this->readZoneGridCoordinates(B, Z, {VertexSize});
+  CGNS_TOOLS_DEBUG(indent(6, "index_dim : {}", index_dim));
 
-      zones.emplace_back(zoneUnstructured{zonename, VertexSize, CellSize,
-                                          VertexSizeBoundary,
-                                          std::move(gridCoordinates)});
-    } else {
-      spdlog::error("Unknown zonetype ({}) encountered.", zonetype);
+  char zonename[33];
+
+  cgsize_t size[9];
+  cgnsFn<cg_zone_read>(_handle, B, Z, zonename, &size[0]);
+
+  CGNS_TOOLS_DEBUG(indent(6, "zonename : {}", zonename));
+  CGNS_TOOLS_DEBUG(indent(6, "size : [{}]",
+                          fmt::join(&size[0], &size[3 * index_dim], " , ")));
+
+  if (zonetype == Structured) {
+    if (index_dim != 2 && index_dim != 3) {
+      CGNS_TOOLS_ERROR("Unexpected index_dim ({}) encountered.", index_dim);
       exit(EXIT_FAILURE);
     }
+
+    // size holds the vertex, cell and boundary vertex counts in turn
+    std::vector<cgsize_t> nVertex(&size[0], &size[index_dim]);
+    std::vector<cgsize_t> nCell(&size[index_dim], &size[2 * index_dim]);
+    std::vector<cgsize_t> nBoundVertex(&size[2 * index_dim],
+                                       &size[3 * index_dim]);
+
+    CGNS_TOOLS_DEBUG(indent(6, "VertexSize : [{}]", fmt::join(nVertex, " , ")));
+    CGNS_TOOLS_DEBUG(indent(6, "CellSize : [{}]", fmt::join(nCell, " , ")));
+    CGNS_TOOLS_DEBUG(indent(6, "VertexSizeBoundary : [{}]",
+                            fmt::join(nBoundVertex, " , ")));
+
+    auto gridCoordinates = this->readZoneGridCoordinates(B, Z, nVertex);
+
+    zoneStructured zone{zonename, std::move(nVertex), std::move(nCell),
+                        std::move(nBoundVertex), std::move(gridCoordinates)};
+    zone.flowSolutions = this->readFlowSolutions(B, Z);
+    zone.boundaryConditions = this->readBoundaryConditions(B, Z);
+    zone.connectivities = this->readConnectivity1to1(B, Z);
+    zone.familyName = this->readZoneFamilyName(B, Z);
+
+    return zone;
+  } else if (zonetype == Unstructured) {
+    const cgsize_t VertexSize = size[0];
+    const cgsize_t CellSize = size[1];
+    const cgsize_t VertexSizeBoundary = size[2];
+
+    auto gridCoordinates = this->readZoneGridCoordinates(B, Z, {VertexSize});
+
+    zoneUnstructured zone{zonename, VertexSize, CellSize, VertexSizeBoundary,
+                          std::move(gridCoordinates),
+                          this->readElementSections(B, Z)};
+    zone.flowSolutions = this->readFlowSolutions(B, Z);
+    zone.boundaryConditions = this->readBoundaryConditions(B, Z);
+    zone.familyName = this->readZoneFamilyName(B, Z);
+
+    return zone;
   }
 
-  return zones;
+  CGNS_TOOLS_ERROR("Unknown zonetype ({}) encountered.", zonetype);
+  exit(EXIT_FAILURE);
 }
 
 std::vector<gridCoordinatesT>
 fileIn::readZoneGridCoordinates(const int B, const int Z,
-                                const std::vector<unsigned> &nVertex) const {
+                                const std::vector<cgsize_t> &nVertex) const {
   std::vector<gridCoordinatesT> gridCoords{};
-  gridCoords.reserve(1);
 
-  spdlog::info(
+  CGNS_TOOLS_INFO(
       indent(6, "Reading Grid Coordinates of Zone {} of Base {}", Z, B));
 
-  int ngrids = 0;
-  cgnsFn<cg_ngrids>(_handle, B, Z, &ngrids);
+  const int ngrids = this->nGrids(B, Z);
 
-  spdlog::debug(indent(6, "ngrids : {}", ngrids));
+  CGNS_TOOLS_DEBUG(indent(6, "ngrids : {}", ngrids));
 
-  if (ngrids > 1) {
-    spdlog::warn("Multiple grids encountered in Zone {} Block {}. Not yet "
-                 "supported. Only first grid is parsed.",
-                 Z, B);
-  }
+  gridCoords.reserve(ngrids);
 
-  for (int G = 1; G <= 1; ++G) {
+  for (int G = 1; G <= ngrids; ++G) {
     char GridCoordName[33] = "";
     cgnsFn<cg_grid_read>(_handle, B, Z, G, GridCoordName);
 
-    spdlog::debug(indent(8, "G : {}", G));
-    spdlog::debug(indent(8, "GridCoordName : {}", GridCoordName));
+    CGNS_TOOLS_DEBUG(indent(8, "G : {}", G));
+    CGNS_TOOLS_DEBUG(indent(8, "GridCoordName : {}", GridCoordName));
 
-    int ncoords = 0;
-    cgnsFn<cg_ncoords>(_handle, B, Z, &ncoords);
+    // the coordinate functions only address the first grid (GridCoordinates),
+    // further grids are read as plain DataArray_t children
+    const auto arrays = this->readGridArrayInfo(B, Z, G);
 
-    spdlog::debug(indent(8, "ncoords : {}", ncoords));
+    CGNS_TOOLS_DEBUG(indent(8, "ncoords : {}", arrays.size()));
 
     std::vector<gridCoordinateDataV> data{};
-    data.reserve(ncoords);
+    data.reserve(arrays.size());
 
-    for (int C = 1; C <= ncoords; ++C) {
-      spdlog::debug(indent(10, "C : {}", C));
+    const std::size_t length = checkedProduct(nVertex);
 
-      DataType_t datatype;
-      char coordname[33] = "";
-      cgnsFn<cg_coord_info>(_handle, B, Z, C, &datatype, coordname);
+    for (std::size_t A = 1; A <= arrays.size(); ++A) {
+      auto [coordname, datatype] = arrays[A - 1];
 
-      spdlog::debug(
+      CGNS_TOOLS_DEBUG(indent(10, "C : {}", A));
+      CGNS_TOOLS_DEBUG(
           indent(10, "datatype : {}",
                  datatype == RealSingle ? "RealSingle" : "RealDouble"));
-      spdlog::debug(indent(10, "coordname : {}", coordname));
+      CGNS_TOOLS_DEBUG(indent(10, "coordname : {}", coordname));
+
+      auto read = [B, Z, G, A, length](const fileIn &f, auto *ptr) {
+        using T = std::remove_pointer_t<decltype(ptr)>;
+        const DataType_t mem_datatype =
+            std::is_same_v<T, float> ? RealSingle : RealDouble;
+
+        f.readGridArray(B, Z, G, static_cast<int>(A), mem_datatype, length,
+                        ptr);
+      };
+
+      if (G == 1 && datatype == RealSingle) {
+        data.emplace_back(this->readCoordinateArray<float>(
+            B, Z, std::move(coordname), nVertex));
+      } else if (G == 1) {
+        data.emplace_back(this->readCoordinateArray<double>(
+            B, Z, std::move(coordname), nVertex));
+      } else if (datatype == RealSingle) {
+        data.emplace_back(
+            this->readArray<float>(std::move(coordname), length, read));
+      } else {
+        data.emplace_back(
+            this->readArray<double>(std::move(coordname), length, read));
+      }
+    }
+
+    gridCoords.emplace_back(GridCoordName, std::move(data));
+  }
 
-      // read all vertices
-      cgsize_t range_min[3] = {1, 1, 1};
-      cgsize_t range_max[3] = {1, 1, 1};
+  return gridCoords;
+}
 
-      size_t length = 1;
-      for (size_t i = 0; i < nVertex.size(); ++i) {
-        range_max[i] = nVertex[i];
-        length *= nVertex[i];
-      }
+template <typename T>
+dataArray<T>
+fileIn::readCoordinateArray(const int B, const int Z, std::string &&coordname,
+                            const std::vector<cgsize_t> &nVertex) const {
+  // read all vertices
+  std::vector<cgsize_t> range_min(nVertex.size(), 1);
+  std::vector<cgsize_t> range_max(nVertex);
+
+  const std::size_t length = checkedProduct(nVertex);
+
+  auto read = [B, Z, coordname, range_min = std::move(range_min),
+               range_max = std::move(range_max)](const fileIn &f, T *ptr) {
+    const DataType_t mem_datatype =
+        std::is_same_v<T, float> ? RealSingle : RealDouble;
+
+    f.readCoordinates(B, Z, coordname, mem_datatype, range_min.data(),
+                      range_max.data(), ptr);
+  };
+
+  return this->readArray<T>(std::move(coordname), length, std::move(read));
+}
+
+template <typename T>
+dataArray<T>
+fileIn::readFieldArray(const int B, const int Z, const int S,
+                       std::string &&fieldname,
+                       const std::vector<cgsize_t> &dims) const {
+  std::vector<cgsize_t> range_min(dims.size(), 1);
+
+  const std::size_t length = checkedProduct(dims);
+
+  auto read = [B, Z, S, fieldname, range_min = std::move(range_min),
+               range_max = dims](const fileIn &f, T *ptr) {
+    const DataType_t mem_datatype =
+        std::is_same_v<T, float> ? RealSingle : RealDouble;
+
+    f.readField(B, Z, S, fieldname, mem_datatype, range_min.data(),
+                range_max.data(), ptr);
+  };
+
+  return this->readArray<T>(std::move(fieldname), length, std::move(read));
+}
+
+template <typename T, typename Read>
+dataArray<T> fileIn::readArray(std::string &&name, const std::size_t length,
+                               Read &&read) const {
+  if (_options.lazy) {
+    typename dataArray<T>::loader load =
+        [self = this->shared(), read = std::forward<Read>(read),
+         name](T *ptr) {
+          CGNS_TOOLS_DEBUG("Loading data array {}", name);
+          read(*self, ptr);
+        };
+
+    return {std::move(name), length, std::move(load),
+            arenaAllocator<T>{_options.memory}};
+  }
+
+  buffer<T> field(length, arenaAllocator<T>{_options.memory});
+  read(*this, field.data());
+
+  return {std::move(name), std::move(field)};
+}
+
+std::shared_ptr<const fileIn> fileIn::shared() const {
+  auto self = this->weak_from_this().lock();
+  if (!self) {
+    CGNS_TOOLS_ERROR("Lazy parsing requires a fileIn owned by a shared_ptr.");
+    exit(EXIT_FAILURE);
+  }
+  return self;
+}
+
+std::vector<cgsize_t> fileIn::readZoneVertexSize(const int B,
+                                                 const int Z) const {
+  int index_dim = 0;
+  cgnsFn<cg_index_dim>(_handle, B, Z, &index_dim);
+
+  char zonename[33];
+  cgsize_t size[9];
+  cgnsFn<cg_zone_read>(_handle, B, Z, zonename, &size[0]);
+
+  // vertex sizes are the first index_dim entries for both zone types
+  return std::vector<cgsize_t>(&size[0], &size[index_dim]);
+}
+
+std::string fileIn::readZoneName(const int B, const int Z) const {
+  char zonename[33] = "";
+  cgsize_t size[9];
+  cgnsFn<cg_zone_read>(_handle, B, Z, zonename, &size[0]);
+  return zonename;
+}
+
+ZoneType_t fileIn::readZoneType(const int B, const int Z) const {
+  ZoneType_t zonetype = ZoneTypeNull;
+  cgnsFn<cg_zone_type>(_handle, B, Z, &zonetype);
+  return zonetype;
+}
+
+std::vector<cgsize_t> fileIn::readZoneSize(const int B, const int Z) const {
+  int index_dim = 0;
+  cgnsFn<cg_index_dim>(_handle, B, Z, &index_dim);
+
+  char zonename[33];
+  cgsize_t size[9];
+  cgnsFn<cg_zone_read>(_handle, B, Z, zonename, &size[0]);
+
+  return std::vector<cgsize_t>(&size[0], &size[3 * index_dim]);
+}
+
+std::vector<std::string> fileIn::readCoordinateNames(const int B,
+                                                     const int Z) const {
+  std::vector<std::string> names{};
+  for (auto &[name, datatype] : this->readCoordinateInfo(B, Z)) {
+    names.emplace_back(std::move(name));
+  }
+  return names;
+}
+
+std::vector<std::pair<std::string, DataType_t>>
+fileIn::readCoordinateInfo(const int B, const int Z) const {
+  int ncoords = 0;
+  cgnsFn<cg_ncoords>(_handle, B, Z, &ncoords);
+
+  std::vector<std::pair<std::string, DataType_t>> coords{};
+  coords.reserve(ncoords);
 
-      DataType_t mem_datatype = datatype;
+  for (int C = 1; C <= ncoords; ++C) {
+    DataType_t datatype;
+    char coordname[33] = "";
+    cgnsFn<cg_coord_info>(_handle, B, Z, C, &datatype, coordname);
 
-      void *coord_ptr = nullptr;
+    coords.emplace_back(coordname, datatype);
+  }
+
+  return coords;
+}
+
+void fileIn::readCoordinates(const int B, const int Z,
+                             const std::string &coordname,
+                             const DataType_t memType,
+                             const cgsize_t *rangeMin, const cgsize_t *rangeMax,
+                             void *data) const {
+  cgnsFn<cg_coord_read>(_handle, B, Z, coordname.c_str(), memType, rangeMin,
+                        rangeMax, data);
+
+  int index_dim = 0;
+  cgnsFn<cg_index_dim>(_handle, B, Z, &index_dim);
+
+  std::uint64_t length = 1;
+  for (int i = 0; i < index_dim; ++i) {
+    length *= rangeMax[i] - rangeMin[i] + 1;
+  }
+
+  _bytesRead += length * (memType == RealSingle ? 4 : 8);
+}
+
+int fileIn::nGrids(const int B, const int Z) const {
+  int ngrids = 0;
+  cgnsFn<cg_ngrids>(_handle, B, Z, &ngrids);
+  return ngrids;
+}
+
+std::string fileIn::readGridName(const int B, const int Z, const int G) const {
+  char GridCoordName[33] = "";
+  cgnsFn<cg_grid_read>(_handle, B, Z, G, GridCoordName);
+  return GridCoordName;
+}
+
+std::vector<std::pair<std::string, DataType_t>>
+fileIn::readGridArrayInfo(const int B, const int Z, const int G) const {
+  std::vector<std::pair<std::string, DataType_t>> arrays{};
+
+  // cg_goto sets a global position, the sequence must not be interleaved
+  const std::scoped_lock lock{cgnsMutex()};
+
+  cgnsFn<cg_goto>(_handle, B, "Zone_t", Z, "GridCoordinates_t", G, "end");
+
+  int narrays = 0;
+  cgnsFn<cg_narrays>(&narrays);
+
+  arrays.reserve(narrays);
+
+  for (int A = 1; A <= narrays; ++A) {
+    char name[33] = "";
+    DataType_t datatype = DataTypeNull;
+    int data_dim = 0;
+    cgsize_t dims[3] = {};
+    cgnsFn<cg_array_info>(A, name, &datatype, &data_dim, &dims[0]);
+
+    arrays.emplace_back(name, datatype);
+  }
+
+  return arrays;
+}
+
+void fileIn::readGridArray(const int B, const int Z, const int G, const int A,
+                           const DataType_t memType, const std::size_t length,
+                           void *data) const {
+  const std::scoped_lock lock{cgnsMutex()};
+
+  cgnsFn<cg_goto>(_handle, B, "Zone_t", Z, "GridCoordinates_t", G, "end");
+
+  char name[33] = "";
+  DataType_t datatype = DataTypeNull;
+  int data_dim = 0;
+  cgsize_t dims[3] = {};
+  cgnsFn<cg_array_info>(A, name, &datatype, &data_dim, &dims[0]);
+
+  // cg_array_read_as writes the whole stored array
+  const auto stored = static_cast<std::size_t>(
+      checkedProduct(std::vector<cgsize_t>(&dims[0], &dims[data_dim])));
+  if (stored != length) {
+    CGNS_TOOLS_ERROR("{} of Grid {} of Zone {} Block {} has {} values, the "
+                     "zone {} vertices.",
+                     name, G, Z, B, stored, length);
+    exit(EXIT_FAILURE);
+  }
+
+  cgnsFn<cg_array_read_as>(A, memType, data);
+
+  _bytesRead += length * (memType == RealSingle ? 4 : 8);
+}
+
+int fileIn::nSolutions(const int B, const int Z) const {
+  int nsols = 0;
+  cgnsFn<cg_nsols>(_handle, B, Z, &nsols);
+  return nsols;
+}
+
+std::pair<std::string, GridLocation_t>
+fileIn::readSolutionInfo(const int B, const int Z, const int S) const {
+  char solname[33] = "";
+  GridLocation_t location = GridLocationNull;
+  cgnsFn<cg_sol_info>(_handle, B, Z, S, solname, &location);
+  return {solname, location};
+}
+
+std::vector<std::pair<std::string, DataType_t>>
+fileIn::readFieldInfo(const int B, const int Z, const int S) const {
+  int nfields = 0;
+  cgnsFn<cg_nfields>(_handle, B, Z, S, &nfields);
+
+  std::vector<std::pair<std::string, DataType_t>> fields{};
+  fields.reserve(nfields);
+
+  for (int F = 1; F <= nfields; ++F) {
+    DataType_t datatype;
+    char fieldname[33] = "";
+    cgnsFn<cg_field_info>(_handle, B, Z, S, F, &datatype, fieldname);
+
+    fields.emplace_back(fieldname, datatype);
+  }
+
+  return fields;
+}
+
+int fileIn::nSections(const int B, const int Z) const {
+  int nsections = 0;
+  cgnsFn<cg_nsections>(_handle, B, Z, &nsections);
+  return nsections;
+}
+
+elementSection fileIn::readSectionHeader(const int B, const int Z,
+                                         const int S) const {
+  char sectionname[33] = "";
+  ElementType_t type = ElementTypeNull;
+  cgsize_t start = 0;
+  cgsize_t end = 0;
+  int nbndry = 0;
+  int parent_flag = 0;
+  cgnsFn<cg_section_read>(_handle, B, Z, S, sectionname, &type, &start, &end,
+                          &nbndry, &parent_flag);
+
+  elementSection section{sectionname, type, start, end,
+                         std::vector<cgsize_t>{}};
+  section.nBoundary = nbndry;
+
+  return section;
+}
+
+std::vector<elementSection> fileIn::readElementSections(const int B,
+                                                        const int Z) const {
+  std::vector<elementSection> sections{};
+
+  const int nsections = this->nSections(B, Z);
+
+  CGNS_TOOLS_INFO(indent(6, "Reading Sections of Zone {} of Base {}", Z, B));
+  CGNS_TOOLS_DEBUG(indent(6, "nsections : {}", nsections));
+
+  sections.reserve(nsections);
+
+  for (int S = 1; S <= nsections; ++S) {
+    auto section = this->readSectionHeader(B, Z, S);
+
+    CGNS_TOOLS_DEBUG(indent(8, "S : {}", S));
+    CGNS_TOOLS_DEBUG(indent(8, "SectionName : {}", section.name));
+    CGNS_TOOLS_DEBUG(indent(8, "ElementType : {}",
+                            cg_ElementTypeName(section.type)));
+    CGNS_TOOLS_DEBUG(
+        indent(8, "range : [{}, {}]", section.start, section.end));
+
+    if (!_options.sections) {
+      // headers only
+    } else if (_options.lazy) {
+      section.connectivity = storedConnectivity{
+          this->shared(), B, Z, S, section.start,
+          this->readElementDataSize(B, Z, S)};
+    } else {
+      std::vector<cgsize_t> conn{};
+      this->readElements(B, Z, S, section.start, section.end, conn,
+                         section.offsets);
+      section.connectivity = std::move(conn);
+    }
 
-      if (mem_datatype == RealSingle) {
-        auto field = std::vector<float>(length);
-        coord_ptr = field.data();
-        data.emplace_back(dataArray<float>{coordname, std::move(field)});
+    sections.emplace_back(std::move(section));
+  }
+
+  return sections;
+}
+
+cgsize_t fileIn::readElementDataSize(const int B, const int Z,
+                                     const int S) const {
+  cgsize_t dataSize = 0;
+  cgnsFn<cg_ElementDataSize>(_handle, B, Z, S, &dataSize);
+  return dataSize;
+}
+
+cgsize_t fileIn::sectionChunkElements(const int B, const int Z, const int S,
+                                      const std::size_t chunkBytes) const {
+  const auto section = this->readSectionHeader(B, Z, S);
+  const cgsize_t nElements = section.nElements();
+
+  // connectivity and offset entries of the whole section
+  cgsize_t entries = this->readElementDataSize(B, Z, S);
+  if (hasStartOffset(section.type)) {
+    entries += nElements + 1;
+  }
+
+  const cgsize_t budget =
+      static_cast<cgsize_t>(chunkBytes / sizeof(cgsize_t));
+
+  if (entries <= budget) {
+    return nElements;
+  }
+
+  return std::max<cgsize_t>(1, budget * nElements / entries);
+}
+
+void fileIn::readElements(const int B, const int Z, const int S,
+                          const cgsize_t first, const cgsize_t last,
+                          std::vector<cgsize_t> &conn,
+                          std::vector<cgsize_t> &offsets) const {
+  char sectionname[33] = "";
+  ElementType_t type = ElementTypeNull;
+  cgsize_t start = 0;
+  cgsize_t end = 0;
+  int nbndry = 0;
+  int parent_flag = 0;
+  cgnsFn<cg_section_read>(_handle, B, Z, S, sectionname, &type, &start, &end,
+                          &nbndry, &parent_flag);
+
+  if (first < start || last > end || first > last) {
+    CGNS_TOOLS_ERROR("Element range [{}, {}] outside of Section {} [{}, {}].",
+                     first, last, sectionname, start, end);
+    exit(EXIT_FAILURE);
+  }
+
+  cgsize_t dataSize = 0;
+  cgnsFn<cg_ElementPartialSize>(_handle, B, Z, S, first, last, &dataSize);
+
+  conn.resize(static_cast<std::size_t>(dataSize));
+
+  if (hasStartOffset(type)) {
+    offsets.resize(static_cast<std::size_t>(last - first + 2));
+    cgnsFn<cg_poly_elements_partial_read>(_handle, B, Z, S, first, last,
+                                          conn.data(), offsets.data(),
+                                          nullptr);
+
+    // the offsets of a partial read are relative to the chunk
+    const cgsize_t base = offsets.front();
+    for (auto &offset : offsets) {
+      offset -= base;
+    }
+  } else {
+    offsets.clear();
+    cgnsFn<cg_elements_partial_read>(_handle, B, Z, S, first, last,
+                                     conn.data(), nullptr);
+  }
+
+  _bytesRead += (conn.size() + offsets.size()) * sizeof(cgsize_t);
+}
+
+cgsize_t storedConnectivity::chunkElements(const std::size_t chunkBytes) const {
+  return file->sectionChunkElements(B, Z, S, chunkBytes);
+}
+
+void storedConnectivity::read(const cgsize_t first, const cgsize_t last,
+                              std::vector<cgsize_t> &conn,
+                              std::vector<cgsize_t> &offsets) const {
+  file->readElements(B, Z, S, start + first - 1, start + last - 1, conn,
+                     offsets);
+}
+
+std::vector<flowSolution> fileIn::readFlowSolutions(const int B,
+                                                    const int Z) const {
+  std::vector<flowSolution> solutions{};
+
+  int nsols = 0;
+  cgnsFn<cg_nsols>(_handle, B, Z, &nsols);
+
+  CGNS_TOOLS_DEBUG(indent(6, "nsols : {}", nsols));
+
+  solutions.reserve(nsols);
+
+  for (int S = 1; S <= nsols; ++S) {
+    CGNS_TOOLS_INFO(
+        indent(6, "Reading Flow Solution {} of Zone {} of Base {}", S, Z, B));
+
+    char solname[33] = "";
+    GridLocation_t location = GridLocationNull;
+    cgnsFn<cg_sol_info>(_handle, B, Z, S, solname, &location);
+
+    int data_dim = 0;
+    cgsize_t dim_vals[3] = {};
+    cgnsFn<cg_sol_size>(_handle, B, Z, S, &data_dim, &dim_vals[0]);
+
+    const std::vector<cgsize_t> dims(&dim_vals[0], &dim_vals[data_dim]);
+
+    CGNS_TOOLS_DEBUG(indent(8, "S : {}", S));
+    CGNS_TOOLS_DEBUG(indent(8, "SolutionName : {}", solname));
+    CGNS_TOOLS_DEBUG(
+        indent(8, "GridLocation : {}", cg_GridLocationName(location)));
+    CGNS_TOOLS_DEBUG(indent(8, "size : [{}]", fmt::join(dims, " , ")));
+
+    int nfields = 0;
+    cgnsFn<cg_nfields>(_handle, B, Z, S, &nfields);
+
+    CGNS_TOOLS_DEBUG(indent(8, "nfields : {}", nfields));
+
+    std::vector<dataArrayV> fields{};
+
+    for (int F = 1; F <= nfields; ++F) {
+      DataType_t datatype;
+      char fieldname[33] = "";
+      cgnsFn<cg_field_info>(_handle, B, Z, S, F, &datatype, fieldname);
+
+      if (!this->selected(fieldname)) {
+        CGNS_TOOLS_DEBUG(indent(10, "{} : skipped", fieldname));
+        continue;
+      }
+
+      CGNS_TOOLS_DEBUG(
+          indent(10, "{} : {}", fieldname, cg_DataTypeName(datatype)));
+
+      if (datatype == RealSingle) {
+        fields.emplace_back(
+            this->readFieldArray<float>(B, Z, S, fieldname, dims));
+      } else if (datatype == RealDouble) {
+        fields.emplace_back(
+            this->readFieldArray<double>(B, Z, S, fieldname, dims));
       } else {
-        auto field = std::vector<double>(length);
-        coord_ptr = field.data();
-        data.emplace_back(dataArray<double>{coordname, std::move(field)});
+        CGNS_TOOLS_WARN("Field {} of Zone {} Block {} has unsupported data "
+                        "type {}. Skipped.",
+                        fieldname, Z, B, cg_DataTypeName(datatype));
       }
+    }
+
+    solutions.emplace_back(solname, location, std::move(fields));
+  }
+
+  return solutions;
+}
+
+bool fileIn::selected(const std::string &fieldname) const {
+  if (!_options.fields) {
+    return true;
+  }
+  const auto &fields = *_options.fields;
+  return std::find(fields.begin(), fields.end(), fieldname) != fields.end();
+}
 
-      cgnsFn<cg_coord_read>(_handle, B, Z, coordname, mem_datatype, range_min,
-                            range_max, coord_ptr);
+void fileIn::readField(const int B, const int Z, const int S,
+                       const std::string &fieldname, const DataType_t memType,
+                       const cgsize_t *rangeMin, const cgsize_t *rangeMax,
+                       void *data) const {
+  cgnsFn<cg_field_read>(_handle, B, Z, S, fieldname.c_str(), memType, rangeMin,
+                        rangeMax, data);
+
+  int index_dim = 0;
+  cgnsFn<cg_index_dim>(_handle, B, Z, &index_dim);
+
+  std::uint64_t length = 1;
+  for (int i = 0; i < index_dim; ++i) {
+    length *= rangeMax[i] - rangeMin[i] + 1;
+  }
+
+  _bytesRead += length * (memType == RealSingle ? 4 : 8);
+}
+
+std::optional<std::string> fileIn::readZoneFamilyName(const int B,
+                                                      const int Z) const {
+  const std::scoped_lock lock{cgnsMutex()};
+  cgnsFn<cg_goto>(_handle, B, "Zone_t", Z, "end");
+
+  // FamilyName is optional
+  char famname[33] = "";
+  if (const int ier = cg_famname_read(famname); ier == CG_OK) {
+    CGNS_TOOLS_DEBUG(indent(6, "FamilyName : {}", famname));
+    return famname;
+  } else if (ier != CG_NODE_NOT_FOUND) {
+    cg_error_exit();
+  }
+  return std::nullopt;
+}
+
+std::vector<connectivity1to1>
+fileIn::readConnectivity1to1(const int B, const int Z) const {
+  std::vector<connectivity1to1> connectivities{};
+
+  int index_dim = 0;
+  cgnsFn<cg_index_dim>(_handle, B, Z, &index_dim);
+
+  int n1to1 = 0;
+  cgnsFn<cg_n1to1>(_handle, B, Z, &n1to1);
+
+  CGNS_TOOLS_DEBUG(indent(6, "n1to1 : {}", n1to1));
+
+  connectivities.reserve(n1to1);
+
+  for (int I = 1; I <= n1to1; ++I) {
+    char connectname[33] = "";
+    char donorname[33] = "";
+    std::vector<cgsize_t> range(2 * index_dim);
+    std::vector<cgsize_t> donorRange(2 * index_dim);
+    std::vector<int> transform(index_dim);
+    cgnsFn<cg_1to1_read>(_handle, B, Z, I, connectname, donorname,
+                         range.data(), donorRange.data(), transform.data());
+
+    CGNS_TOOLS_DEBUG(indent(8, "I : {}", I));
+    CGNS_TOOLS_DEBUG(indent(8, "connectname : {}", connectname));
+    CGNS_TOOLS_DEBUG(indent(8, "donorname : {}", donorname));
+    CGNS_TOOLS_DEBUG(indent(8, "range : [{}]", fmt::join(range, " , ")));
+    CGNS_TOOLS_DEBUG(
+        indent(8, "donor_range : [{}]", fmt::join(donorRange, " , ")));
+    CGNS_TOOLS_DEBUG(
+        indent(8, "transform : [{}]", fmt::join(transform, " , ")));
+
+    connectivities.emplace_back(connectname, donorname, std::move(range),
+                                std::move(donorRange), std::move(transform));
+  }
+
+  return connectivities;
+}
+
+std::vector<boundaryCondition>
+fileIn::readBoundaryConditions(const int B, const int Z) const {
+  std::vector<boundaryCondition> bcs{};
+
+  int index_dim = 0;
+  cgnsFn<cg_index_dim>(_handle, B, Z, &index_dim);
+
+  int nbocos = 0;
+  cgnsFn<cg_nbocos>(_handle, B, Z, &nbocos);
+
+  CGNS_TOOLS_DEBUG(indent(6, "nbocos : {}", nbocos));
+
+  bcs.reserve(nbocos);
+
+  for (int BC = 1; BC <= nbocos; ++BC) {
+    char boconame[33] = "";
+    BCType_t bocotype = BCTypeNull;
+    PointSetType_t ptset_type = PointSetTypeNull;
+    cgsize_t npnts = 0;
+    int NormalIndex[3] = {};
+    cgsize_t NormalListSize = 0;
+    DataType_t NormalDataType = DataTypeNull;
+    int ndataset = 0;
+    cgnsFn<cg_boco_info>(_handle, B, Z, BC, boconame, &bocotype, &ptset_type,
+                         &npnts, &NormalIndex[0], &NormalListSize,
+                         &NormalDataType, &ndataset);
+
+    std::vector<cgsize_t> points(static_cast<std::size_t>(npnts) * index_dim);
+    cgnsFn<cg_boco_read>(_handle, B, Z, BC, points.data(), nullptr);
+
+    GridLocation_t location = Vertex;
+    cgnsFn<cg_boco_gridlocation_read>(_handle, B, Z, BC, &location);
+
+    CGNS_TOOLS_DEBUG(indent(8, "BC : {}", BC));
+    CGNS_TOOLS_DEBUG(indent(8, "BCName : {}", boconame));
+    CGNS_TOOLS_DEBUG(indent(8, "BCType : {}", to_string(bocotype)));
+    CGNS_TOOLS_DEBUG(indent(8, "PointSetType : {}",
+                            cg_PointSetTypeName(ptset_type)));
+    CGNS_TOOLS_DEBUG(indent(8, "GridLocation : {}",
+                            cg_GridLocationName(location)));
+    CGNS_TOOLS_DEBUG(indent(8, "npnts : {}", npnts));
+
+    boundaryCondition bc{boconame, bocotype, ptset_type, location,
+                         std::move(points)};
+
+    {
+      const std::scoped_lock lock{cgnsMutex()};
+      cgnsFn<cg_goto>(_handle, B, "Zone_t", Z, "ZoneBC_t", 1, "BC_t", BC,
+                      "end");
+
+      // FamilyName is optional
+      char famname[33] = "";
+      if (const int ier = cg_famname_read(famname); ier == CG_OK) {
+        bc.familyName = famname;
+        CGNS_TOOLS_DEBUG(indent(8, "FamilyName : {}", famname));
+      } else if (ier != CG_NODE_NOT_FOUND) {
+        cg_error_exit();
+      }
     }
 
-    gridCoords.emplace_back(GridCoordName, std::move(data));
+    bcs.emplace_back(std::move(bc));
   }
 
-  return gridCoords;
+  return bcs;
 }
 
 std::vector<family> fileIn::readFamilyDefinition(const int B) const {
@@ -512,7 +1784,7 @@ std::vector<family> fileIn::readFamilyDefinition(const int B) const {
 
   families.reserve(nfamilies);
 
-  spdlog::debug(indent(4, "nfamilies : {}", nfamilies));
+  CGNS_TOOLS_DEBUG(indent(4, "nfamilies : {}", nfamilies));
 
   for (int Fam = 1; Fam <= nfamilies; ++Fam) {
     char FamilyName[33] = "";
@@ -521,21 +1793,21 @@ std::vector<family> fileIn::readFamilyDefinition(const int B) const {
 
     cgnsFn<cg_family_read>(_handle, B, Fam, FamilyName, &nFamBC, &nGeo);
 
-    spdlog::debug(indent(6, "Fam : {}", Fam));
-    spdlog::debug(indent(6, "FamilyName : {}", FamilyName));
-    spdlog::debug(indent(6, "nFamBC : {}", nFamBC));
-    spdlog::debug(indent(6, "nGeo : {}", nGeo));
+    CGNS_TOOLS_DEBUG(indent(6, "Fam : {}", Fam));
+    CGNS_TOOLS_DEBUG(indent(6, "FamilyName : {}", FamilyName));
+    CGNS_TOOLS_DEBUG(indent(6, "nFamBC : {}", nFamBC));
+    CGNS_TOOLS_DEBUG(indent(6, "nGeo : {}", nGeo));
 
     std::optional<familyBC> bc{};
     if (nFamBC == 1) {
       bc = this->readFamilyBoundaryCondition(B, Fam);
     } else if (nFamBC != 0) {
-      spdlog::error("nFamBC = {} encountered. Must be 0 or 1.", nFamBC);
+      CGNS_TOOLS_ERROR("nFamBC = {} encountered. Must be 0 or 1.", nFamBC);
       exit(EXIT_FAILURE);
     }
 
     if (nGeo != 0) {
-      spdlog::warn("nGeo != 0 ( {} ). Not yet supported", nGeo);
+      CGNS_TOOLS_WARN("nGeo != 0 ( {} ). Not yet supported", nGeo);
     }
 
     families.emplace_back(FamilyName, std::move(bc));
@@ -550,8 +1822,8 @@ familyBC fileIn::readFamilyBoundaryCondition(const int B, const int Fam) const {
   BCType_t BCType = BCTypeNull;
   cgnsFn<cg_fambc_read>(_handle, B, Fam, BC, FamBCName, &BCType);
 
-  spdlog::debug(indent(6, "FamBCName : {}", FamBCName));
-  spdlog::debug(indent(6, "BCType : {}", to_string(BCType)));
+  CGNS_TOOLS_DEBUG(indent(6, "FamBCName : {}", FamBCName));
+  CGNS_TOOLS_DEBUG(indent(6, "BCType : {}", to_string(BCType)));
 
   return {FamBCName, BCType};
 }
@@ -561,7 +1833,8 @@ std::ostream &operator<<(std::ostream &out, const dataArray<float> &data) {
   out << "DataArray :\n"
       << "  Name : " << data.name << "\n"
       << "  DataType : float\n"
-      << "  Size : " << data.data.size() << std::endl;
+      << "  Size : " << data.size() << "\n"
+      << "  Loaded : " << (data.loaded() ? "yes" : "no") << std::endl;
 
   return out;
 }
@@ -571,7 +1844,8 @@ std::ostream &operator<<(std::ostream &out, const dataArray<double> &data) {
   out << "DataArray :\n"
       << "  Name : " << data.name << "\n"
       << "  DataType : double\n"
-      << "  Size : " << data.data.size() << std::endl;
+      << "  Size : " << data.size() << "\n"
+      << "  Loaded : " << (data.loaded() ? "yes" : "no") << std::endl;
 
   return out;
 }
@@ -604,7 +1878,8 @@ std::ostream &operator<<(std::ostream &out, const zoneStructured &zone) {
     out << " " << i;
   }
   out << "]\n"
-      << "  nGridCoordinates : " << zone.gridCoordinates.size() << std::endl;
+      << "  nGridCoordinates : " << zone.gridCoordinates.size() << "\n"
+      << "  nFlowSolutions : " << zone.flowSolutions.size() << std::endl;
 
   return out;
 }
@@ -616,7 +1891,52 @@ std::ostream &operator<<(std::ostream &out, const zoneUnstructured &zone) {
       << "  VertexSize : " << zone.nVertex << "\n"
       << "  CellSize : " << zone.nCell << "\n"
       << "  VertexSizeBoundary : " << zone.nBoundVertex << "\n"
-      << "  nGridCoordinates : " << zone.gridCoordinates.size() << std::endl;
+      << "  nGridCoordinates : " << zone.gridCoordinates.size() << "\n"
+      << "  nFlowSolutions : " << zone.flowSolutions.size() << "\n"
+      << "  nSections : " << zone.sections.size() << std::endl;
+  return out;
+}
+
+std::ostream &operator<<(std::ostream &out, const flowSolution &solution) {
+  out << "FlowSolution :\n"
+      << "  Name : " << solution.name << "\n"
+      << "  GridLocation : " << cg_GridLocationName(solution.location) << "\n"
+      << "  nFields : " << solution.fields.size() << std::endl;
+  return out;
+}
+
+std::ostream &operator<<(std::ostream &out, const connectivity1to1 &conn) {
+  out << "GridConnectivity1to1 :\n"
+      << "  Name : " << conn.name << "\n"
+      << "  DonorName : " << conn.donorName << "\n"
+      << "  Transform :";
+  for (const auto t : conn.transform) {
+    out << " " << t;
+  }
+  out << std::endl;
+  return out;
+}
+
+std::ostream &operator<<(std::ostream &out, const boundaryCondition &bc) {
+  out << "BC :\n"
+      << "  Name : " << bc.name << "\n"
+      << "  BCType : " << to_string(bc.type) << "\n"
+      << "  PointSetType : " << cg_PointSetTypeName(bc.pointSet) << "\n"
+      << "  GridLocation : " << cg_GridLocationName(bc.location) << "\n"
+      << "  FamilyName : " << bc.familyName.value_or("") << std::endl;
+  return out;
+}
+
+bool hasStartOffset(const ElementType_t type) {
+  return type == MIXED || type == NGON_n || type == NFACE_n;
+}
+
+std::ostream &operator<<(std::ostream &out, const elementSection &section) {
+  out << "Elements :\n"
+      << "  Name : " << section.name << "\n"
+      << "  ElementType : " << cg_ElementTypeName(section.type) << "\n"
+      << "  ElementRange : [" << section.start << ", " << section.end << "]"
+      << std::endl;
   return out;
 }
 
@@ -629,20 +1949,61 @@ std::ostream &operator<<(std::ostream &out, const base &base) {
   return out;
 }
 
-root parse(const std::string &path) {
-  fileIn f{path};
+root parse(const std::string &path, const parseOptions &options) {
+  const auto start = std::chrono::steady_clock::now();
+
+  // shared ownership, lazy arrays keep the file open
+  const auto f = std::make_shared<fileIn>(path, options);
 
   /// @todo parse Simulation Type (SimulationType_t)
   /// @todo parse Grid Location (GridLocation_t)
   /// @todo parse Point Sets (IndexArray_t, IndexRange_t)
   /// @todo parse Rind Layers (Rind_t)
 
-  return {f.readBaseInformation()};
+  root r{f->readBaseInformation()};
+
+  const std::chrono::duration<double, std::milli> time =
+      std::chrono::steady_clock::now() - start;
+
+  CGNS_TOOLS_INFO("Parsed {} in {:.3f} ms ({} bytes of bulk data read{})",
+                  path, time.count(), f->bytesRead(),
+                  options.lazy ? ", lazy" : "");
+
+  return r;
 }
 
-void writeFile(const std::string &path, root r) {
-  fileOut f{path};
+void writeFile(const std::string &path, const root &r,
+               const writeOptions &options) {
+  fileOut f{path, options};
   f.writeBaseInformation(r);
 }
 
+void writeFile(const std::string &path, root &&r,
+               const writeOptions &options) {
+  fileOut f{path, options};
+
+  for (auto &base : r.bases) {
+    const int B = f.writeBaseHeader(base);
+
+    for (auto &zone : base.zones) {
+      f.writeZoneInformation(B, zone);
+
+      // the arrays loaded while writing the zone are not accessed again
+      std::visit(
+          [](auto &z) {
+            std::vector<gridCoordinatesT>{}.swap(z.gridCoordinates);
+            std::vector<flowSolution>{}.swap(z.flowSolutions);
+          },
+          zone);
+      if (auto *z = std::get_if<zoneUnstructured>(&zone)) {
+        std::vector<elementSection>{}.swap(z->sections);
+      }
+    }
+
+    for (const auto &family : base.families) {
+      f.writeFamilyDefinition(B, family);
+    }
+  }
+}
+
 } // namespace cgns_tools
@@ -0,0 +1,349 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "../include/convert.hpp"
+
+#include <cgnslib.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "../include/logger.hpp"
+#include "spdlog/spdlog.h"
+
+namespace cgns_tools {
+
+ElementType_t structuredConnectivity::elementType() const {
+  switch (nVertex.size()) {
+  case 2:
+    return QUAD_4;
+  case 3:
+    return HEXA_8;
+  default:
+    CGNS_TOOLS_ERROR("Unexpected index_dim ({}) encountered.", nVertex.size());
+    exit(EXIT_FAILURE);
+  }
+}
+
+unsigned structuredConnectivity::nodesPerElement() const {
+  return nVertex.size() == 2 ? 4 : 8;
+}
+
+cgsize_t structuredConnectivity::nElements() const {
+  std::vector<cgsize_t> nCell{};
+  for (const auto i : nVertex) {
+    nCell.push_back(i - 1);
+  }
+  return checkedProduct(nCell);
+}
+
+cgsize_t structuredConnectivity::chunkElements() const {
+  const cgsize_t nLine = nVertex[0] - 1;
+  const cgsize_t nPlane = nLine * (nVertex[1] - 1);
+
+  const cgsize_t nMax = std::max<cgsize_t>(
+      1, chunkBytes / (nodesPerElement() * sizeof(cgsize_t)));
+
+  if (nMax >= nPlane) {
+    return nMax / nPlane * nPlane;
+  } else if (nMax >= nLine) {
+    return nMax / nLine * nLine;
+  }
+  return nMax;
+}
+
+void structuredConnectivity::fill(const cgsize_t first, const cgsize_t last,
+                                  cgsize_t *conn) const {
+  const unsigned npe = nodesPerElement();
+
+  // vertex strides
+  const cgsize_t sj = nVertex[0];
+  const cgsize_t sk = nVertex.size() == 3 ? sj * nVertex[1] : 0;
+
+  // cell counts
+  const cgsize_t nci = nVertex[0] - 1;
+  const cgsize_t ncj = nVertex[1] - 1;
+
+  parallelForBlocks(
+      static_cast<std::size_t>(first), static_cast<std::size_t>(last) + 1,
+      [&](const std::size_t begin, const std::size_t end) {
+        // position of the first cell of the block, advanced incrementally
+        const cgsize_t c = static_cast<cgsize_t>(begin) - 1;
+        cgsize_t i = c % nci;
+        cgsize_t j = (c / nci) % ncj;
+        cgsize_t k = c / (nci * ncj);
+
+        cgsize_t *e = conn + (static_cast<cgsize_t>(begin) - first) * npe;
+
+        for (std::size_t n = begin; n < end; ++n, e += npe) {
+          const cgsize_t v = 1 + i + sj * j + sk * k;
+
+          e[0] = v;
+          e[1] = v + 1;
+          e[2] = v + 1 + sj;
+          e[3] = v + sj;
+
+          if (npe == 8) {
+            e[4] = v + sk;
+            e[5] = v + 1 + sk;
+            e[6] = v + 1 + sj + sk;
+            e[7] = v + sj + sk;
+          }
+
+          if (++i == nci) {
+            i = 0;
+            if (++j == ncj) {
+              j = 0;
+              ++k;
+            }
+          }
+        }
+      },
+      nThreads);
+}
+
+namespace {
+
+/// vertex range of a structured boundary patch lying in an index plane
+struct patch {
+  /// 0-based first and last vertex per direction, unused directions are 0
+  std::array<cgsize_t, 3> lo = {};
+  std::array<cgsize_t, 3> hi = {};
+
+  /// constant direction of the patch
+  unsigned d = 0;
+
+  /// first element of the patch relative to the boundary elements
+  cgsize_t offset = 0;
+
+  cgsize_t nElements = 0;
+};
+
+/// @brief vertex range of a PointRange BC in Vertex or face location, nullopt
+/// if the range does not span a face patch
+std::optional<patch> toPatch(const boundaryCondition &bc,
+                             const std::vector<cgsize_t> &nVertex) {
+  const unsigned dim = static_cast<unsigned>(nVertex.size());
+
+  if (bc.pointSet != PointRange || bc.points.size() != 2 * dim) {
+    return std::nullopt;
+  }
+
+  patch p{};
+  for (unsigned x = 0; x < dim; ++x) {
+    p.lo[x] = std::min(bc.points[x], bc.points[dim + x]) - 1;
+    p.hi[x] = std::max(bc.points[x], bc.points[dim + x]) - 1;
+  }
+
+  // constant direction, a face given in cell indices spans one vertex more
+  // in the remaining directions
+  bool cellIndexed = true;
+  switch (bc.location) {
+  case IFaceCenter:
+  case JFaceCenter:
+  case KFaceCenter:
+    p.d = static_cast<unsigned>(bc.location - IFaceCenter);
+    break;
+  case Vertex:
+    cellIndexed = false;
+    [[fallthrough]];
+  default: {
+    // prefer a direction on the zone boundary if the range is degenerate
+    unsigned n = 0;
+    for (unsigned x = dim; x-- > 0;) {
+      if (p.lo[x] == p.hi[x]) {
+        if (n == 0 || p.lo[x] == 0 || p.lo[x] == nVertex[x] - 1) {
+          p.d = x;
+        }
+        ++n;
+      }
+    }
+    if (n == 0) {
+      return std::nullopt;
+    }
+  }
+  }
+
+  if (p.d >= dim) {
+    return std::nullopt;
+  }
+
+  p.nElements = 1;
+  for (unsigned x = 0; x < dim; ++x) {
+    if (x != p.d) {
+      if (cellIndexed) {
+        ++p.hi[x];
+      }
+      p.nElements *= p.hi[x] - p.lo[x];
+    }
+  }
+
+  if (p.nElements == 0) {
+    return std::nullopt;
+  }
+  return p;
+}
+
+/// @brief fill the QUAD_4 (3d) or BAR_2 (2d) connectivity of a patch, the
+/// faces of a patch on the zone boundary point outwards
+void fillPatch(const patch &p, const std::vector<cgsize_t> &nVertex,
+               cgsize_t *conn) {
+  const std::array<cgsize_t, 3> s = {
+      1, nVertex[0], nVertex.size() == 3 ? nVertex[0] * nVertex[1] : 0};
+
+  const bool atMin = p.lo[p.d] == 0;
+
+  if (nVertex.size() == 2) {
+    const unsigned a = 1 - p.d;
+    const bool reverse = (p.d == 0) == atMin;
+
+    for (cgsize_t ia = p.lo[a]; ia < p.hi[a]; ++ia, conn += 2) {
+      const cgsize_t v = 1 + ia * s[a] + p.lo[p.d] * s[p.d];
+      conn[0] = reverse ? v + s[a] : v;
+      conn[1] = reverse ? v : v + s[a];
+    }
+    return;
+  }
+
+  // a, b, d form a right-handed system, the faces are oriented along +d
+  const unsigned a = (p.d + 1) % 3;
+  const unsigned b = (p.d + 2) % 3;
+
+  for (cgsize_t ib = p.lo[b]; ib < p.hi[b]; ++ib) {
+    for (cgsize_t ia = p.lo[a]; ia < p.hi[a]; ++ia, conn += 4) {
+      const cgsize_t v = 1 + ia * s[a] + ib * s[b] + p.lo[p.d] * s[p.d];
+      conn[0] = v;
+      conn[1] = atMin ? v + s[b] : v + s[a];
+      conn[2] = v + s[a] + s[b];
+      conn[3] = atMin ? v + s[a] : v + s[b];
+    }
+  }
+}
+
+/// @brief convert the PointRange BCs of a structured zone into boundary
+/// sections starting at element nCell + 1 and BCs referencing them
+void convertBoundaryConditions(const zoneStructured &zone, const cgsize_t nCell,
+                               const conversionOptions &options,
+                               std::vector<elementSection> &sections,
+                               std::vector<boundaryCondition> &bcs) {
+  const bool is3d = zone.nVertex.size() == 3;
+  const ElementType_t type = is3d ? QUAD_4 : BAR_2;
+  const cgsize_t npe = is3d ? 4 : 2;
+
+  // ranges are collected serially, the connectivity is filled in parallel
+  std::vector<patch> patches{};
+  std::vector<const boundaryCondition *> sources{};
+  cgsize_t nBoundary = 0;
+
+  for (const auto &bc : zone.boundaryConditions) {
+    auto p = toPatch(bc, zone.nVertex);
+    if (!p) {
+      CGNS_TOOLS_WARN("BC {} of Zone {} is not a face patch, skipped.",
+                      bc.name, zone.name);
+      continue;
+    }
+    p->offset = nBoundary;
+    nBoundary += p->nElements;
+    patches.emplace_back(*p);
+    sources.emplace_back(&bc);
+  }
+
+  CGNS_TOOLS_DEBUG(indent(6, "nPatches : {}", patches.size()));
+  CGNS_TOOLS_DEBUG(indent(6, "nBoundaryElements : {}", nBoundary));
+
+  sections.reserve(sections.size() + patches.size());
+  bcs.reserve(patches.size());
+
+  const std::size_t first = sections.size();
+
+  for (std::size_t n = 0; n < patches.size(); ++n) {
+    const auto &p = patches[n];
+    const auto &bc = *sources[n];
+    const cgsize_t start = nCell + 1 + p.offset;
+    const cgsize_t end = start + p.nElements - 1;
+
+    sections.emplace_back(std::string{bc.name}, type, start, end,
+                          std::vector<cgsize_t>{});
+
+    boundaryCondition converted{std::string{bc.name}, bc.type, PointRange,
+                                is3d ? FaceCenter : EdgeCenter,
+                                std::vector<cgsize_t>{start, end}};
+    converted.familyName = bc.familyName;
+    bcs.emplace_back(std::move(converted));
+  }
+
+  // patch sizes vary strongly, they are assigned dynamically
+  std::atomic<std::size_t> next = 0;
+
+  parallelForBlocks(
+      0, std::min<std::size_t>(options.nThreads, patches.size()),
+      [&](std::size_t, std::size_t) {
+        for (std::size_t n = next++; n < patches.size(); n = next++) {
+          auto &conn =
+              std::get<std::vector<cgsize_t>>(sections[first + n].connectivity);
+          conn.resize(static_cast<std::size_t>(patches[n].nElements * npe));
+          fillPatch(patches[n], zone.nVertex, conn.data());
+        }
+      },
+      options.nThreads);
+}
+
+} // namespace
+
+zoneUnstructured toUnstructured(zoneStructured &&zone,
+                                const conversionOptions &options) {
+  structuredConnectivity conn{zone.nVertex, options.chunkBytes,
+                              options.nThreads};
+
+  const cgsize_t nVertex = checkedProduct(zone.nVertex);
+
+  const ElementType_t type = conn.elementType();
+  const cgsize_t nCell = conn.nElements();
+
+  CGNS_TOOLS_INFO(indent(4, "Converting Zone {}", zone.name));
+  CGNS_TOOLS_DEBUG(indent(6, "nVertex : {}", nVertex));
+  CGNS_TOOLS_DEBUG(indent(6, "nCell : {}", nCell));
+
+  std::vector<elementSection> sections{};
+  sections.emplace_back(type == HEXA_8 ? "Hexa" : "Quad", type, 1, nCell,
+                        std::move(conn));
+
+  std::vector<boundaryCondition> bcs{};
+  if (options.boundarySections) {
+    convertBoundaryConditions(zone, nCell, options, sections, bcs);
+  }
+
+  zoneUnstructured converted{std::move(zone.name),
+                             nVertex,
+                             nCell,
+                             0,
+                             std::move(zone.gridCoordinates),
+                             std::move(sections)};
+
+  // vertex and cell ordering are kept, the solutions remain valid
+  converted.flowSolutions = std::move(zone.flowSolutions);
+  converted.boundaryConditions = std::move(bcs);
+  converted.familyName = std::move(zone.familyName);
+
+  return converted;
+}
+
+root toUnstructured(root &&r, const conversionOptions &options) {
+  for (auto &base : r.bases) {
+    for (auto &zone : base.zones) {
+      if (auto *z = std::get_if<zoneStructured>(&zone)) {
+        zone = toUnstructured(std::move(*z), options);
+      }
+    }
+  }
+  return std::move(r);
+}
+
+} // namespace cgns_tools
@@ -0,0 +1,352 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "../include/geometry.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "../include/logger.hpp"
+#include "../include/simd.hpp"
+#include "spdlog/spdlog.h"
+
+namespace cgns_tools {
+
+namespace {
+
+template <typename T> struct vec3 {
+  T x, y, z;
+};
+
+template <typename T> inline vec3<T> operator+(vec3<T> a, vec3<T> b) {
+  return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+template <typename T> inline vec3<T> operator-(vec3<T> a, vec3<T> b) {
+  return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+template <typename T> inline vec3<T> cross(vec3<T> a, vec3<T> b) {
+  return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z,
+          a.x * b.y - a.y * b.x};
+}
+
+template <typename T> inline T dot(vec3<T> a, vec3<T> b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+/// @brief area vector of the bilinear quad a, b, c, d, i.e. half the cross
+/// product of its diagonals
+template <typename T>
+inline vec3<T> areaVector(vec3<T> a, vec3<T> b, vec3<T> c, vec3<T> d) {
+  const vec3<T> s = cross(c - a, d - b);
+  const T half = T(0.5);
+  return {half * s.x, half * s.y, half * s.z};
+}
+
+/// flux of the position vector through the quad a, b, c, d
+template <typename T>
+inline T moment(vec3<T> a, vec3<T> b, vec3<T> c, vec3<T> d) {
+  return dot(a + b + c + d, cross(c - a, d - b)) * T(0.125);
+}
+
+/// @brief area vectors of n faces along i. The first face has the vertices
+/// x[0], x[b], x[c], x[d].
+template <typename T>
+CGNS_TOOLS_SIMD_CLONES void
+faceRow(const T *CGNS_TOOLS_RESTRICT x, const T *CGNS_TOOLS_RESTRICT y,
+        const T *CGNS_TOOLS_RESTRICT z, const std::size_t b,
+        const std::size_t c, const std::size_t d, const std::size_t n,
+        T *CGNS_TOOLS_RESTRICT sx, T *CGNS_TOOLS_RESTRICT sy,
+        T *CGNS_TOOLS_RESTRICT sz) {
+  for (std::size_t i = 0; i < n; ++i) {
+    const vec3<T> s = areaVector(vec3<T>{x[i], y[i], z[i]},
+                                 vec3<T>{x[i + b], y[i + b], z[i + b]},
+                                 vec3<T>{x[i + c], y[i + c], z[i + c]},
+                                 vec3<T>{x[i + d], y[i + d], z[i + d]});
+    sx[i] = s.x;
+    sy[i] = s.y;
+    sz[i] = s.z;
+  }
+}
+
+/// @brief volumes of n cells along i with vertex strides sj and sk. Adds the
+/// volume and the volume weighted cell centre to sums.
+template <typename T>
+CGNS_TOOLS_SIMD_CLONES void
+volumeRow(const T *CGNS_TOOLS_RESTRICT x, const T *CGNS_TOOLS_RESTRICT y,
+          const T *CGNS_TOOLS_RESTRICT z, const std::size_t sj,
+          const std::size_t sk, const std::size_t n,
+          T *CGNS_TOOLS_RESTRICT volume, T *sums) {
+  T v = 0;
+  T vx = 0;
+  T vy = 0;
+  T vz = 0;
+
+  for (std::size_t i = 0; i < n; ++i) {
+    // relative to the first vertex of the cell to preserve precision
+    const vec3<T> o{x[i], y[i], z[i]};
+    const auto p = [&](const std::size_t offset) {
+      return vec3<T>{x[i + offset], y[i + offset], z[i + offset]} - o;
+    };
+
+    const vec3<T> p000{0, 0, 0};
+    const vec3<T> p100 = p(1);
+    const vec3<T> p010 = p(sj);
+    const vec3<T> p110 = p(1 + sj);
+    const vec3<T> p001 = p(sk);
+    const vec3<T> p101 = p(1 + sk);
+    const vec3<T> p011 = p(sj + sk);
+    const vec3<T> p111 = p(1 + sj + sk);
+
+    // outward flux, the faces are oriented in positive index direction
+    const T flux = moment(p100, p110, p111, p101) -
+                   moment(p000, p010, p011, p001) +
+                   moment(p010, p011, p111, p110) -
+                   moment(p000, p001, p101, p100) +
+                   moment(p001, p101, p111, p011) -
+                   moment(p000, p100, p110, p010);
+    const T vol = flux / T(3);
+    volume[i] = vol;
+
+    // vertex average as cell centre
+    const vec3<T> centre = p100 + p010 + p110 + p001 + p101 + p011 + p111;
+    const T w = vol * T(0.125);
+    v += vol;
+    vx += vol * o.x + w * centre.x;
+    vy += vol * o.y + w * centre.y;
+    vz += vol * o.z + w * centre.z;
+  }
+
+  sums[0] += v;
+  sums[1] += vx;
+  sums[2] += vy;
+  sums[3] += vz;
+}
+
+/// extents of n vertices
+template <typename T>
+CGNS_TOOLS_SIMD_CLONES void extentRow(const T *x, const std::size_t n, T &lo,
+                                      T &hi) {
+  // independent lanes, the reduction itself is not vectorised without
+  // relaxed floating point semantics
+  constexpr std::size_t lanes = 16;
+  T l[lanes];
+  T h[lanes];
+  for (std::size_t s = 0; s < lanes; ++s) {
+    l[s] = lo;
+    h[s] = hi;
+  }
+
+  std::size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    for (std::size_t s = 0; s < lanes; ++s) {
+      l[s] = x[i + s] < l[s] ? x[i + s] : l[s];
+      h[s] = x[i + s] > h[s] ? x[i + s] : h[s];
+    }
+  }
+  for (; i < n; ++i) {
+    l[0] = x[i] < l[0] ? x[i] : l[0];
+    h[0] = x[i] > h[0] ? x[i] : h[0];
+  }
+
+  for (std::size_t s = 0; s < lanes; ++s) {
+    lo = l[s] < lo ? l[s] : lo;
+    hi = h[s] > hi ? h[s] : hi;
+  }
+}
+
+} // namespace
+
+template <typename T>
+structuredMetrics<T> computeMetrics(const std::array<cgsize_t, 3> &nVertex,
+                                    const T *x, const T *y, const T *z,
+                                    const metricsOptions &options) {
+  const std::size_t ni = nVertex[0];
+  const std::size_t nj = nVertex[1];
+  const std::size_t nk = nVertex[2];
+
+  if (ni < 2 || nj < 2 || nk < 2) {
+    CGNS_TOOLS_ERROR("Metrics require at least 2 vertices per direction, "
+                     "got [{}, {}, {}].",
+                     ni, nj, nk);
+    exit(EXIT_FAILURE);
+  }
+
+  // vertex strides
+  const std::size_t sj = ni;
+  const std::size_t sk = ni * nj;
+
+  const std::size_t nci = ni - 1;
+  const std::size_t ncj = nj - 1;
+  const std::size_t nck = nk - 1;
+
+  structuredMetrics<T> m{};
+  m.nVertex = nVertex;
+  m.volume.resize(nci * ncj * nck);
+
+  // face counts per direction
+  const std::array<std::array<std::size_t, 3>, 3> nFace = {
+      {{ni, ncj, nck}, {nci, nj, nck}, {nci, ncj, nk}}};
+
+  if (options.faceVectors) {
+    for (std::size_t d = 0; d < 3; ++d) {
+      for (auto &component : m.faceVectors[d]) {
+        component.resize(nFace[d][0] * nFace[d][1] * nFace[d][2]);
+      }
+    }
+  }
+
+  std::mutex mutex{};
+  std::array<double, 4> sums = {0.0, 0.0, 0.0, 0.0};
+  for (std::size_t d = 0; d < 3; ++d) {
+    m.bbox.min[d] = std::numeric_limits<double>::max();
+    m.bbox.max[d] = std::numeric_limits<double>::lowest();
+  }
+
+  // one pass over the vertex k-planes, plane k holds the cells and the
+  // I- and J-faces of cell layer k and the K-faces of vertex plane k
+  parallelForBlocks(
+      0, nk,
+      [&](const std::size_t first, const std::size_t last) {
+        std::array<double, 4> blockSums = {0.0, 0.0, 0.0, 0.0};
+        std::array<T, 3> lo{}, hi{};
+        const T *coords[3] = {x, y, z};
+        for (std::size_t d = 0; d < 3; ++d) {
+          lo[d] = hi[d] = coords[d][first * sk];
+        }
+
+        for (std::size_t k = first; k < last; ++k) {
+          for (std::size_t j = 0; j < nj; ++j) {
+            const std::size_t v = j * sj + k * sk;
+
+            for (std::size_t d = 0; d < 3; ++d) {
+              extentRow(coords[d] + v, ni, lo[d], hi[d]);
+            }
+
+            if (options.faceVectors && j < ncj) {
+              auto &s = m.faceVectors[2];
+              const std::size_t f = nci * (j + ncj * k);
+              faceRow(x + v, y + v, z + v, 1, 1 + sj, sj, nci, s[0].data() + f,
+                      s[1].data() + f, s[2].data() + f);
+            }
+
+            if (k == nck) {
+              continue;
+            }
+
+            if (options.faceVectors) {
+              if (j < ncj) {
+                auto &s = m.faceVectors[0];
+                const std::size_t f = ni * (j + ncj * k);
+                faceRow(x + v, y + v, z + v, sj, sj + sk, sk, ni,
+                        s[0].data() + f, s[1].data() + f, s[2].data() + f);
+              }
+
+              auto &s = m.faceVectors[1];
+              const std::size_t f = nci * (j + nj * k);
+              faceRow(x + v, y + v, z + v, sk, 1 + sk, 1, nci, s[0].data() + f,
+                      s[1].data() + f, s[2].data() + f);
+            }
+
+            if (j < ncj) {
+              T rowSums[4] = {0, 0, 0, 0};
+              volumeRow(x + v, y + v, z + v, sj, sk, nci,
+                        m.volume.data() + nci * (j + ncj * k), rowSums);
+              for (std::size_t s = 0; s < 4; ++s) {
+                blockSums[s] += rowSums[s];
+              }
+            }
+          }
+        }
+
+        const std::scoped_lock lock{mutex};
+        for (std::size_t s = 0; s < 4; ++s) {
+          sums[s] += blockSums[s];
+        }
+        for (std::size_t d = 0; d < 3; ++d) {
+          m.bbox.min[d] = std::min<double>(m.bbox.min[d], lo[d]);
+          m.bbox.max[d] = std::max<double>(m.bbox.max[d], hi[d]);
+        }
+      },
+      options.nThreads);
+
+  m.totalVolume = sums[0];
+  if (sums[0] != 0.0) {
+    for (std::size_t d = 0; d < 3; ++d) {
+      m.centroid[d] = sums[d + 1] / sums[0];
+    }
+  }
+
+  return m;
+}
+
+template <typename T>
+structuredMetrics<T> computeMetrics(const zoneStructured &zone,
+                                    const metricsOptions &options) {
+  if (zone.indexDimension() != 3) {
+    CGNS_TOOLS_ERROR("Metrics of Zone {} require a 3d structured zone.",
+                     zone.name);
+    exit(EXIT_FAILURE);
+  }
+
+  if (zone.gridCoordinates.empty()) {
+    CGNS_TOOLS_ERROR("Zone {} has no grid coordinates.", zone.name);
+    exit(EXIT_FAILURE);
+  }
+
+  const std::string names[3] = {"CoordinateX", "CoordinateY", "CoordinateZ"};
+  const T *coords[3] = {nullptr, nullptr, nullptr};
+
+  for (const auto &array : zone.gridCoordinates.front().dataArrays) {
+    const auto *da = std::get_if<dataArray<T>>(&array);
+    const auto &name =
+        std::visit([](const auto &a) -> const std::string & { return a.name; },
+                   array);
+
+    for (std::size_t d = 0; d < 3; ++d) {
+      if (name != names[d]) {
+        continue;
+      }
+      if (!da) {
+        CGNS_TOOLS_ERROR("{} of Zone {} is not stored with the requested "
+                         "precision.",
+                         name, zone.name);
+        exit(EXIT_FAILURE);
+      }
+      coords[d] = da->data().data();
+    }
+  }
+
+  for (std::size_t d = 0; d < 3; ++d) {
+    if (!coords[d]) {
+      CGNS_TOOLS_ERROR("{} missing in Zone {}.", names[d], zone.name);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  CGNS_TOOLS_DEBUG(indent(4, "Computing metrics of Zone {}", zone.name));
+
+  return computeMetrics<T>({zone.nVertex[0], zone.nVertex[1], zone.nVertex[2]},
+                           coords[0], coords[1], coords[2], options);
+}
+
+template structuredMetrics<float>
+computeMetrics<float>(const std::array<cgsize_t, 3> &, const float *,
+                      const float *, const float *, const metricsOptions &);
+template structuredMetrics<double>
+computeMetrics<double>(const std::array<cgsize_t, 3> &, const double *,
+                       const double *, const double *, const metricsOptions &);
+template structuredMetrics<float>
+computeMetrics<float>(const zoneStructured &, const metricsOptions &);
+template structuredMetrics<double>
+computeMetrics<double>(const zoneStructured &, const metricsOptions &);
+
+} // namespace cgns_tools
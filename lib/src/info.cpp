@@ -0,0 +1,249 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "../include/info.hpp"
+
+#include <cgnslib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../include/logger.hpp"
+#include "spdlog/spdlog.h"
+
+namespace cgns_tools {
+
+namespace {
+
+zoneInfo inspectZone(const fileIn &file, const int B, const int Z) {
+  zoneInfo zone{};
+  zone.name = file.readZoneName(B, Z);
+  zone.type = file.readZoneType(B, Z);
+  zone.size = file.readZoneSize(B, Z);
+
+  for (int G = 1; G <= file.nGrids(B, Z); ++G) {
+    zone.grids.push_back(file.readGridName(B, Z, G));
+  }
+  if (!zone.grids.empty()) {
+    zone.coordinates = file.readCoordinateInfo(B, Z);
+  }
+
+  for (int S = 1; S <= file.nSolutions(B, Z); ++S) {
+    auto [name, location] = file.readSolutionInfo(B, Z, S);
+    zone.solutions.push_back(
+        {std::move(name), location, file.readFieldInfo(B, Z, S)});
+  }
+
+  if (zone.type == Unstructured) {
+    zone.nSections = file.nSections(B, Z);
+  }
+
+  return zone;
+}
+
+/// json string literal with the required escapes
+std::string quoted(const std::string_view s) {
+  std::string q = "\"";
+  for (const char c : s) {
+    switch (c) {
+    case '"':
+      q += "\\\"";
+      break;
+    case '\\':
+      q += "\\\\";
+      break;
+    case '\n':
+      q += "\\n";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        q += fmt::format("\\u{:04x}", c);
+      } else {
+        q += c;
+      }
+    }
+  }
+  return q + "\"";
+}
+
+/// json array of the elements, each written by fn
+template <typename C, typename F>
+void jsonArray(std::ostream &out, const C &container, F &&fn) {
+  out << "[";
+  for (auto it = container.begin(); it != container.end(); ++it) {
+    if (it != container.begin()) {
+      out << ",";
+    }
+    fn(*it);
+  }
+  out << "]";
+}
+
+void jsonArrays(std::ostream &out, const std::vector<arrayInfo> &arrays) {
+  jsonArray(out, arrays, [&](const arrayInfo &a) {
+    out << "{\"name\":" << quoted(a.first)
+        << ",\"dataType\":" << quoted(cg_DataTypeName(a.second)) << "}";
+  });
+}
+
+} // namespace
+
+fileInfo inspect(const std::string &path) {
+  fileInfo info{path, {}, {}};
+
+  // cg_open exits on invalid files, they are rejected upfront
+  int filetype = 0;
+  {
+#ifndef CGNS_TOOLS_THREADSAFE_CGNS
+    const std::scoped_lock lock{cgnsMutex()};
+#endif
+    if (cg_is_cgns(path.c_str(), &filetype) != CG_OK) {
+      CGNS_TOOLS_WARN("{} is not a cgns file.", path);
+      info.error = "not a cgns file";
+      return info;
+    }
+  }
+
+  const fileIn file{path};
+
+  for (int B = 1; B <= file.nBases(); ++B) {
+    base header = file.readBaseHeader(B);
+
+    baseInfo b{std::move(header.name), header.cellDimension,
+               header.physicalDimension, {}, std::move(header.families)};
+
+    for (int Z = 1; Z <= file.nZones(B); ++Z) {
+      b.zones.push_back(inspectZone(file, B, Z));
+    }
+
+    info.bases.push_back(std::move(b));
+  }
+
+  return info;
+}
+
+std::vector<fileInfo> inspect(const std::vector<std::string> &paths,
+                              const infoOptions &options) {
+  std::vector<fileInfo> infos(paths.size());
+  if (paths.empty()) {
+    return infos;
+  }
+
+  const unsigned nThreads = std::min<unsigned>(
+      std::max(options.nThreads, 1u), static_cast<unsigned>(paths.size()));
+
+  // the files are assigned dynamically as their zone counts vary strongly
+  std::atomic<std::size_t> next = 0;
+
+  parallelForBlocks(
+      0, nThreads,
+      [&](std::size_t, std::size_t) {
+        for (std::size_t n = next++; n < paths.size(); n = next++) {
+          infos[n] = inspect(paths[n]);
+        }
+      },
+      nThreads);
+
+  return infos;
+}
+
+std::ostream &operator<<(std::ostream &out, const fileInfo &info) {
+  out << "File : " << info.path << "\n";
+  if (!info.error.empty()) {
+    out << "  Error : " << info.error << std::endl;
+    return out;
+  }
+
+  for (const auto &base : info.bases) {
+    out << "  Base : " << base.name << "\n"
+        << "    cellDimension : " << base.cellDimension << "\n"
+        << "    physicalDimension : " << base.physicalDimension << "\n";
+
+    for (const auto &family : base.families) {
+      out << "    Family : " << family.name;
+      if (family.bc) {
+        out << " (" << to_string(family.bc->bcType) << ")";
+      }
+      out << "\n";
+    }
+
+    for (const auto &zone : base.zones) {
+      out << "    Zone : " << zone.name << "\n"
+          << "      ZoneType : " << cg_ZoneTypeName(zone.type) << "\n"
+          << "      Size : [" << fmt::format("{}", fmt::join(zone.size, " , "))
+          << "]\n";
+
+      if (!zone.grids.empty()) {
+        out << "      Grids : ["
+            << fmt::format("{}", fmt::join(zone.grids, " , ")) << "]\n";
+      }
+      for (const auto &[name, datatype] : zone.coordinates) {
+        out << "      " << name << " : " << cg_DataTypeName(datatype) << "\n";
+      }
+      for (const auto &solution : zone.solutions) {
+        out << "      FlowSolution : " << solution.name << " ("
+            << cg_GridLocationName(solution.location) << ", "
+            << solution.fields.size() << " fields)\n";
+      }
+      if (zone.type == Unstructured) {
+        out << "      nSections : " << zone.nSections << "\n";
+      }
+    }
+  }
+
+  return out << std::flush;
+}
+
+void writeJson(std::ostream &out, const std::vector<fileInfo> &infos) {
+  jsonArray(out, infos, [&](const fileInfo &info) {
+    out << "{\"path\":" << quoted(info.path);
+    if (!info.error.empty()) {
+      out << ",\"error\":" << quoted(info.error);
+    }
+    out << ",\"bases\":";
+    jsonArray(out, info.bases, [&](const baseInfo &base) {
+      out << "{\"name\":" << quoted(base.name)
+          << ",\"cellDimension\":" << base.cellDimension
+          << ",\"physicalDimension\":" << base.physicalDimension
+          << ",\"families\":";
+      jsonArray(out, base.families, [&](const family &family) {
+        out << "{\"name\":" << quoted(family.name);
+        if (family.bc) {
+          out << ",\"bc\":" << quoted(to_string(family.bc->bcType));
+        }
+        out << "}";
+      });
+      out << ",\"zones\":";
+      jsonArray(out, base.zones, [&](const zoneInfo &zone) {
+        out << "{\"name\":" << quoted(zone.name)
+            << ",\"type\":" << quoted(cg_ZoneTypeName(zone.type))
+            << ",\"size\":";
+        jsonArray(out, zone.size, [&](const cgsize_t i) { out << i; });
+        out << ",\"grids\":";
+        jsonArray(out, zone.grids,
+                  [&](const std::string &g) { out << quoted(g); });
+        out << ",\"coordinates\":";
+        jsonArrays(out, zone.coordinates);
+        out << ",\"solutions\":";
+        jsonArray(out, zone.solutions, [&](const solutionInfo &s) {
+          out << "{\"name\":" << quoted(s.name)
+              << ",\"location\":" << quoted(cg_GridLocationName(s.location))
+              << ",\"fields\":";
+          jsonArrays(out, s.fields);
+          out << "}";
+        });
+        out << ",\"nSections\":" << zone.nSections << "}";
+      });
+      out << "}";
+    });
+    out << "}";
+  });
+  out << std::endl;
+}
+
+} // namespace cgns_tools
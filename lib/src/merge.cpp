@@ -0,0 +1,662 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "../include/merge.hpp"
+
+#include <cgnslib.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "../include/logger.hpp"
+#include "spdlog/spdlog.h"
+
+namespace cgns_tools {
+
+namespace {
+
+/// elements of the merged zone collected in a single section
+struct bucket {
+  std::string name;
+
+  ElementType_t type;
+
+  std::vector<cgsize_t> conn{};
+
+  /// ElementStartOffset of MIXED buckets
+  std::vector<cgsize_t> offsets{0};
+
+  cgsize_t nElements = 0;
+
+  /// first element in the merged zone, assigned after collecting
+  cgsize_t start = 0;
+
+  /// @brief elements of a lower dimension than the cells, numbered after the
+  /// volume elements
+  bool boundary = false;
+
+  /// BC referencing all elements of a boundary bucket
+  std::optional<boundaryCondition> bc = std::nullopt;
+};
+
+/// @brief run of volume elements of a part copied to position of a bucket,
+/// first is the index (0-based) among the volume elements of the part
+struct cellRun {
+  cgsize_t first;
+  cgsize_t count;
+  std::size_t bucket;
+  cgsize_t position;
+};
+
+/// element range of a part referenced by a BC
+struct bcRange {
+  cgsize_t first;
+  cgsize_t last;
+  const boundaryCondition *bc;
+};
+
+/// dimension of the elements of a fixed-size type
+unsigned elementDimension(const ElementType_t type) {
+  switch (type) {
+  case NODE:
+    return 0;
+  case BAR_2:
+  case BAR_3:
+  case BAR_4:
+  case BAR_5:
+    return 1;
+  case TRI_3:
+  case TRI_6:
+  case TRI_9:
+  case TRI_10:
+  case TRI_12:
+  case TRI_15:
+  case QUAD_4:
+  case QUAD_8:
+  case QUAD_9:
+  case QUAD_12:
+  case QUAD_16:
+  case QUAD_P4_16:
+  case QUAD_25:
+    return 2;
+  default:
+    return 3;
+  }
+}
+
+/// @brief highest dimension of the elements of a section, MIXED elements
+/// start with their element type
+unsigned sectionDimension(const elementSection &section,
+                          const std::vector<cgsize_t> &conn) {
+  if (section.type != MIXED) {
+    return elementDimension(section.type);
+  }
+
+  unsigned dimension = 0;
+  for (cgsize_t e = 0; e < section.nElements(); ++e) {
+    dimension = std::max(
+        dimension, elementDimension(static_cast<ElementType_t>(
+                       conn[section.offsets[e]])));
+  }
+  return dimension;
+}
+
+/// @brief explicit connectivity of a section, generated ones are filled and
+/// stored ones read completely
+std::vector<cgsize_t> explicitConnectivity(elementSection &section) {
+  return std::visit(
+      overloaded{[](std::vector<cgsize_t> &conn) { return std::move(conn); },
+                 [&section](const structuredConnectivity &generated) {
+                   std::vector<cgsize_t> conn(
+                       static_cast<std::size_t>(section.nElements()) *
+                       generated.nodesPerElement());
+                   generated.fill(1, section.nElements(), conn.data());
+                   return conn;
+                 },
+                 [&section](const storedConnectivity &stored) {
+                   std::vector<cgsize_t> conn{};
+                   stored.read(1, section.nElements(), conn, section.offsets);
+                   return conn;
+                 }},
+      section.connectivity);
+}
+
+/// copy element e (0-based) of a section with its vertices renumbered
+void append(bucket &b, const elementSection &section,
+            const std::vector<cgsize_t> &conn, const int npe,
+            const cgsize_t e, const std::vector<cgsize_t> &map) {
+  if (section.type == MIXED) {
+    const cgsize_t begin = section.offsets[e];
+    const cgsize_t end = section.offsets[e + 1];
+
+    // the first entry is the element type
+    b.conn.push_back(conn[begin]);
+    for (cgsize_t i = begin + 1; i < end; ++i) {
+      b.conn.push_back(map[conn[i] - 1] + 1);
+    }
+    b.offsets.push_back(static_cast<cgsize_t>(b.conn.size()));
+  } else {
+    for (cgsize_t i = e * npe; i < (e + 1) * npe; ++i) {
+      b.conn.push_back(map[conn[i] - 1] + 1);
+    }
+  }
+  ++b.nElements;
+}
+
+/// @brief gather array name of the parts into an array of the merged zone
+/// with n entries, scatter(p, values, data) copies the values of part p
+template <typename T, typename Arrays, typename Scatter>
+dataArray<T> gather(const std::string &name, const std::size_t nParts,
+                    Arrays &&arrays, const std::size_t n, Scatter &&scatter) {
+  buffer<T> data(n, T{0});
+
+  for (std::size_t p = 0; p < nParts; ++p) {
+    for (const auto &array : arrays(p)) {
+      std::visit(
+          [&](const auto &da) {
+            if (da.name == name) {
+              scatter(p, da.data(), data.data());
+            }
+          },
+          array);
+    }
+  }
+
+  return dataArray<T>{std::string{name}, std::move(data)};
+}
+
+/// names of the arrays of all parts and whether any of them is RealDouble
+template <typename Arrays>
+std::pair<std::vector<std::string>, bool>
+arrayNames(const std::size_t nParts, Arrays &&arrays) {
+  std::vector<std::string> names{};
+  bool isDouble = false;
+
+  for (std::size_t p = 0; p < nParts; ++p) {
+    for (const auto &array : arrays(p)) {
+      std::visit(
+          [&](const auto &da) {
+            using T = typename std::decay_t<decltype(da)>::value_type;
+            isDouble |= std::is_same_v<T, double>;
+            if (std::find(names.begin(), names.end(), da.name) ==
+                names.end()) {
+              names.push_back(da.name);
+            }
+          },
+          array);
+    }
+  }
+
+  return {std::move(names), isDouble};
+}
+
+/// true if all parts have the same flow solutions and fields
+bool sameSolutions(const std::vector<zoneUnstructured> &parts) {
+  const auto &first = parts.front().flowSolutions;
+
+  for (const auto &part : parts) {
+    const auto &solutions = part.flowSolutions;
+    if (solutions.size() != first.size()) {
+      return false;
+    }
+    for (std::size_t s = 0; s < first.size(); ++s) {
+      if (solutions[s].name != first[s].name ||
+          solutions[s].location != first[s].location ||
+          solutions[s].fields.size() != first[s].fields.size()) {
+        return false;
+      }
+      for (std::size_t f = 0; f < first[s].fields.size(); ++f) {
+        const auto name = [](const dataArrayV &field) {
+          return std::visit([](const auto &da) { return da.name; }, field);
+        };
+        if (name(solutions[s].fields[f]) != name(first[s].fields[f])) {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+/// merge the given zones into a single unstructured zone
+zoneUnstructured
+mergeGroup(std::vector<zoneV> &&zones,
+           const std::vector<const std::vector<cgsize_t> *> &ids,
+           const cgsize_t nGlobal, const unsigned cellDimension,
+           std::string &&name, const std::optional<std::string> &familyName,
+           const mergeOptions &options) {
+  CGNS_TOOLS_INFO(indent(4, "Merging {} Zones into Zone {}", zones.size(),
+                         name));
+
+  // vertices of the merged zone in the order of first occurrence
+  std::vector<cgsize_t> local(static_cast<std::size_t>(nGlobal), -1);
+  std::vector<std::vector<cgsize_t>> maps(zones.size());
+  cgsize_t nVertex = 0;
+
+  for (std::size_t p = 0; p < zones.size(); ++p) {
+    const auto &global = *ids[p];
+    maps[p].resize(global.size());
+    for (std::size_t v = 0; v < global.size(); ++v) {
+      auto &l = local[global[v]];
+      if (l < 0) {
+        l = nVertex++;
+      }
+      maps[p][v] = l;
+    }
+  }
+  std::vector<cgsize_t>{}.swap(local);
+
+  // structured zones keep their vertex and cell ordering when converted
+  std::vector<zoneUnstructured> parts{};
+  parts.reserve(zones.size());
+  cgsize_t nCell = 0;
+  for (auto &zone : zones) {
+    if (auto *z = std::get_if<zoneStructured>(&zone)) {
+      parts.emplace_back(toUnstructured(std::move(*z), options.conversion));
+    } else {
+      parts.emplace_back(std::move(std::get<zoneUnstructured>(zone)));
+    }
+    nCell += parts.back().nCell;
+  }
+  std::vector<zoneV>{}.swap(zones);
+
+  // coordinates of the first grid
+  const auto coordinates = [&parts](const std::size_t p)
+      -> const std::vector<gridCoordinateDataV> & {
+    static const std::vector<gridCoordinateDataV> none{};
+    return parts[p].gridCoordinates.empty()
+               ? none
+               : parts[p].gridCoordinates.front().dataArrays;
+  };
+
+  std::vector<gridCoordinateDataV> merged{};
+  {
+    const auto [names, isDouble] = arrayNames(parts.size(), coordinates);
+
+    for (const auto &coordname : names) {
+      const auto scatter = [&maps](const std::size_t p, const auto &values,
+                                   auto *data) {
+        for (std::size_t v = 0; v < maps[p].size(); ++v) {
+          data[maps[p][v]] = values[v];
+        }
+      };
+      if (isDouble) {
+        merged.emplace_back(gather<double>(coordname, parts.size(),
+                                           coordinates, nVertex, scatter));
+      } else {
+        merged.emplace_back(gather<float>(coordname, parts.size(),
+                                          coordinates, nVertex, scatter));
+      }
+    }
+  }
+
+  for (auto &part : parts) {
+    if (part.gridCoordinates.size() > 1) {
+      CGNS_TOOLS_WARN("Zone {} has {} grids, only the first one is merged.",
+                      part.name, part.gridCoordinates.size());
+    }
+    part.gridCoordinates.clear();
+  }
+
+  std::vector<gridCoordinatesT> grids{};
+  grids.emplace_back("GridCoordinates", std::move(merged));
+
+  // elements, volume buckets per element type, boundary buckets per BC or
+  // per section of lower dimension elements without a BC
+  std::vector<bucket> buckets{};
+  std::map<std::string, std::size_t> bucketIndex{};
+  std::set<std::string> bucketNames{};
+
+  const auto bucketFor = [&](const std::string &key, const std::string &base,
+                             const ElementType_t type, const bool boundary,
+                             const boundaryCondition *bc) {
+    const auto it = bucketIndex.find(key);
+    if (it != bucketIndex.end()) {
+      return it->second;
+    }
+
+    std::string unique = base.substr(0, 32);
+    if (!bucketNames.insert(unique).second) {
+      unique = (base + "_" + cg_ElementTypeName(type)).substr(0, 32);
+      bucketNames.insert(unique);
+    }
+
+    bucket b{unique, type};
+    b.boundary = boundary;
+    if (bc != nullptr) {
+      b.bc.emplace(std::string{unique}, bc->type, PointRange, bc->location,
+                   std::vector<cgsize_t>{});
+      b.bc->familyName = bc->familyName;
+    }
+    buckets.emplace_back(std::move(b));
+
+    return bucketIndex.emplace(key, buckets.size() - 1).first->second;
+  };
+
+  // vertex located BCs are merged into point lists per family (or BC name)
+  std::vector<boundaryCondition> vertexBCs{};
+  std::map<std::string, std::size_t> vertexBCIndex{};
+
+  std::vector<std::vector<cellRun>> cells(parts.size());
+
+  for (std::size_t p = 0; p < parts.size(); ++p) {
+    auto &part = parts[p];
+
+    std::vector<bcRange> ranges{};
+    for (const auto &bc : part.boundaryConditions) {
+      const std::string key = bc.familyName.value_or(bc.name);
+
+      if (bc.location == Vertex) {
+        auto it = vertexBCIndex.find(key);
+        if (it == vertexBCIndex.end()) {
+          vertexBCs.emplace_back(std::string{key}, bc.type, PointList, Vertex,
+                                 std::vector<cgsize_t>{});
+          vertexBCs.back().familyName = bc.familyName;
+          it = vertexBCIndex.emplace(key, vertexBCs.size() - 1).first;
+        }
+
+        auto &points = vertexBCs[it->second].points;
+        const auto add = [&](const cgsize_t v) {
+          points.push_back(maps[p][v - 1] + 1);
+        };
+        if (bc.pointSet == PointRange && bc.points.size() == 2) {
+          for (cgsize_t v = bc.points[0]; v <= bc.points[1]; ++v) {
+            add(v);
+          }
+        } else {
+          std::for_each(bc.points.begin(), bc.points.end(), add);
+        }
+        continue;
+      }
+
+      if (bc.pointSet == PointRange && bc.points.size() == 2) {
+        ranges.push_back({std::min(bc.points[0], bc.points[1]),
+                          std::max(bc.points[0], bc.points[1]), &bc});
+      } else if (bc.pointSet == PointList) {
+        for (const auto e : bc.points) {
+          ranges.push_back({e, e, &bc});
+        }
+      } else {
+        CGNS_TOOLS_WARN("BC {} of Zone {} has an unsupported point set, "
+                        "skipped.",
+                        bc.name, part.name);
+      }
+    }
+
+    std::sort(ranges.begin(), ranges.end(),
+              [](const bcRange &a, const bcRange &b) {
+                return a.first < b.first;
+              });
+
+    // volume elements of the part in the order of the cell data
+    cgsize_t nPartVolume = 0;
+    std::set<const boundaryCondition *> skipped{};
+
+    for (auto &section : part.sections) {
+      if (section.type == NGON_n || section.type == NFACE_n) {
+        CGNS_TOOLS_ERROR("Section {} of Zone {}: {} sections can not be "
+                         "merged.",
+                         section.name, part.name,
+                         cg_ElementTypeName(section.type));
+        exit(EXIT_FAILURE);
+      }
+
+      const std::vector<cgsize_t> conn = explicitConnectivity(section);
+
+      int npe = 0;
+      if (!hasStartOffset(section.type)) {
+        cgnsFn<cg_npe>(section.type, &npe);
+      }
+
+      const std::string typeName = cg_ElementTypeName(section.type);
+
+      if (sectionDimension(section, conn) == cellDimension) {
+        // the cell data follows the volume elements, BCs do not split them
+        for (const auto &range : ranges) {
+          if (range.first <= section.end && range.last >= section.start &&
+              skipped.insert(range.bc).second) {
+            CGNS_TOOLS_WARN("BC {} of Zone {} references volume elements, "
+                            "they are not part of the merged BC.",
+                            range.bc->name, part.name);
+          }
+        }
+
+        const std::size_t b = bucketFor("cells:" + typeName, typeName,
+                                        section.type, false, nullptr);
+        cells[p].push_back(
+            {nPartVolume, section.nElements(), b, buckets[b].nElements});
+        nPartVolume += section.nElements();
+
+        for (cgsize_t e = 0; e < section.nElements(); ++e) {
+          append(buckets[b], section, conn, npe, e, maps[p]);
+        }
+        continue;
+      }
+
+      // runs of boundary elements referenced by the same BC (or none), the
+      // elements of lower dimension sections are boundary elements even
+      // without a BC
+      auto r = ranges.begin();
+      for (cgsize_t e = section.start; e <= section.end;) {
+        while (r != ranges.end() && r->last < e) {
+          ++r;
+        }
+
+        const boundaryCondition *bc = nullptr;
+        cgsize_t runEnd = section.end;
+        if (r != ranges.end() && r->first <= e) {
+          bc = r->bc;
+          runEnd = std::min(r->last, section.end);
+        } else if (r != ranges.end()) {
+          runEnd = std::min(r->first - 1, section.end);
+        }
+
+        const std::size_t b =
+            bc != nullptr
+                ? bucketFor("bc:" + bc->familyName.value_or(bc->name) + ":" +
+                                typeName,
+                            bc->familyName.value_or(bc->name), section.type,
+                            true, bc)
+                : bucketFor("faces:" + section.name + ":" + typeName,
+                            section.name, section.type, true, nullptr);
+
+        for (cgsize_t x = e; x <= runEnd; ++x) {
+          append(buckets[b], section, conn, npe, x - section.start, maps[p]);
+        }
+
+        e = runEnd + 1;
+      }
+    }
+
+    if (nPartVolume != part.nCell) {
+      CGNS_TOOLS_ERROR("Zone {} has {} cells but {} volume elements.",
+                       part.name, part.nCell, nPartVolume);
+      exit(EXIT_FAILURE);
+    }
+
+    part.sections.clear();
+    part.boundaryConditions.clear();
+  }
+
+  // volume elements are numbered first
+  std::vector<elementSection> sections{};
+  std::vector<boundaryCondition> bcs{};
+  cgsize_t next = 1;
+
+  for (const bool boundary : {false, true}) {
+    for (auto &b : buckets) {
+      if (b.boundary != boundary) {
+        continue;
+      }
+
+      b.start = next;
+      next += b.nElements;
+
+      sections.emplace_back(std::string{b.name}, b.type, b.start,
+                            b.start + b.nElements - 1, std::move(b.conn));
+      if (b.type == MIXED) {
+        sections.back().offsets = std::move(b.offsets);
+      }
+
+      if (b.bc.has_value()) {
+        b.bc->points = {b.start, b.start + b.nElements - 1};
+        bcs.emplace_back(std::move(*b.bc));
+      }
+    }
+  }
+
+  for (auto &bc : vertexBCs) {
+    bcs.emplace_back(std::move(bc));
+  }
+
+  CGNS_TOOLS_DEBUG(indent(6, "nVertex : {}", nVertex));
+  CGNS_TOOLS_DEBUG(indent(6, "nCell : {}", nCell));
+  CGNS_TOOLS_DEBUG(indent(6, "nSections : {}", sections.size()));
+  CGNS_TOOLS_DEBUG(indent(6, "nBC : {}", bcs.size()));
+
+  // flow solutions, vertex data is welded like the coordinates and cell data
+  // follows the elements
+  std::vector<flowSolution> solutions{};
+
+  if (!sameSolutions(parts)) {
+    CGNS_TOOLS_WARN("Zones of {} have different flow solutions, dropped.",
+                    name);
+  } else {
+    const auto &first = parts.front().flowSolutions;
+
+    for (std::size_t s = 0; s < first.size(); ++s) {
+      const GridLocation_t location = first[s].location;
+
+      if (location != Vertex && location != CellCenter) {
+        CGNS_TOOLS_WARN("Flow solution {} at {} can not be merged, dropped.",
+                        first[s].name, cg_GridLocationName(location));
+        continue;
+      }
+
+      const auto fields = [&parts, s](const std::size_t p)
+          -> const std::vector<dataArrayV> & {
+        return parts[p].flowSolutions[s].fields;
+      };
+
+      const auto scatter = [&](const std::size_t p, const auto &values,
+                               auto *data) {
+        if (location == Vertex) {
+          for (std::size_t v = 0; v < maps[p].size(); ++v) {
+            data[maps[p][v]] = values[v];
+          }
+          return;
+        }
+        if (values.size() != static_cast<std::size_t>(parts[p].nCell)) {
+          CGNS_TOOLS_ERROR("Flow solution {} of Zone {} has {} values for {} "
+                           "cells.",
+                           first[s].name, parts[p].name, values.size(),
+                           parts[p].nCell);
+          exit(EXIT_FAILURE);
+        }
+        for (const auto &run : cells[p]) {
+          const cgsize_t dst = buckets[run.bucket].start - 1 + run.position;
+          for (cgsize_t x = 0; x < run.count; ++x) {
+            data[dst + x] = values[run.first + x];
+          }
+        }
+      };
+
+      const std::size_t n =
+          static_cast<std::size_t>(location == Vertex ? nVertex : nCell);
+
+      std::vector<dataArrayV> merged{};
+      const auto [names, isDouble] = arrayNames(parts.size(), fields);
+      for (const auto &fieldname : names) {
+        if (isDouble) {
+          merged.emplace_back(
+              gather<double>(fieldname, parts.size(), fields, n, scatter));
+        } else {
+          merged.emplace_back(
+              gather<float>(fieldname, parts.size(), fields, n, scatter));
+        }
+      }
+
+      solutions.emplace_back(std::string{first[s].name}, location,
+                             std::move(merged));
+    }
+  }
+
+  zoneUnstructured zone{std::move(name), nVertex, nCell, 0, std::move(grids),
+                        std::move(sections)};
+  zone.boundaryConditions = std::move(bcs);
+  zone.flowSolutions = std::move(solutions);
+  zone.familyName = familyName;
+
+  return zone;
+}
+
+} // namespace
+
+base merge(base &&b, const mergeOptions &options) {
+  CGNS_TOOLS_INFO(indent(2, "Merging Zones of Base {}", b.name));
+
+  const auto numbering = numberVertices(b, options.numbering);
+
+  // groups in the order of their first zone
+  std::vector<std::optional<std::string>> families{};
+  std::vector<std::vector<std::size_t>> groups{};
+
+  for (std::size_t Z = 0; Z < b.zones.size(); ++Z) {
+    const auto family =
+        options.byFamily
+            ? std::visit([](const auto &z) { return z.familyName; },
+                         b.zones[Z])
+            : std::nullopt;
+
+    const auto it = std::find(families.begin(), families.end(), family);
+    if (it == families.end()) {
+      families.push_back(family);
+      groups.push_back({Z});
+    } else {
+      groups[it - families.begin()].push_back(Z);
+    }
+  }
+
+  std::vector<zoneV> merged{};
+  merged.reserve(groups.size());
+
+  for (std::size_t g = 0; g < groups.size(); ++g) {
+    std::vector<zoneV> zones{};
+    std::vector<const std::vector<cgsize_t> *> ids{};
+    for (const auto Z : groups[g]) {
+      zones.emplace_back(std::move(b.zones[Z]));
+      ids.push_back(&numbering.ids[Z]);
+    }
+
+    std::string name =
+        families[g].value_or(groups.size() == 1 ? std::string{"Merged"}
+                                                : fmt::format("Merged{}", g));
+
+    merged.emplace_back(mergeGroup(std::move(zones), ids, numbering.nVertex,
+                                   b.cellDimension, std::move(name),
+                                   families[g], options));
+  }
+
+  b.zones = std::move(merged);
+
+  return std::move(b);
+}
+
+root merge(root &&r, const mergeOptions &options) {
+  for (auto &base : r.bases) {
+    base = merge(std::move(base), options);
+  }
+  return std::move(r);
+}
+
+} // namespace cgns_tools
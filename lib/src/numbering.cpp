@@ -0,0 +1,368 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "../include/numbering.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "../include/logger.hpp"
+#include "spdlog/spdlog.h"
+
+namespace cgns_tools {
+
+namespace {
+
+/// union-find over all vertices, the smallest vertex represents its set
+class disjointSets {
+public:
+  explicit disjointSets(const std::size_t n) : _parent(n) {
+    std::iota(_parent.begin(), _parent.end(), cgsize_t{0});
+  }
+
+  cgsize_t find(cgsize_t v) {
+    while (_parent[v] != v) {
+      _parent[v] = _parent[_parent[v]];
+      v = _parent[v];
+    }
+    return v;
+  }
+
+  /// returns true if a and b were in different sets
+  bool unite(cgsize_t a, cgsize_t b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) {
+      return false;
+    }
+    _parent[std::max(a, b)] = std::min(a, b);
+    return true;
+  }
+
+private:
+  std::vector<cgsize_t> _parent;
+};
+
+/// vertices per index direction, a single entry for unstructured zones
+std::vector<cgsize_t> vertexSize(const zoneV &zone) {
+  return std::visit(
+      overloaded{[](const zoneStructured &z) { return z.nVertex; },
+                 [](const zoneUnstructured &z) {
+                   return std::vector<cgsize_t>{z.nVertex};
+                 }},
+      zone);
+}
+
+/// 0-based linear index of the 1-based vertex p, i fastest
+cgsize_t linear(const std::array<cgsize_t, 3> &p,
+                const std::vector<cgsize_t> &n) {
+  cgsize_t l = 0;
+  for (std::size_t d = n.size(); d-- > 0;) {
+    l = l * n[d] + p[d] - 1;
+  }
+  return l;
+}
+
+/// unite the vertices of all 1-to-1 interfaces, returns the number of matches
+cgsize_t connectInterfaces(const base &base,
+                           const std::vector<cgsize_t> &offsets,
+                           disjointSets &sets) {
+  std::map<std::string, std::size_t> zoneIndex{};
+  for (std::size_t Z = 0; Z < base.zones.size(); ++Z) {
+    zoneIndex.emplace(
+        std::visit([](const auto &z) { return z.name; }, base.zones[Z]), Z);
+  }
+
+  cgsize_t nMatched = 0;
+
+  for (std::size_t Z = 0; Z < base.zones.size(); ++Z) {
+    const auto *zone = std::get_if<zoneStructured>(&base.zones[Z]);
+    if (zone == nullptr) {
+      continue;
+    }
+
+    const std::size_t dim = zone->nVertex.size();
+
+    for (const auto &conn : zone->connectivities) {
+      const auto donor = zoneIndex.find(conn.donorName);
+      if (donor == zoneIndex.end()) {
+        CGNS_TOOLS_WARN("Donor {} of interface {} of Zone {} not found.",
+                        conn.donorName, conn.name, zone->name);
+        continue;
+      }
+
+      const auto nDonor = vertexSize(base.zones[donor->second]);
+      if (nDonor.size() != dim || conn.range.size() != 2 * dim) {
+        CGNS_TOOLS_ERROR("Interface {} of Zone {} does not match its donor.",
+                         conn.name, zone->name);
+        exit(EXIT_FAILURE);
+      }
+
+      // the range may run backwards in any direction
+      std::array<cgsize_t, 3> first = {1, 1, 1};
+      std::array<cgsize_t, 3> count = {1, 1, 1};
+      std::array<cgsize_t, 3> step = {1, 1, 1};
+      for (std::size_t d = 0; d < dim; ++d) {
+        first[d] = conn.range[d];
+        step[d] = conn.range[dim + d] < conn.range[d] ? -1 : 1;
+        count[d] = std::abs(conn.range[dim + d] - conn.range[d]) + 1;
+      }
+
+      std::array<cgsize_t, 3> p{};
+      for (cgsize_t k = 0; k < count[2]; ++k) {
+        p[2] = first[2] + k * step[2];
+        for (cgsize_t j = 0; j < count[1]; ++j) {
+          p[1] = first[1] + j * step[1];
+          for (cgsize_t i = 0; i < count[0]; ++i) {
+            p[0] = first[0] + i * step[0];
+
+            const auto d = conn.donor(p);
+            for (std::size_t x = 0; x < dim; ++x) {
+              if (d[x] < 1 || d[x] > nDonor[x]) {
+                CGNS_TOOLS_ERROR("Interface {} of Zone {} exceeds Zone {}.",
+                                 conn.name, zone->name, conn.donorName);
+                exit(EXIT_FAILURE);
+              }
+            }
+
+            nMatched += sets.unite(offsets[Z] + linear(p, zone->nVertex),
+                                   offsets[donor->second] + linear(d, nDonor));
+          }
+        }
+      }
+    }
+  }
+
+  return nMatched;
+}
+
+/// @brief 0-based vertices on the surface of a structured zone, all
+/// vertices of unstructured zones
+std::vector<cgsize_t> surfaceVertices(const zoneV &zone) {
+  const auto n = vertexSize(zone);
+
+  std::vector<cgsize_t> vertices{};
+
+  if (n.size() == 1) {
+    vertices.resize(n[0]);
+    std::iota(vertices.begin(), vertices.end(), cgsize_t{0});
+    return vertices;
+  }
+
+  const cgsize_t ni = n[0];
+  const cgsize_t nj = n[1];
+  const cgsize_t nk = n.size() == 3 ? n[2] : 1;
+
+  for (cgsize_t k = 0; k < nk; ++k) {
+    for (cgsize_t j = 0; j < nj; ++j) {
+      const bool plane = (nk > 1 && (k == 0 || k == nk - 1)) || j == 0 ||
+                         j == nj - 1;
+      const cgsize_t v = ni * (j + nj * k);
+      if (plane) {
+        for (cgsize_t i = 0; i < ni; ++i) {
+          vertices.push_back(v + i);
+        }
+      } else {
+        vertices.push_back(v);
+        if (ni > 1) {
+          vertices.push_back(v + ni - 1);
+        }
+      }
+    }
+  }
+
+  return vertices;
+}
+
+/// @brief unite all candidate vertices closer than the tolerance, returns the
+/// number of matches. The hash cells have the size of the tolerance, so
+/// matching vertices lie in neighbouring cells.
+cgsize_t weld(const base &base, const std::vector<cgsize_t> &offsets,
+              const numberingOptions &options, disjointSets &sets) {
+  std::vector<cgsize_t> vertex{};
+  std::vector<std::array<double, 3>> xyz{};
+
+  for (std::size_t Z = 0; Z < base.zones.size(); ++Z) {
+    const zone &z = std::visit([](const auto &z) -> const zone & { return z; },
+                               base.zones[Z]);
+    if (z.gridCoordinates.empty()) {
+      continue;
+    }
+
+    const auto local = surfaceVertices(base.zones[Z]);
+    const std::size_t first = vertex.size();
+
+    vertex.resize(first + local.size());
+    xyz.resize(first + local.size(), {0.0, 0.0, 0.0});
+
+    for (std::size_t c = 0; c < local.size(); ++c) {
+      vertex[first + c] = offsets[Z] + local[c];
+    }
+
+    for (const auto &data : z.gridCoordinates.front().dataArrays) {
+      std::visit(
+          [&](const auto &da) {
+            const std::size_t axis = da.name == "CoordinateX"   ? 0
+                                     : da.name == "CoordinateY" ? 1
+                                     : da.name == "CoordinateZ" ? 2
+                                                                : 3;
+            if (axis == 3) {
+              return;
+            }
+            const auto &values = da.data();
+            for (std::size_t c = 0; c < local.size(); ++c) {
+              xyz[first + c][axis] = values[local[c]];
+            }
+          },
+          data);
+    }
+  }
+
+  const std::size_t n = vertex.size();
+
+  CGNS_TOOLS_DEBUG(indent(4, "weld candidates : {}", n));
+
+  using cellKey = std::array<std::int64_t, 3>;
+  std::vector<cellKey> cells(n);
+
+  parallelFor(
+      0, n,
+      [&](const std::size_t c) {
+        for (std::size_t a = 0; a < 3; ++a) {
+          cells[c][a] = static_cast<std::int64_t>(
+              std::floor(xyz[c][a] / options.tolerance));
+        }
+      },
+      options.nThreads);
+
+  std::vector<std::size_t> order(n);
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::sort(order.begin(), order.end(),
+            [&cells](const std::size_t a, const std::size_t b) {
+              return cells[a] < cells[b];
+            });
+
+  std::vector<cellKey> sorted(n);
+  for (std::size_t s = 0; s < n; ++s) {
+    sorted[s] = cells[order[s]];
+  }
+
+  const double tol2 = options.tolerance * options.tolerance;
+
+  // every thread collects the pairs of its block, they are united serially
+  const unsigned nThreads = std::max(options.nThreads, 1u);
+  std::vector<std::vector<std::pair<cgsize_t, cgsize_t>>> pairs(nThreads);
+  std::atomic<unsigned> next = 0;
+
+  parallelForBlocks(
+      0, n,
+      [&](const std::size_t begin, const std::size_t end) {
+        auto &found = pairs[next++];
+
+        for (std::size_t s = begin; s < end; ++s) {
+          const std::size_t c = order[s];
+          cellKey neighbour{};
+
+          for (std::int64_t dx = -1; dx <= 1; ++dx) {
+            for (std::int64_t dy = -1; dy <= 1; ++dy) {
+              for (std::int64_t dz = -1; dz <= 1; ++dz) {
+                neighbour = {sorted[s][0] + dx, sorted[s][1] + dy,
+                             sorted[s][2] + dz};
+
+                auto it = std::lower_bound(sorted.begin(), sorted.end(),
+                                           neighbour);
+                for (; it != sorted.end() && *it == neighbour; ++it) {
+                  const std::size_t o = order[it - sorted.begin()];
+                  if (vertex[o] <= vertex[c]) {
+                    continue;
+                  }
+
+                  double dist2 = 0.0;
+                  for (std::size_t a = 0; a < 3; ++a) {
+                    const double delta = xyz[o][a] - xyz[c][a];
+                    dist2 += delta * delta;
+                  }
+                  if (dist2 <= tol2) {
+                    found.emplace_back(vertex[c], vertex[o]);
+                  }
+                }
+              }
+            }
+          }
+        }
+      },
+      nThreads);
+
+  cgsize_t nMatched = 0;
+  for (const auto &found : pairs) {
+    for (const auto &[a, b] : found) {
+      nMatched += sets.unite(a, b);
+    }
+  }
+
+  return nMatched;
+}
+
+} // namespace
+
+vertexNumbering numberVertices(const base &base,
+                               const numberingOptions &options) {
+  CGNS_TOOLS_INFO(indent(2, "Numbering vertices of Base {}", base.name));
+
+  // first global vertex of every zone
+  std::vector<cgsize_t> offsets(base.zones.size() + 1, 0);
+  for (std::size_t Z = 0; Z < base.zones.size(); ++Z) {
+    offsets[Z + 1] = offsets[Z] + checkedProduct(vertexSize(base.zones[Z]));
+  }
+
+  vertexNumbering numbering{};
+  numbering.nZoneVertex = offsets.back();
+
+  disjointSets sets{static_cast<std::size_t>(numbering.nZoneVertex)};
+
+  const cgsize_t nConnected = connectInterfaces(base, offsets, sets);
+
+  CGNS_TOOLS_DEBUG(indent(4, "matched by interfaces : {}", nConnected));
+
+  const bool incomplete = std::any_of(
+      base.zones.begin(), base.zones.end(), [](const zoneV &zone) {
+        const auto *z = std::get_if<zoneStructured>(&zone);
+        return z == nullptr || z->connectivities.empty();
+      });
+
+  if (options.weld && incomplete && options.tolerance > 0.0) {
+    const cgsize_t nWelded = weld(base, offsets, options, sets);
+    CGNS_TOOLS_DEBUG(indent(4, "matched by welding : {}", nWelded));
+  }
+
+  // the representative is the smallest vertex of a set and numbered first
+  std::vector<cgsize_t> global(static_cast<std::size_t>(numbering.nZoneVertex));
+  for (cgsize_t v = 0; v < numbering.nZoneVertex; ++v) {
+    const cgsize_t r = sets.find(v);
+    global[v] = r == v ? numbering.nVertex++ : global[r];
+  }
+
+  numbering.ids.reserve(base.zones.size());
+  for (std::size_t Z = 0; Z < base.zones.size(); ++Z) {
+    numbering.ids.emplace_back(global.begin() + offsets[Z],
+                               global.begin() + offsets[Z + 1]);
+  }
+
+  CGNS_TOOLS_INFO(indent(4, "{} of {} vertices distinct", numbering.nVertex,
+                         numbering.nZoneVertex));
+
+  return numbering;
+}
+
+} // namespace cgns_tools
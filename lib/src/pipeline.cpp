@@ -0,0 +1,90 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "../include/pipeline.hpp"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../include/logger.hpp"
+#include "spdlog/spdlog.h"
+
+namespace cgns_tools {
+
+void copyPipelined(const std::string &in, const std::string &out,
+                   const zoneTransform &transform,
+                   const pipelineOptions &options) {
+  const auto start = std::chrono::steady_clock::now();
+
+  // an arena per parse would hold every zone read until the copy ends, the
+  // zones are read into the heap and freed once written
+  parseOptions readOptions = options.read;
+  if (!readOptions.memory) {
+    readOptions.useArena = false;
+  }
+
+  const auto fIn = std::make_shared<fileIn>(in, readOptions);
+  const fileOut fOut{out, options.write};
+
+  // base headers and families are small, they are copied upfront so that the
+  // zones can be written as they arrive
+  const int nbases = fIn->nBases();
+  std::vector<int> bases{};
+  bases.reserve(nbases);
+
+  for (int B = 1; B <= nbases; ++B) {
+    const base header = fIn->readBaseHeader(B);
+    const int BOut = fOut.writeBaseHeader(header);
+
+    for (const auto &family : header.families) {
+      fOut.writeFamilyDefinition(BOut, family);
+    }
+
+    bases.emplace_back(BOut);
+  }
+
+  struct item {
+    int B;
+    zoneV zone;
+  };
+
+  boundedQueue<item> read{options.depth};
+  boundedQueue<item> transformed{options.depth};
+
+  std::thread reader{[&]() {
+    for (int B = 1; B <= nbases; ++B) {
+      const int nzones = fIn->nZones(B);
+      for (int Z = 1; Z <= nzones; ++Z) {
+        read.push({bases[B - 1], fIn->readZone(B, Z)});
+      }
+    }
+    read.close();
+  }};
+
+  std::thread transformer{[&]() {
+    while (auto i = read.pop()) {
+      transformed.push({i->B, transform(std::move(i->zone))});
+    }
+    transformed.close();
+  }};
+
+  // the writing stage runs on the calling thread
+  std::size_t nzones = 0;
+  while (auto i = transformed.pop()) {
+    fOut.writeZoneInformation(i->B, i->zone);
+    ++nzones;
+  }
+
+  reader.join();
+  transformer.join();
+
+  const std::chrono::duration<double, std::milli> time =
+      std::chrono::steady_clock::now() - start;
+
+  CGNS_TOOLS_INFO("Copied {} zones from {} to {} in {:.3f} ms (depth {})",
+                  nzones, in, out, time.count(), options.depth);
+}
+
+} // namespace cgns_tools
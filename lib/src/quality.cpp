@@ -0,0 +1,453 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "../include/quality.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "../include/geometry.hpp"
+#include "../include/logger.hpp"
+#include "../include/tiles.hpp"
+#include "spdlog/spdlog.h"
+
+namespace cgns_tools {
+
+histogram::histogram(const double lower, const double upper,
+                     const unsigned nBins)
+    : lower{lower}, upper{upper}, bins(std::max(nBins, 1u), 0),
+      min{std::numeric_limits<double>::max()},
+      max{std::numeric_limits<double>::lowest()} {}
+
+void histogram::add(const double value) {
+  const double n = static_cast<double>(bins.size());
+  const double f = (value - lower) / (upper - lower) * n;
+
+  // out of range and non-finite values end up in the outer bins
+  std::size_t b = 0;
+  if (!(f < n)) {
+    b = bins.size() - 1;
+  } else if (f > 0.0) {
+    b = static_cast<std::size_t>(f);
+  }
+  ++bins[b];
+
+  min = std::min(min, value);
+  max = std::max(max, value);
+  sum += value;
+  ++count;
+}
+
+void histogram::merge(const histogram &other) {
+  for (std::size_t b = 0; b < bins.size(); ++b) {
+    bins[b] += other.bins[b];
+  }
+  min = std::min(min, other.min);
+  max = std::max(max, other.max);
+  sum += other.sum;
+  count += other.count;
+}
+
+std::ostream &operator<<(std::ostream &out, const histogram &h) {
+  if (h.count == 0) {
+    out << "    Count : 0" << std::endl;
+    return out;
+  }
+
+  out << "    Count : " << h.count << "\n"
+      << "    Min : " << h.min << "\n"
+      << "    Max : " << h.max << "\n"
+      << "    Mean : " << h.mean() << "\n";
+
+  const double width = (h.upper - h.lower) / h.bins.size();
+  for (std::size_t b = 0; b < h.bins.size(); ++b) {
+    out << "    [" << h.lower + b * width << ", " << h.lower + (b + 1) * width
+        << ") : " << h.bins[b] << "\n";
+  }
+  out << std::flush;
+
+  return out;
+}
+
+zoneQuality::zoneQuality(const qualityOptions &options)
+    : skewness{0.0, 1.0, options.nBins},
+      aspectRatio{1.0, options.maxAspectRatio, options.nBins},
+      growthRate{1.0, options.maxGrowthRate, options.nBins} {}
+
+void zoneQuality::merge(const zoneQuality &other) {
+  nCell += other.nCell;
+  nNegativeJacobian += other.nNegativeJacobian;
+  skewness.merge(other.skewness);
+  aspectRatio.merge(other.aspectRatio);
+  growthRate.merge(other.growthRate);
+}
+
+std::ostream &operator<<(std::ostream &out, const zoneQuality &q) {
+  out << "ZoneQuality :\n"
+      << "  Name : " << q.name << "\n"
+      << "  Base : " << q.B << "\n"
+      << "  Zone : " << q.Z << "\n"
+      << "  nCell : " << q.nCell << "\n"
+      << "  nNegativeJacobian : " << q.nNegativeJacobian << "\n"
+      << "  Skewness :\n"
+      << q.skewness << "  AspectRatio :\n"
+      << q.aspectRatio << "  GrowthRate :\n"
+      << q.growthRate;
+
+  return out;
+}
+
+namespace {
+
+using vec = std::array<double, 3>;
+
+double dot(const vec &a, const vec &b) {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+vec cross(const vec &a, const vec &b) {
+  return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2],
+          a[0] * b[1] - a[1] * b[0]};
+}
+
+/// @brief vertices of a part of a 3d structured zone. Only the first nOwned
+/// cells per direction are evaluated, the others are neighbours only.
+template <typename T> struct cellBlock {
+  std::array<std::size_t, 3> nVertex;
+  std::array<std::size_t, 3> nOwned;
+  const T *x;
+  const T *y;
+  const T *z;
+};
+
+/// add the owned cells of the k-layers [kFirst, kLast) to q
+template <typename T>
+void accumulate(const cellBlock<T> &block, const std::vector<T> &volume,
+                const std::size_t kFirst, const std::size_t kLast,
+                zoneQuality &q) {
+  const std::size_t sj = block.nVertex[0];
+  const std::size_t sk = block.nVertex[0] * block.nVertex[1];
+
+  const std::array<std::size_t, 3> nCell = {
+      block.nVertex[0] - 1, block.nVertex[1] - 1, block.nVertex[2] - 1};
+
+  constexpr double rightAngle = 90.0;
+  constexpr double degree = 180.0 / 3.14159265358979323846;
+
+  for (std::size_t k = kFirst; k < kLast; ++k) {
+    for (std::size_t j = 0; j < block.nOwned[1]; ++j) {
+      for (std::size_t i = 0; i < block.nOwned[0]; ++i) {
+        const std::size_t v = i + sj * j + sk * k;
+
+        std::array<vec, 8> p;
+        for (unsigned c = 0; c < 8; ++c) {
+          const std::size_t o = (c & 1) + (c >> 1 & 1) * sj + (c >> 2 & 1) * sk;
+          p[c] = {static_cast<double>(block.x[v + o]),
+                  static_cast<double>(block.y[v + o]),
+                  static_cast<double>(block.z[v + o])};
+        }
+
+        std::array<double, 3> length = {0.0, 0.0, 0.0};
+        double minDet = std::numeric_limits<double>::max();
+        double minCos = 1.0;
+        double maxCos = -1.0;
+
+        for (unsigned c = 0; c < 8; ++c) {
+          // edges leaving the corner, oriented in positive index direction
+          std::array<vec, 3> e;
+          std::array<double, 3> norm;
+          for (unsigned d = 0; d < 3; ++d) {
+            const unsigned bit = 1u << d;
+            const double sign = (c & bit) ? -1.0 : 1.0;
+            for (unsigned x = 0; x < 3; ++x) {
+              e[d][x] = sign * (p[c ^ bit][x] - p[c][x]);
+            }
+            norm[d] = std::sqrt(dot(e[d], e[d]));
+            length[d] += norm[d];
+          }
+
+          minDet = std::min(minDet, dot(e[0], cross(e[1], e[2])));
+
+          for (unsigned d = 0; d < 3; ++d) {
+            const unsigned a = d;
+            const unsigned b = (d + 1) % 3;
+            const double cosine =
+                std::clamp(dot(e[a], e[b]) / (norm[a] * norm[b]), -1.0, 1.0);
+            minCos = std::min(minCos, cosine);
+            maxCos = std::max(maxCos, cosine);
+          }
+        }
+
+        const double minAngle = std::acos(maxCos) * degree;
+        const double maxAngle = std::acos(minCos) * degree;
+        q.skewness.add(std::max(maxAngle - rightAngle, rightAngle - minAngle) /
+                       rightAngle);
+
+        q.aspectRatio.add(*std::max_element(length.begin(), length.end()) /
+                          *std::min_element(length.begin(), length.end()));
+
+        if (minDet < 0.0) {
+          ++q.nNegativeJacobian;
+        }
+
+        // volume ratio to the next cell in each direction
+        const std::array<std::size_t, 3> index = {i, j, k};
+        const std::array<std::size_t, 3> stride = {1, nCell[0],
+                                                   nCell[0] * nCell[1]};
+        const std::size_t cell = i + stride[1] * j + stride[2] * k;
+        const double vol = std::abs(static_cast<double>(volume[cell]));
+
+        std::optional<double> growth{};
+        for (unsigned d = 0; d < 3; ++d) {
+          if (index[d] + 1 >= nCell[d]) {
+            continue;
+          }
+          const double next =
+              std::abs(static_cast<double>(volume[cell + stride[d]]));
+          const double ratio = std::max(vol, next) / std::min(vol, next);
+          growth = std::max(growth.value_or(ratio), ratio);
+        }
+        if (growth) {
+          q.growthRate.add(*growth);
+        }
+
+        ++q.nCell;
+      }
+    }
+  }
+}
+
+/// @brief add the owned cells of a block to q. The k-layers are split over
+/// nThreads, each with its own accumulator merged at the end.
+template <typename T>
+void evaluate(const cellBlock<T> &block, const qualityOptions &options,
+              const unsigned nThreads, zoneQuality &q) {
+  const std::size_t nk = block.nOwned[2];
+  if (nk == 0 || block.nOwned[0] == 0 || block.nOwned[1] == 0) {
+    return;
+  }
+
+  const auto metrics = computeMetrics<T>(
+      {static_cast<cgsize_t>(block.nVertex[0]),
+       static_cast<cgsize_t>(block.nVertex[1]),
+       static_cast<cgsize_t>(block.nVertex[2])},
+      block.x, block.y, block.z, {false, nThreads});
+
+  const std::size_t nBlocks = std::min<std::size_t>(std::max(nThreads, 1u), nk);
+  std::vector<zoneQuality> partial(nBlocks, zoneQuality{options});
+
+  parallelFor(
+      0, nBlocks,
+      [&](const std::size_t b) {
+        accumulate(block, metrics.volume, nk * b / nBlocks,
+                   nk * (b + 1) / nBlocks, partial[b]);
+      },
+      nThreads);
+
+  for (const auto &p : partial) {
+    q.merge(p);
+  }
+}
+
+/// @brief run fn(task, nThreads) for all tasks, distributed dynamically over
+/// the workers. Remaining threads are used within the tasks.
+template <typename F>
+void forEachZone(const std::size_t nTasks, const unsigned nThreads, F &&fn) {
+  if (nTasks == 0) {
+    return;
+  }
+
+  const unsigned nWorkers =
+      std::min<unsigned>(std::max(nThreads, 1u), static_cast<unsigned>(nTasks));
+  const unsigned nInner = std::max(nThreads / nWorkers, 1u);
+
+  std::atomic<std::size_t> next = 0;
+
+  parallelForBlocks(
+      0, nWorkers,
+      [&](std::size_t, std::size_t) {
+        for (std::size_t t = next++; t < nTasks; t = next++) {
+          fn(t, nInner);
+        }
+      },
+      nWorkers);
+}
+
+/// index of each of CoordinateX, CoordinateY, CoordinateZ in names
+std::array<std::size_t, 3>
+coordinateIndices(const std::vector<std::string> &names,
+                  const std::string &zonename) {
+  const std::array<std::string, 3> required = {"CoordinateX", "CoordinateY",
+                                               "CoordinateZ"};
+
+  std::array<std::size_t, 3> indices{};
+  for (std::size_t d = 0; d < 3; ++d) {
+    const auto it = std::find(names.begin(), names.end(), required[d]);
+    if (it == names.end()) {
+      CGNS_TOOLS_ERROR("{} missing in Zone {}.", required[d], zonename);
+      exit(EXIT_FAILURE);
+    }
+    indices[d] = static_cast<std::size_t>(it - names.begin());
+  }
+  return indices;
+}
+
+} // namespace
+
+std::vector<zoneQuality> quality(const root &r,
+                                 const qualityOptions &options) {
+  struct task {
+    int B;
+    int Z;
+    const zoneStructured *zone;
+  };
+
+  std::vector<task> tasks{};
+  for (std::size_t b = 0; b < r.bases.size(); ++b) {
+    const auto &zones = r.bases[b].zones;
+    for (std::size_t z = 0; z < zones.size(); ++z) {
+      const auto *zone = std::get_if<zoneStructured>(&zones[z]);
+      if (!zone || zone->indexDimension() != 3 ||
+          zone->gridCoordinates.empty()) {
+        CGNS_TOOLS_WARN(
+            "Skipping Zone {}, not a 3d structured zone.",
+            std::visit([](const auto &z) { return z.name; }, zones[z]));
+        continue;
+      }
+      tasks.push_back(
+          {static_cast<int>(b) + 1, static_cast<int>(z) + 1, zone});
+    }
+  }
+
+  std::vector<zoneQuality> result(tasks.size(), zoneQuality{options});
+
+  forEachZone(tasks.size(), options.nThreads,
+              [&](const std::size_t t, const unsigned nThreads) {
+                const auto &zone = *tasks[t].zone;
+                auto &q = result[t];
+                q.name = zone.name;
+                q.B = tasks[t].B;
+                q.Z = tasks[t].Z;
+
+                CGNS_TOOLS_INFO(
+                    indent(2, "Evaluating quality of Zone {}", zone.name));
+
+                const auto &arrays = zone.gridCoordinates.front().dataArrays;
+
+                std::vector<std::string> names{};
+                for (const auto &array : arrays) {
+                  names.push_back(std::visit(
+                      [](const auto &a) { return a.name; }, array));
+                }
+                const auto c = coordinateIndices(names, zone.name);
+
+                std::visit(
+                    [&](const auto &x) {
+                      using T = typename std::decay_t<decltype(x)>::value_type;
+
+                      const auto *y = std::get_if<dataArray<T>>(&arrays[c[1]]);
+                      const auto *z = std::get_if<dataArray<T>>(&arrays[c[2]]);
+                      if (!y || !z) {
+                        CGNS_TOOLS_ERROR("Coordinates of Zone {} differ in "
+                                         "precision.",
+                                         zone.name);
+                        exit(EXIT_FAILURE);
+                      }
+
+                      const std::array<std::size_t, 3> n = {
+                          static_cast<std::size_t>(zone.nVertex[0]),
+                          static_cast<std::size_t>(zone.nVertex[1]),
+                          static_cast<std::size_t>(zone.nVertex[2])};
+
+                      const cellBlock<T> block{
+                          n,
+                          {n[0] - 1, n[1] - 1, n[2] - 1},
+                          x.data().data(),
+                          y->data().data(),
+                          z->data().data()};
+                      evaluate(block, options, nThreads, q);
+                    },
+                    arrays[c[0]]);
+              });
+
+  return result;
+}
+
+std::vector<zoneQuality> quality(const std::string &path,
+                                 const qualityOptions &options) {
+  struct task {
+    int B;
+    int Z;
+    std::string name;
+  };
+
+  std::vector<task> tasks{};
+  {
+    const fileIn file{path};
+    for (int B = 1; B <= file.nBases(); ++B) {
+      for (int Z = 1; Z <= file.nZones(B); ++Z) {
+        auto name = file.readZoneName(B, Z);
+        if (file.readZoneVertexSize(B, Z).size() != 3) {
+          CGNS_TOOLS_WARN("Skipping Zone {}, not a 3d structured zone.", name);
+          continue;
+        }
+        tasks.push_back({B, Z, std::move(name)});
+      }
+    }
+  }
+
+  CGNS_TOOLS_INFO("Evaluating quality of {} Zones of {}", tasks.size(), path);
+
+  std::vector<zoneQuality> result(tasks.size(), zoneQuality{options});
+
+  forEachZone(
+      tasks.size(), options.nThreads,
+      [&](const std::size_t t, const unsigned nThreads) {
+        // each zone is read through its own file handle
+        const fileIn file{path};
+
+        auto &q = result[t];
+        q.name = tasks[t].name;
+        q.B = tasks[t].B;
+        q.Z = tasks[t].Z;
+
+        CGNS_TOOLS_INFO(indent(2, "Evaluating quality of Zone {}", q.name));
+
+        // an overlap of two vertex layers shares one cell layer between
+        // neighbouring tiles, which provides the neighbours for the growth
+        // rate of the last owned cells
+        tileReader<double> reader{file, q.B, q.Z,
+                                  {options.budgetBytes, 2}};
+        const auto c = coordinateIndices(reader.coordinateNames(), q.name);
+
+        for (const auto tile : reader) {
+          const auto &range = tile.range;
+
+          cellBlock<double> block{};
+          for (std::size_t d = 0; d < 3; ++d) {
+            const std::size_t extent = range.extent(d);
+            const bool last = range.rangeMax[d] == reader.nVertex()[d];
+            block.nVertex[d] = extent;
+            block.nOwned[d] = last ? extent - 1 : extent - 2;
+          }
+          block.x = tile.coordinates[c[0]].data();
+          block.y = tile.coordinates[c[1]].data();
+          block.z = tile.coordinates[c[2]].data();
+
+          evaluate(block, options, nThreads, q);
+        }
+      });
+
+  return result;
+}
+
+} // namespace cgns_tools
@@ -0,0 +1,84 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "../include/snapshots.hpp"
+
+#include <cgnslib.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <type_traits>
+#include <vector>
+
+#include "../include/logger.hpp"
+#include "spdlog/spdlog.h"
+
+namespace cgns_tools {
+
+template <typename T>
+gridStream<T>::gridStream(const fileIn &file, const int B, const int Z,
+                          const bool delta)
+    : _file{file}, _B{B}, _Z{Z}, _delta{delta}, _nGrids{file.nGrids(B, Z)} {
+  _length = checkedProduct(file.readZoneVertexSize(B, Z));
+
+  if (_nGrids > 0) {
+    for (auto &[name, datatype] : file.readGridArrayInfo(B, Z, 1)) {
+      _names.emplace_back(std::move(name));
+    }
+  }
+
+  _buffers.resize(_names.size());
+  for (auto &buffer : _buffers) {
+    buffer.resize(_length);
+  }
+
+  CGNS_TOOLS_DEBUG(indent(6, "ngrids : {}", _nGrids));
+
+  if (_delta && _nGrids > 0) {
+    this->read(1);
+    _reference = _buffers;
+  }
+}
+
+template <typename T>
+typename gridStream<T>::snapshot gridStream<T>::read(const int G) {
+  const DataType_t memType =
+      std::is_same_v<T, float> ? RealSingle : RealDouble;
+
+  _name = _file.readGridName(_B, _Z, G);
+
+  CGNS_TOOLS_INFO(indent(6, "Reading Grid {} ({}) of Zone {} of Base {}", G,
+                         _name, _Z, _B));
+
+  const auto arrays = _file.readGridArrayInfo(_B, _Z, G);
+
+  // match the arrays by name, the order may differ between grids
+  for (std::size_t c = 0; c < _names.size(); ++c) {
+    const auto it =
+        std::find_if(arrays.begin(), arrays.end(),
+                     [&](const auto &a) { return a.first == _names[c]; });
+
+    if (it == arrays.end()) {
+      CGNS_TOOLS_ERROR("Coordinate {} missing in Grid {} of Zone {} Block {}.",
+                       _names[c], G, _Z, _B);
+      exit(EXIT_FAILURE);
+    }
+
+    const int A = static_cast<int>(it - arrays.begin()) + 1;
+    _file.readGridArray(_B, _Z, G, A, memType, _length, _buffers[c].data());
+
+    if (_delta && G > 1) {
+      std::transform(_buffers[c].begin(), _buffers[c].end(),
+                     _reference[c].begin(), _buffers[c].begin(),
+                     [](const T x, const T x0) { return x - x0; });
+    }
+  }
+
+  return {G, _name, _buffers};
+}
+
+template class gridStream<float>;
+template class gridStream<double>;
+
+} // namespace cgns_tools
@@ -0,0 +1,698 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "../include/split.hpp"
+
+#include <cgnslib.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <queue>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "../include/logger.hpp"
+#include "spdlog/spdlog.h"
+
+namespace cgns_tools {
+
+namespace {
+
+using index3 = std::array<cgsize_t, 3>;
+
+/// 1-based inclusive index box, unused directions are [1, 1]
+struct box {
+  index3 min = {1, 1, 1};
+  index3 max = {1, 1, 1};
+};
+
+/// box spanned by two corners in any order
+box boxOf(const index3 &a, const index3 &b) {
+  box result{};
+  for (std::size_t x = 0; x < 3; ++x) {
+    result.min[x] = std::min(a[x], b[x]);
+    result.max[x] = std::max(a[x], b[x]);
+  }
+  return result;
+}
+
+/// @brief intersection of two boxes, false if it has no extent in a
+/// direction other than skip
+bool intersect(const box &a, const box &b, const unsigned dim,
+               const unsigned skip, box &result) {
+  for (unsigned x = 0; x < 3; ++x) {
+    result.min[x] = std::max(a.min[x], b.min[x]);
+    result.max[x] = std::min(a.max[x], b.max[x]);
+    if (result.max[x] < result.min[x]) {
+      return false;
+    }
+    if (x < dim && x != skip && result.max[x] == result.min[x]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// cell block of a zone, 0-based half open cell ranges
+struct piece {
+  index3 lo = {0, 0, 0};
+  index3 hi = {1, 1, 1};
+
+  std::string name;
+
+  cgsize_t nCells() const {
+    return (hi[0] - lo[0]) * (hi[1] - lo[1]) * (hi[2] - lo[2]);
+  }
+
+  /// vertices of the block
+  box vertices(const unsigned dim) const {
+    box b{};
+    for (unsigned x = 0; x < dim; ++x) {
+      b.min[x] = lo[x] + 1;
+      b.max[x] = hi[x] + 1;
+    }
+    return b;
+  }
+
+  /// cells of the block
+  box cells(const unsigned dim) const {
+    box b{};
+    for (unsigned x = 0; x < dim; ++x) {
+      b.min[x] = lo[x] + 1;
+      b.max[x] = hi[x];
+    }
+    return b;
+  }
+};
+
+/// @brief bisect the cells [lo, hi) along the longest direction until the
+/// blocks hold at most target cells. The cut divides the cells in proportion
+/// to the number of blocks of each side.
+void bisect(const index3 &lo, const index3 &hi, const unsigned dim,
+            const cgsize_t target, const cgsize_t minCells,
+            std::vector<piece> &pieces) {
+  cgsize_t cells = 1;
+  unsigned d = dim;
+  cgsize_t longest = 0;
+  for (unsigned x = 0; x < dim; ++x) {
+    const cgsize_t extent = hi[x] - lo[x];
+    cells *= extent;
+    if (extent >= 2 * minCells && extent > longest) {
+      d = x;
+      longest = extent;
+    }
+  }
+
+  if (cells <= target || d == dim) {
+    pieces.push_back({lo, hi, ""});
+    return;
+  }
+
+  const cgsize_t n = (cells + target - 1) / target;
+  const cgsize_t cut =
+      std::clamp(lo[d] + (longest * (n / 2) + n / 2) / n, lo[d] + minCells,
+                 hi[d] - minCells);
+
+  index3 mid = hi;
+  mid[d] = cut;
+  bisect(lo, mid, dim, target, minCells, pieces);
+
+  mid = lo;
+  mid[d] = cut;
+  bisect(mid, hi, dim, target, minCells, pieces);
+}
+
+/// index extents of an array in all three directions
+index3 extents(const std::vector<cgsize_t> &n) {
+  index3 e = {1, 1, 1};
+  std::copy(n.begin(), n.end(), e.begin());
+  return e;
+}
+
+/// copy the box b of an array with extents n (i fastest) to dst
+template <typename T>
+void slice(const T *src, const index3 &n, const box &b, T *dst) {
+  for (cgsize_t k = b.min[2]; k <= b.max[2]; ++k) {
+    for (cgsize_t j = b.min[1]; j <= b.max[1]; ++j) {
+      const T *row = src + (b.min[0] - 1) + n[0] * ((j - 1) + n[1] * (k - 1));
+      dst = std::copy(row, row + (b.max[0] - b.min[0] + 1), dst);
+    }
+  }
+}
+
+/// number of entries of a box
+std::size_t entries(const box &b) {
+  std::size_t n = 1;
+  for (std::size_t x = 0; x < 3; ++x) {
+    n *= static_cast<std::size_t>(b.max[x] - b.min[x] + 1);
+  }
+  return n;
+}
+
+/// arrays of a piece, coordinates of grid G or fields of solution S
+enum class arrayKind { coordinate, field };
+
+/// @brief creates the array of a piece holding the box of a zone array,
+/// (kind, G or S (0-based), zone array, extents of the zone array, box) ->
+/// piece array
+using arrayFactory =
+    std::function<dataArrayV(const arrayKind, const std::size_t,
+                             const dataArrayV &, const index3 &, const box &)>;
+
+/// donor of point p through the interface, unused directions are 1
+index3 donorOf(const connectivity1to1 &conn, const index3 &p,
+               const unsigned dim) {
+  index3 d = conn.donor(p);
+  for (unsigned x = dim; x < 3; ++x) {
+    d[x] = 1;
+  }
+  return d;
+}
+
+/// interface with zone and donor exchanged
+connectivity1to1 reversed(const connectivity1to1 &conn) {
+  std::vector<int> transform(conn.transform.size());
+  for (std::size_t j = 0; j < conn.transform.size(); ++j) {
+    const int t = conn.transform[j];
+    transform[std::abs(t) - 1] = (t > 0 ? 1 : -1) * static_cast<int>(j + 1);
+  }
+  return {std::string{conn.name}, std::string{conn.donorName},
+          std::vector<cgsize_t>{conn.donorRange},
+          std::vector<cgsize_t>{conn.range}, std::move(transform)};
+}
+
+/// pieces of a structured zone of a base
+struct zonePieces {
+  unsigned dim = 0;
+  std::vector<piece> pieces;
+};
+
+/// index range of a box relative to a piece as stored in the cgns file
+std::vector<cgsize_t> localRange(const index3 &a, const index3 &b,
+                                 const box &vertices, const unsigned dim) {
+  std::vector<cgsize_t> range(2 * dim);
+  for (unsigned x = 0; x < dim; ++x) {
+    range[x] = a[x] - vertices.min[x] + 1;
+    range[dim + x] = b[x] - vertices.min[x] + 1;
+  }
+  return range;
+}
+
+/// @brief interfaces of piece p of a zone: the parts of the interfaces of the
+/// zone and the cut planes shared with the other pieces
+std::vector<connectivity1to1>
+pieceInterfaces(const zoneStructured &zone, const std::size_t p,
+                const std::map<std::string, zonePieces> &split) {
+  const auto &own = split.at(zone.name);
+  const unsigned dim = own.dim;
+  const piece &a = own.pieces[p];
+  const box va = a.vertices(dim);
+
+  std::vector<int> identity(dim);
+  for (unsigned x = 0; x < dim; ++x) {
+    identity[x] = static_cast<int>(x + 1);
+  }
+
+  std::vector<connectivity1to1> interfaces{};
+
+  // cut planes shared with the other pieces of the zone
+  for (std::size_t q = 0; q < own.pieces.size(); ++q) {
+    const piece &b = own.pieces[q];
+    for (unsigned d = 0; d < dim; ++d) {
+      if (a.hi[d] != b.lo[d] && a.lo[d] != b.hi[d]) {
+        continue;
+      }
+      box plane = va;
+      plane.min[d] = plane.max[d] = a.hi[d] == b.lo[d] ? va.max[d] : va.min[d];
+
+      box shared{};
+      if (!intersect(plane, b.vertices(dim), dim, d, shared)) {
+        continue;
+      }
+
+      interfaces.emplace_back(
+          fmt::format("Split{}_{}", p + 1, q + 1), std::string{b.name},
+          localRange(shared.min, shared.max, va, dim),
+          localRange(shared.min, shared.max, b.vertices(dim), dim),
+          std::vector<int>{identity});
+    }
+  }
+
+  // parts of the interfaces of the zone
+  for (const auto &conn : zone.connectivities) {
+    const auto donor = split.find(conn.donorName);
+    if (donor == split.end() || donor->second.dim != dim ||
+        conn.range.size() != 2 * dim || conn.transform.size() != dim) {
+      CGNS_TOOLS_WARN("Interface {} of Zone {}: donor {} is not a structured "
+                      "zone, dropped.",
+                      conn.name, zone.name, conn.donorName);
+      continue;
+    }
+
+    index3 begin = {1, 1, 1};
+    index3 end = {1, 1, 1};
+    for (unsigned x = 0; x < dim; ++x) {
+      begin[x] = conn.range[x];
+      end[x] = conn.range[dim + x];
+    }
+    const box range = boxOf(begin, end);
+
+    unsigned c = dim;
+    for (unsigned x = dim; x-- > 0;) {
+      if (range.min[x] == range.max[x]) {
+        c = x;
+      }
+    }
+
+    box part{};
+    if (c == dim || !intersect(range, va, dim, c, part)) {
+      continue;
+    }
+
+    const auto back = reversed(conn);
+    const unsigned k = std::abs(conn.transform[c]) - 1;
+    const box donorPart = boxOf(donorOf(conn, part.min, dim),
+                                donorOf(conn, part.max, dim));
+
+    std::vector<connectivity1to1> parts{};
+    for (const auto &b : donor->second.pieces) {
+      const box vb = b.vertices(dim);
+
+      box shared{};
+      if (!intersect(donorPart, vb, dim, k, shared)) {
+        continue;
+      }
+
+      const box matched = boxOf(donorOf(back, shared.min, dim),
+                                donorOf(back, shared.max, dim));
+
+      parts.emplace_back(
+          std::string{conn.name}, std::string{b.name},
+          localRange(matched.min, matched.max, va, dim),
+          localRange(donorOf(conn, matched.min, dim),
+                     donorOf(conn, matched.max, dim), vb, dim),
+          std::vector<int>{conn.transform});
+    }
+
+    // the names of the interfaces of a zone are unique
+    for (std::size_t n = 0; parts.size() > 1 && n < parts.size(); ++n) {
+      parts[n].name =
+          fmt::format("{}_{}", conn.name.substr(0, 24), n + 1);
+    }
+    std::move(parts.begin(), parts.end(), std::back_inserter(interfaces));
+  }
+
+  return interfaces;
+}
+
+/// BCs of a zone restricted to piece p, indices relative to the piece
+std::vector<boundaryCondition> pieceBCs(const zoneStructured &zone,
+                                        const piece &p, const unsigned dim) {
+  std::vector<boundaryCondition> bcs{};
+
+  const box vertices = p.vertices(dim);
+
+  for (const auto &bc : zone.boundaryConditions) {
+    std::vector<cgsize_t> points{};
+
+    if (bc.pointSet == PointRange && bc.points.size() == 2 * dim) {
+      index3 begin = {1, 1, 1};
+      index3 end = {1, 1, 1};
+      for (unsigned x = 0; x < dim; ++x) {
+        begin[x] = bc.points[x];
+        end[x] = bc.points[dim + x];
+      }
+      const box range = boxOf(begin, end);
+
+      // faces of a face centred range are indexed like cells in the plane
+      box region = vertices;
+      unsigned normal = dim;
+      if (bc.location == IFaceCenter || bc.location == JFaceCenter ||
+          bc.location == KFaceCenter) {
+        normal = static_cast<unsigned>(bc.location - IFaceCenter);
+        region = p.cells(dim);
+        region.min[normal] = vertices.min[normal];
+        region.max[normal] = vertices.max[normal];
+      } else if (bc.location == Vertex) {
+        for (unsigned x = dim; x-- > 0;) {
+          if (range.min[x] == range.max[x]) {
+            normal = x;
+          }
+        }
+      } else {
+        CGNS_TOOLS_WARN("BC {} of Zone {} at {} can not be split, dropped.",
+                        bc.name, zone.name, cg_GridLocationName(bc.location));
+        continue;
+      }
+
+      // face ranges are inclusive in the plane, single faces are valid
+      box part{};
+      if (!intersect(range, region, bc.location == Vertex ? dim : 0, normal,
+                     part)) {
+        continue;
+      }
+      points = localRange(part.min, part.max, vertices, dim);
+    } else if (bc.pointSet == PointList && bc.location == Vertex) {
+      for (std::size_t i = 0; i + dim <= bc.points.size(); i += dim) {
+        bool inside = true;
+        for (unsigned x = 0; x < dim; ++x) {
+          inside &= bc.points[i + x] >= vertices.min[x] &&
+                    bc.points[i + x] <= vertices.max[x];
+        }
+        for (unsigned x = 0; inside && x < dim; ++x) {
+          points.push_back(bc.points[i + x] - vertices.min[x] + 1);
+        }
+      }
+      if (points.empty()) {
+        continue;
+      }
+    } else {
+      CGNS_TOOLS_WARN("BC {} of Zone {} can not be split, dropped.", bc.name,
+                      zone.name);
+      continue;
+    }
+
+    bcs.emplace_back(std::string{bc.name}, bc.type, bc.pointSet, bc.location,
+                     std::move(points));
+    bcs.back().familyName = bc.familyName;
+  }
+
+  return bcs;
+}
+
+/// the pieces of a zone with their arrays created through make
+std::vector<zoneStructured>
+splitZone(const zoneStructured &zone,
+          const std::map<std::string, zonePieces> &split,
+          const arrayFactory &make) {
+  const auto &own = split.at(zone.name);
+  const unsigned dim = own.dim;
+  const index3 nVertices = extents(zone.nVertex);
+  const index3 nCells = extents(zone.nCell);
+
+  std::vector<zoneStructured> zones{};
+  zones.reserve(own.pieces.size());
+
+  for (std::size_t p = 0; p < own.pieces.size(); ++p) {
+    const piece &pc = own.pieces[p];
+    const box vertices = pc.vertices(dim);
+    const box cells = pc.cells(dim);
+
+    std::vector<cgsize_t> nVertex(dim);
+    std::vector<cgsize_t> nCell(dim);
+    for (unsigned x = 0; x < dim; ++x) {
+      nVertex[x] = pc.hi[x] - pc.lo[x] + 1;
+      nCell[x] = pc.hi[x] - pc.lo[x];
+    }
+
+    std::vector<gridCoordinatesT> grids{};
+    for (std::size_t G = 0; G < zone.gridCoordinates.size(); ++G) {
+      std::vector<gridCoordinateDataV> arrays{};
+      for (const auto &array : zone.gridCoordinates[G].dataArrays) {
+        arrays.emplace_back(
+            make(arrayKind::coordinate, G, array, nVertices, vertices));
+      }
+      grids.emplace_back(std::string{zone.gridCoordinates[G].name},
+                         std::move(arrays));
+    }
+
+    zoneStructured z{std::string{pc.name}, std::move(nVertex),
+                     std::move(nCell), std::vector<cgsize_t>(dim, 0),
+                     std::move(grids)};
+
+    for (std::size_t S = 0; S < zone.flowSolutions.size(); ++S) {
+      const auto &solution = zone.flowSolutions[S];
+      if (solution.location != Vertex && solution.location != CellCenter) {
+        CGNS_TOOLS_WARN("Flow solution {} of Zone {} at {} can not be split, "
+                        "dropped.",
+                        solution.name, zone.name,
+                        cg_GridLocationName(solution.location));
+        continue;
+      }
+
+      std::vector<dataArrayV> fields{};
+      for (const auto &field : solution.fields) {
+        fields.emplace_back(
+            solution.location == Vertex
+                ? make(arrayKind::field, S, field, nVertices, vertices)
+                : make(arrayKind::field, S, field, nCells, cells));
+      }
+      z.flowSolutions.emplace_back(std::string{solution.name},
+                                   solution.location, std::move(fields));
+    }
+
+    z.boundaryConditions = pieceBCs(zone, pc, dim);
+    z.connectivities = pieceInterfaces(zone, p, split);
+    z.familyName = zone.familyName;
+
+    zones.emplace_back(std::move(z));
+  }
+
+  return zones;
+}
+
+/// number of cells of a zone
+cgsize_t cellsOf(const zoneV &zone) {
+  return std::visit(
+      overloaded{
+          [](const zoneStructured &z) { return checkedProduct(z.nCell); },
+          [](const zoneUnstructured &z) { return z.nCell; }},
+      zone);
+}
+
+/// log the load balance of a hierarchy
+void logBalance(const loadBalance &lb) {
+  CGNS_TOOLS_INFO(indent(2, "{} zones on {} ranks, largest zone {} cells, "
+                            "imbalance {:.3f}",
+                         lb.nZones, lb.rankCells.size(), lb.maxZoneCells,
+                         lb.imbalance));
+}
+
+/// @brief split all bases, factory(B, Z) returns the array factory of zone Z
+/// of base B (0-based)
+root splitZones(root &&r, const splitOptions &options,
+                const std::function<arrayFactory(std::size_t, std::size_t)>
+                    &factory) {
+  cgsize_t total = 0;
+  for (const auto &base : r.bases) {
+    for (const auto &zone : base.zones) {
+      total += cellsOf(zone);
+    }
+  }
+
+  const unsigned nRanks = std::max(options.nRanks, 1u);
+  const cgsize_t target =
+      options.maxCells > 0
+          ? options.maxCells
+          : std::max<cgsize_t>(1, (total + nRanks - 1) / nRanks);
+  const cgsize_t minCells = std::max<cgsize_t>(options.minCells, 1);
+
+  CGNS_TOOLS_INFO("Splitting zones to at most {} cells", target);
+  logBalance(balance(r, nRanks));
+
+  for (std::size_t B = 0; B < r.bases.size(); ++B) {
+    auto &base = r.bases[B];
+
+    // pieces of all structured zones, needed to connect the pieces of
+    // neighbouring zones
+    std::map<std::string, zonePieces> split{};
+    for (const auto &zone : base.zones) {
+      const auto *z = std::get_if<zoneStructured>(&zone);
+      if (z == nullptr) {
+        continue;
+      }
+
+      zonePieces pieces{static_cast<unsigned>(z->nCell.size()), {}};
+      index3 hi = {1, 1, 1};
+      std::copy(z->nCell.begin(), z->nCell.end(), hi.begin());
+      bisect({0, 0, 0}, hi, pieces.dim, target, minCells, pieces.pieces);
+
+      const std::size_t digits = std::to_string(pieces.pieces.size()).size();
+      for (std::size_t p = 0; p < pieces.pieces.size(); ++p) {
+        pieces.pieces[p].name =
+            pieces.pieces.size() == 1
+                ? z->name
+                : fmt::format("{}_{}", z->name.substr(0, 31 - digits), p + 1);
+      }
+
+      CGNS_TOOLS_DEBUG(indent(4, "{} : {} pieces", z->name,
+                              pieces.pieces.size()));
+
+      split.emplace(z->name, std::move(pieces));
+    }
+
+    std::vector<zoneV> zones{};
+    for (std::size_t Z = 0; Z < base.zones.size(); ++Z) {
+      auto &zone = base.zones[Z];
+      if (const auto *z = std::get_if<zoneStructured>(&zone)) {
+        for (auto &p : splitZone(*z, split, factory(B, Z))) {
+          zones.emplace_back(std::move(p));
+        }
+      } else {
+        zones.emplace_back(std::move(zone));
+      }
+      // the arrays of the original zone are not needed any more
+      zone = zoneUnstructured{"", 0, 0, 0, {}};
+    }
+
+    base.zones = std::move(zones);
+  }
+
+  logBalance(balance(r, nRanks));
+
+  return std::move(r);
+}
+
+} // namespace
+
+loadBalance balance(const root &r, const unsigned nRanks) {
+  loadBalance lb{};
+
+  std::vector<cgsize_t> cells{};
+  for (const auto &base : r.bases) {
+    for (const auto &zone : base.zones) {
+      cells.push_back(cellsOf(zone));
+    }
+  }
+  std::sort(cells.begin(), cells.end(), std::greater<>{});
+
+  lb.nZones = cells.size();
+  lb.maxZoneCells = cells.empty() ? 0 : cells.front();
+  lb.rankCells.assign(std::max(nRanks, 1u), 0);
+
+  // largest zone first to the rank with the fewest cells
+  using load = std::pair<cgsize_t, std::size_t>;
+  std::priority_queue<load, std::vector<load>, std::greater<>> ranks{};
+  for (std::size_t rank = 0; rank < lb.rankCells.size(); ++rank) {
+    ranks.emplace(0, rank);
+  }
+  for (const auto c : cells) {
+    auto [n, rank] = ranks.top();
+    ranks.pop();
+    lb.rankCells[rank] = n + c;
+    ranks.emplace(n + c, rank);
+  }
+
+  cgsize_t total = 0;
+  for (const auto c : cells) {
+    total += c;
+  }
+  if (total > 0) {
+    const double mean =
+        static_cast<double>(total) / static_cast<double>(lb.rankCells.size());
+    lb.imbalance =
+        static_cast<double>(
+            *std::max_element(lb.rankCells.begin(), lb.rankCells.end())) /
+        mean;
+  }
+
+  return lb;
+}
+
+std::ostream &operator<<(std::ostream &out, const loadBalance &lb) {
+  out << "LoadBalance :\n"
+      << "  nZones : " << lb.nZones << "\n"
+      << "  maxZoneCells : " << lb.maxZoneCells << "\n"
+      << "  nRanks : " << lb.rankCells.size() << "\n"
+      << "  maxRankCells : "
+      << (lb.rankCells.empty()
+              ? 0
+              : *std::max_element(lb.rankCells.begin(), lb.rankCells.end()))
+      << "\n"
+      << "  imbalance : " << lb.imbalance << std::endl;
+  return out;
+}
+
+root split(root &&r, const splitOptions &options) {
+  // the boxes are copied out of the zone arrays
+  const arrayFactory copy = [](const arrayKind, const std::size_t,
+                               const dataArrayV &array, const index3 &n,
+                               const box &b) -> dataArrayV {
+    return std::visit(
+        [&](const auto &da) -> dataArrayV {
+          using T = typename std::decay_t<decltype(da)>::value_type;
+          buffer<T> data(entries(b));
+          slice(da.data().data(), n, b, data.data());
+          return dataArray<T>{std::string{da.name}, std::move(data)};
+        },
+        array);
+  };
+
+  return splitZones(std::move(r), options,
+                    [&copy](std::size_t, std::size_t) { return copy; });
+}
+
+root split(const std::string &path, const splitOptions &options,
+           const parseOptions &parse) {
+  // the pieces read their arrays lazily as hyperslabs through the file
+  parseOptions lazy = parse;
+  lazy.lazy = true;
+  const auto file = std::make_shared<fileIn>(path, lazy);
+
+  root r{file->readBaseInformation()};
+
+  const auto factory = [&file](const std::size_t B,
+                               const std::size_t Z) -> arrayFactory {
+    return [file, B = static_cast<int>(B + 1), Z = static_cast<int>(Z + 1)](
+               const arrayKind kind, const std::size_t index,
+               const dataArrayV &array, const index3 &,
+               const box &b) -> dataArrayV {
+      return std::visit(
+          [&](const auto &da) -> dataArrayV {
+            using T = typename std::decay_t<decltype(da)>::value_type;
+            const DataType_t type = da.dataType();
+
+            if (kind == arrayKind::coordinate && index > 0) {
+              CGNS_TOOLS_ERROR("Only the first grid of Zone {} of Base {} can "
+                               "be read in pieces.",
+                               Z, B);
+              exit(EXIT_FAILURE);
+            }
+
+            typename dataArray<T>::loader load;
+            if (kind == arrayKind::coordinate) {
+              load = [file, B, Z, b, type, name = da.name](T *ptr) {
+                file->readCoordinates(B, Z, name, type, b.min.data(),
+                                      b.max.data(), ptr);
+              };
+            } else {
+              load = [file, B, Z, S = static_cast<int>(index + 1), b, type,
+                      name = da.name](T *ptr) {
+                file->readField(B, Z, S, name, type, b.min.data(),
+                                b.max.data(), ptr);
+              };
+            }
+
+            return dataArray<T>{std::string{da.name}, entries(b),
+                                std::move(load)};
+          },
+          array);
+    };
+  };
+
+  // only the first grid can be read as hyperslabs
+  for (auto &base : r.bases) {
+    for (auto &zone : base.zones) {
+      if (auto *z = std::get_if<zoneStructured>(&zone);
+          z != nullptr && z->gridCoordinates.size() > 1) {
+        CGNS_TOOLS_WARN("Zone {} has {} grids, only {} is split.", z->name,
+                        z->gridCoordinates.size(),
+                        z->gridCoordinates.front().name);
+        z->gridCoordinates.erase(z->gridCoordinates.begin() + 1,
+                                  z->gridCoordinates.end());
+      }
+    }
+  }
+
+  return splitZones(std::move(r), options, factory);
+}
+
+} // namespace cgns_tools
@@ -0,0 +1,134 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "../include/tiles.hpp"
+
+#include <cgnslib.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <type_traits>
+#include <vector>
+
+#include "../include/logger.hpp"
+#include "spdlog/spdlog.h"
+
+namespace cgns_tools {
+
+template <typename T>
+tileReader<T>::tileReader(const fileIn &file, const int B, const int Z,
+                          const tileOptions &options)
+    : _file{file}, _B{B}, _Z{Z}, _overlap{options.overlap},
+      _nVertex{file.readZoneVertexSize(B, Z)},
+      _names{file.readCoordinateNames(B, Z)} {
+  const std::size_t dim = _nVertex.size();
+
+  if (dim < 2 || dim > 3) {
+    CGNS_TOOLS_ERROR("Tiled reading requires a structured zone "
+                     "(index_dim {}).",
+                     dim);
+    exit(EXIT_FAILURE);
+  }
+
+  std::array<cgsize_t, 3> n = {1, 1, 1};
+  for (std::size_t d = 0; d < dim; ++d) {
+    n[d] = _nVertex[d];
+  }
+
+  const cgsize_t maxVertex = options.budgetBytes /
+                             (std::max<std::size_t>(_names.size(), 1) *
+                              sizeof(T));
+
+  // starting from the slowest direction, reduce the tile extent until the
+  // tile fits into the budget
+  std::array<cgsize_t, 3> extent = n;
+  bool fits = false;
+  for (std::size_t d = dim; d-- > 0;) {
+    cgsize_t inner = 1;
+    for (std::size_t e = 0; e < dim; ++e) {
+      inner *= e == d ? 1 : extent[e];
+    }
+
+    if (inner * n[d] <= maxVertex) {
+      fits = true;
+      break;
+    }
+
+    const cgsize_t step = maxVertex / inner - static_cast<cgsize_t>(_overlap);
+    if (step >= 1) {
+      _step[d] = step;
+      extent[d] = step + _overlap;
+      fits = true;
+      break;
+    }
+
+    _step[d] = 1;
+    extent[d] = std::min<cgsize_t>(1 + _overlap, n[d]);
+  }
+
+  if (!fits) {
+    CGNS_TOOLS_ERROR("Tile budget of {} bytes too small for Zone {} "
+                     "of Base {}.",
+                     options.budgetBytes, Z, B);
+    exit(EXIT_FAILURE);
+  }
+
+  for (std::size_t d = 0; d < 3; ++d) {
+    if (extent[d] >= n[d]) {
+      _step[d] = n[d];
+      _nTiles[d] = 1;
+    } else {
+      const cgsize_t m = n[d] - static_cast<cgsize_t>(_overlap);
+      _nTiles[d] = (m + _step[d] - 1) / _step[d];
+    }
+  }
+
+  _buffers.resize(_names.size());
+  for (auto &buffer : _buffers) {
+    buffer.reserve(extent[0] * extent[1] * extent[2]);
+  }
+
+  CGNS_TOOLS_DEBUG(indent(6, "tiles : [{}]", fmt::join(_nTiles, " , ")));
+  CGNS_TOOLS_DEBUG(indent(6, "tile step : [{}]", fmt::join(_step, " , ")));
+}
+
+template <typename T> tile tileReader<T>::tileAt(const std::size_t n) const {
+  const std::array<std::size_t, 3> t = {n % _nTiles[0],
+                                        n / _nTiles[0] % _nTiles[1],
+                                        n / (_nTiles[0] * _nTiles[1])};
+
+  tile range{};
+  for (std::size_t d = 0; d < _nVertex.size(); ++d) {
+    range.rangeMin[d] = 1 + static_cast<cgsize_t>(t[d]) * _step[d];
+    range.rangeMax[d] =
+        std::min<cgsize_t>(range.rangeMin[d] + _step[d] - 1 + _overlap,
+                           _nVertex[d]);
+  }
+  return range;
+}
+
+template <typename T>
+typename tileReader<T>::tileData tileReader<T>::read(const std::size_t n) {
+  _current = this->tileAt(n);
+
+  const DataType_t memType =
+      std::is_same_v<T, float> ? RealSingle : RealDouble;
+
+  CGNS_TOOLS_DEBUG(
+      indent(6, "Reading tile {} of Zone {} of Base {}", n, _Z, _B));
+
+  for (std::size_t c = 0; c < _names.size(); ++c) {
+    // within the reserved capacity, no reallocation
+    _buffers[c].resize(_current.nVertex());
+    _file.readCoordinates(_B, _Z, _names[c], memType, _current.rangeMin.data(),
+                          _current.rangeMax.data(), _buffers[c].data());
+  }
+
+  return {_current, _buffers};
+}
+
+template class tileReader<float>;
+template class tileReader<double>;
+
+} // namespace cgns_tools
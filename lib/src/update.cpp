@@ -0,0 +1,359 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#include "../include/update.hpp"
+
+#include <cgnslib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "../include/hash.hpp"
+#include "../include/logger.hpp"
+#include "spdlog/spdlog.h"
+
+namespace cgns_tools {
+
+namespace {
+
+/// vertex sizes of a zone in the hierarchy
+std::vector<cgsize_t> vertexSize(const zoneV &zone) {
+  return std::visit(
+      overloaded{[](const zoneStructured &z) { return z.size(); },
+                 [](const zoneUnstructured &z) { return z.size(); }},
+      zone);
+}
+
+/// common part (grids and solutions) of a zone in the hierarchy
+const zone &baseOf(const zoneV &z) {
+  return std::visit([](const auto &z) -> const zone & { return z; }, z);
+}
+
+/// load the coordinate arrays and fields of a zone
+void loadArrays(const zone &z) {
+  const auto load = [](const auto &da) { da.load(); };
+  for (const auto &grid : z.gridCoordinates) {
+    for (const auto &data : grid.dataArrays) {
+      std::visit(load, data);
+    }
+  }
+  for (const auto &solution : z.flowSolutions) {
+    for (const auto &field : solution.fields) {
+      std::visit(load, field);
+    }
+  }
+}
+
+} // namespace
+
+std::ostream &operator<<(std::ostream &out, const updateStats &stats) {
+  out << "Update :\n"
+      << "  nArrays : " << stats.nArrays << "\n"
+      << "  nWritten : " << stats.nWritten << "\n"
+      << "  bytesWritten : " << stats.bytesWritten << "\n"
+      << "  bytesRead : " << stats.bytesRead << std::endl;
+  return out;
+}
+
+fileModify::fileModify(const std::string &path, const updateOptions &options)
+    : file{path, fileMode::modify}, _options{options} {}
+
+template <typename T, typename Read>
+bool fileModify::changed(const int B, const int Z, const char *parentLabel,
+                         const int P, const dataArray<T> &da,
+                         const DataType_t stored, Read &&read) {
+  ++_stats.nArrays;
+
+  if (stored != da.dataType()) {
+    CGNS_TOOLS_DEBUG(indent(10, "{} : data type changed", da.name));
+    return true;
+  }
+
+  if (!da.loaded() && _options.skipUnloaded) {
+    CGNS_TOOLS_DEBUG(indent(10, "{} : not loaded", da.name));
+    return false;
+  }
+
+  const std::size_t bytes = da.size() * sizeof(T);
+  const std::uint64_t hash = contentHash(da.data().data(), bytes);
+
+  std::optional<std::uint64_t> storedHash =
+      this->readContentHash(B, Z, parentLabel, P, da.name);
+
+  if (!storedHash) {
+    std::vector<T> data(da.size());
+    read(data.data());
+    _stats.bytesRead += bytes;
+    storedHash = contentHash(data.data(), bytes);
+
+    if (*storedHash == hash && _options.storeHashes) {
+      this->writeContentHash(B, Z, parentLabel, P, da.name, hash);
+    }
+  }
+
+  CGNS_TOOLS_DEBUG(indent(10, "{} : {:016x} / {:016x}", da.name, hash,
+                          *storedHash));
+
+  return *storedHash != hash;
+}
+
+void fileModify::updateGridCoordinates(const int B, const int Z, const int G,
+                                       const gridCoordinatesT &grid) {
+  int index_dim = 0;
+  cgnsFn<cg_index_dim>(_handle, B, Z, &index_dim);
+
+  char zonename[33];
+  cgsize_t size[9];
+  cgnsFn<cg_zone_read>(_handle, B, Z, zonename, &size[0]);
+
+  const std::vector<cgsize_t> rangeMin(index_dim, 1);
+
+  // names and data types of the stored arrays
+  std::vector<std::pair<std::string, DataType_t>> stored{};
+  {
+    const std::scoped_lock lock{cgnsMutex()};
+    cgnsFn<cg_goto>(_handle, B, "Zone_t", Z, "GridCoordinates_t", G, "end");
+
+    int narrays = 0;
+    cgnsFn<cg_narrays>(&narrays);
+    for (int A = 1; A <= narrays; ++A) {
+      char name[33] = "";
+      DataType_t datatype = DataTypeNull;
+      int data_dim = 0;
+      cgsize_t dims[3] = {};
+      cgnsFn<cg_array_info>(A, name, &datatype, &data_dim, &dims[0]);
+      stored.emplace_back(name, datatype);
+    }
+  }
+
+  for (const auto &data : grid.dataArrays) {
+    std::visit(
+        [&](const auto &da) {
+          using T = typename std::decay_t<decltype(da)>::value_type;
+
+          const auto it =
+              std::find_if(stored.begin(), stored.end(),
+                           [&](const auto &s) { return s.first == da.name; });
+
+          const auto read = [&, A = it - stored.begin() + 1](T *ptr) {
+            if (G == 1) {
+              cgnsFn<cg_coord_read>(_handle, B, Z, da.name.c_str(),
+                                    da.dataType(), rangeMin.data(), &size[0],
+                                    ptr);
+            } else {
+              const std::scoped_lock lock{cgnsMutex()};
+              cgnsFn<cg_goto>(_handle, B, "Zone_t", Z, "GridCoordinates_t", G,
+                              "end");
+              cgnsFn<cg_array_read_as>(static_cast<int>(A), da.dataType(),
+                                       ptr);
+            }
+          };
+
+          if (it != stored.end() &&
+              !this->changed(B, Z, "GridCoordinates_t", G, da, it->second,
+                             read)) {
+            return;
+          }
+
+          CGNS_TOOLS_INFO(indent(8, "Rewriting {} of Grid {} Zone {} Block {}",
+                                 da.name, G, Z, B));
+
+          if (G == 1) {
+            int C = 0;
+            cgnsFn<cg_coord_write>(_handle, B, Z, da.dataType(),
+                                   da.name.c_str(), da.data().data(), &C);
+          } else {
+            const std::scoped_lock lock{cgnsMutex()};
+            cgnsFn<cg_goto>(_handle, B, "Zone_t", Z, "GridCoordinates_t", G,
+                            "end");
+            cgnsFn<cg_array_write>(da.name.c_str(), da.dataType(), index_dim,
+                                   &size[0], da.data().data());
+          }
+
+          if (_options.storeHashes) {
+            this->writeContentHash(
+                B, Z, "GridCoordinates_t", G, da.name,
+                contentHash(da.data().data(), da.size() * sizeof(T)));
+          }
+
+          ++_stats.nWritten;
+          _stats.bytesWritten += da.size() * sizeof(T);
+        },
+        data);
+  }
+}
+
+void fileModify::updateFlowSolution(const int B, const int Z, const int S,
+                                    const flowSolution &solution) {
+  int data_dim = 0;
+  cgsize_t dims[3] = {};
+  cgnsFn<cg_sol_size>(_handle, B, Z, S, &data_dim, &dims[0]);
+
+  const std::vector<cgsize_t> rangeMin(data_dim, 1);
+
+  std::vector<std::pair<std::string, DataType_t>> stored{};
+  int nfields = 0;
+  cgnsFn<cg_nfields>(_handle, B, Z, S, &nfields);
+  for (int F = 1; F <= nfields; ++F) {
+    DataType_t datatype;
+    char fieldname[33] = "";
+    cgnsFn<cg_field_info>(_handle, B, Z, S, F, &datatype, fieldname);
+    stored.emplace_back(fieldname, datatype);
+  }
+
+  for (const auto &field : solution.fields) {
+    std::visit(
+        [&](const auto &da) {
+          using T = typename std::decay_t<decltype(da)>::value_type;
+
+          const auto it =
+              std::find_if(stored.begin(), stored.end(),
+                           [&](const auto &s) { return s.first == da.name; });
+
+          const auto read = [&](T *ptr) {
+            cgnsFn<cg_field_read>(_handle, B, Z, S, da.name.c_str(),
+                                  da.dataType(), rangeMin.data(), &dims[0],
+                                  ptr);
+          };
+
+          if (it != stored.end() &&
+              !this->changed(B, Z, "FlowSolution_t", S, da, it->second, read)) {
+            return;
+          }
+
+          CGNS_TOOLS_INFO(indent(8, "Rewriting {} of Flow Solution {} Zone {} "
+                                    "Block {}",
+                                 da.name, S, Z, B));
+
+          int F = 0;
+          cgnsFn<cg_field_write>(_handle, B, Z, S, da.dataType(),
+                                 da.name.c_str(), da.data().data(), &F);
+
+          if (_options.storeHashes) {
+            this->writeContentHash(
+                B, Z, "FlowSolution_t", S, da.name,
+                contentHash(da.data().data(), da.size() * sizeof(T)));
+          }
+
+          ++_stats.nWritten;
+          _stats.bytesWritten += da.size() * sizeof(T);
+        },
+        field);
+  }
+}
+
+void fileModify::update(const root &r) {
+  int nbases = 0;
+  cgnsFn<cg_nbases>(_handle, &nbases);
+
+  if (static_cast<std::size_t>(nbases) != r.bases.size()) {
+    CGNS_TOOLS_ERROR("File has {} bases, the hierarchy {}.", nbases,
+                     r.bases.size());
+    exit(EXIT_FAILURE);
+  }
+
+  for (int B = 1; B <= nbases; ++B) {
+    const auto &base = r.bases[B - 1];
+
+    int nzones = 0;
+    cgnsFn<cg_nzones>(_handle, B, &nzones);
+
+    if (static_cast<std::size_t>(nzones) != base.zones.size()) {
+      CGNS_TOOLS_ERROR("Base {} has {} zones in the file, {} in the hierarchy.",
+                       B, nzones, base.zones.size());
+      exit(EXIT_FAILURE);
+    }
+
+    for (int Z = 1; Z <= nzones; ++Z) {
+      const auto &zoneVariant = base.zones[Z - 1];
+      const zone &z = baseOf(zoneVariant);
+
+      int index_dim = 0;
+      cgnsFn<cg_index_dim>(_handle, B, Z, &index_dim);
+
+      char zonename[33] = "";
+      cgsize_t size[9];
+      cgnsFn<cg_zone_read>(_handle, B, Z, zonename, &size[0]);
+
+      const std::vector<cgsize_t> stored(&size[0], &size[3 * index_dim]);
+
+      if (z.name != zonename || stored != vertexSize(zoneVariant)) {
+        CGNS_TOOLS_ERROR("Zone {} of Base {} does not match Zone {} of the "
+                         "file.",
+                         z.name, B, zonename);
+        exit(EXIT_FAILURE);
+      }
+
+      CGNS_TOOLS_INFO(indent(4, "Updating Zone {} Block {}", Z, B));
+
+      int ngrids = 0;
+      cgnsFn<cg_ngrids>(_handle, B, Z, &ngrids);
+      int nsols = 0;
+      cgnsFn<cg_nsols>(_handle, B, Z, &nsols);
+
+      if (static_cast<std::size_t>(ngrids) != z.gridCoordinates.size() ||
+          static_cast<std::size_t>(nsols) != z.flowSolutions.size()) {
+        CGNS_TOOLS_ERROR("Grids or flow solutions of Zone {} of Base {} do "
+                         "not match the file.",
+                         z.name, B);
+        exit(EXIT_FAILURE);
+      }
+
+      for (int G = 1; G <= ngrids; ++G) {
+        this->updateGridCoordinates(B, Z, G, z.gridCoordinates[G - 1]);
+      }
+      for (int S = 1; S <= nsols; ++S) {
+        this->updateFlowSolution(B, Z, S, z.flowSolutions[S - 1]);
+      }
+    }
+  }
+}
+
+updateStats update(const std::string &path, const root &r,
+                   const updateOptions &options) {
+  const auto start = std::chrono::steady_clock::now();
+
+  // lazy arrays of the root may read from the file, which cannot be opened
+  // for modification while they hold it open. Arrays to compare are loaded
+  // before the read handles are closed.
+  const auto readers = fileIn::openFiles(path);
+  if (!readers.empty() && !options.skipUnloaded) {
+    for (const auto &base : r.bases) {
+      for (const auto &zoneVariant : base.zones) {
+        loadArrays(baseOf(zoneVariant));
+      }
+    }
+  }
+  for (const auto &reader : readers) {
+    reader->close();
+  }
+
+  updateStats stats{};
+  {
+    fileModify f{path, options};
+    f.update(r);
+    stats = f.stats();
+  }
+
+  for (const auto &reader : readers) {
+    reader->reopen();
+  }
+
+  const std::chrono::duration<double, std::milli> time =
+      std::chrono::steady_clock::now() - start;
+
+  CGNS_TOOLS_INFO("Updated {} in {:.3f} ms ({} of {} arrays rewritten)", path,
+                  time.count(), stats.nWritten, stats.nArrays);
+
+  return stats;
+}
+
+} // namespace cgns_tools
@@ -0,0 +1,31 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+
+namespace cgns_tools::test {
+
+/// number of failed checks of the test program
+inline int &failures() {
+  static int n = 0;
+  return n;
+}
+
+/// @brief report a failed check, unlike assert it is also evaluated in
+/// release builds
+inline bool check(const bool condition, const std::string_view what) {
+  if (!condition) {
+    std::cerr << "check failed: " << what << std::endl;
+    ++failures();
+  }
+  return condition;
+}
+
+/// exit code of the test program
+inline int result() { return failures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE; }
+
+} // namespace cgns_tools::test
@@ -0,0 +1,103 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+// Metrics of a sheared cube: x = i h + s j h, y = j h, z = k h. The shear
+// keeps every cell volume at h^3, the face vectors are constant per
+// direction.
+
+#include "check.hpp"
+
+#include <geometry.hpp>
+#include <logger.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace cgns_tools;
+using test::check;
+
+namespace {
+
+constexpr cgsize_t n = 9;
+constexpr double shear = 0.5;
+constexpr double offset = 2.0;
+
+/// true if a and b agree up to the relative tolerance of T
+template <typename T> bool near(const double a, const double b) {
+  const double tolerance = sizeof(T) == 4 ? 1e-5 : 1e-12;
+  return std::abs(a - b) <= tolerance * std::max(1.0, std::abs(b));
+}
+
+template <typename T> void shearedCube(const unsigned nThreads) {
+  const std::size_t nVertex = n * n * n;
+  const double h = 1.0 / (n - 1);
+
+  std::vector<T> x(nVertex), y(nVertex), z(nVertex);
+  for (std::size_t k = 0, idx = 0; k < n; ++k) {
+    for (std::size_t j = 0; j < n; ++j) {
+      for (std::size_t i = 0; i < n; ++i, ++idx) {
+        x[idx] = static_cast<T>(offset + h * i + shear * h * j);
+        y[idx] = static_cast<T>(h * j);
+        z[idx] = static_cast<T>(h * k);
+      }
+    }
+  }
+
+  metricsOptions options{};
+  options.nThreads = nThreads;
+  const auto m =
+      computeMetrics<T>({n, n, n}, x.data(), y.data(), z.data(), options);
+
+  const std::string type = sizeof(T) == 4 ? "float" : "double";
+
+  const std::size_t nCell = (n - 1) * (n - 1) * (n - 1);
+  check(m.volume.size() == nCell, type + ": number of volumes");
+  bool volumes = true;
+  for (const T v : m.volume) {
+    volumes &= near<T>(v, h * h * h);
+  }
+  check(volumes, type + ": cell volumes");
+  check(near<T>(m.totalVolume, 1.0), type + ": total volume");
+
+  // I-faces: (h^2, -s h^2, 0), J-faces: (0, h^2, 0), K-faces: (0, 0, h^2)
+  const std::array<std::array<double, 3>, 3> expected = {
+      {{h * h, -shear * h * h, 0.0}, {0.0, h * h, 0.0}, {0.0, 0.0, h * h}}};
+  const std::array<std::size_t, 3> nFace = {
+      n * (n - 1) * (n - 1), (n - 1) * n * (n - 1), (n - 1) * (n - 1) * n};
+  for (std::size_t d = 0; d < 3; ++d) {
+    bool faces = true;
+    for (std::size_t c = 0; c < 3; ++c) {
+      faces &= m.faceVectors[d][c].size() == nFace[d];
+      for (const T s : m.faceVectors[d][c]) {
+        faces &= near<T>(s, expected[d][c]);
+      }
+    }
+    check(faces, type + ": face vectors of direction " + std::to_string(d));
+  }
+
+  check(near<T>(m.centroid[0], offset + 0.5 + 0.5 * shear) &&
+            near<T>(m.centroid[1], 0.5) && near<T>(m.centroid[2], 0.5),
+        type + ": centroid");
+
+  check(near<T>(m.bbox.min[0], offset) &&
+            near<T>(m.bbox.max[0], offset + 1.0 + shear) &&
+            near<T>(m.bbox.min[1], 0.0) && near<T>(m.bbox.max[1], 1.0) &&
+            near<T>(m.bbox.min[2], 0.0) && near<T>(m.bbox.max[2], 1.0),
+        type + ": bounding box");
+}
+
+} // namespace
+
+int main() {
+  spdlog::set_level(spdlog::level::warn);
+
+  for (const unsigned nThreads : {1u, 4u}) {
+    shearedCube<float>(nThreads);
+    shearedCube<double>(nThreads);
+  }
+
+  return test::result();
+}
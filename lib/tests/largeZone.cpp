@@ -0,0 +1,160 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+// Writes and reads zones above 2^32 vertices. Only a few slabs of the
+// coordinates are written, the remaining file is sparse.
+
+#include "check.hpp"
+
+#include <cgns-tools.hpp>
+#include <logger.hpp>
+#include <tiles.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+using namespace cgns_tools;
+using test::check;
+
+namespace {
+
+constexpr std::int64_t fourG = std::int64_t{1} << 32;
+
+/// 2048 x 2048 x 1025 vertices, the last k-plane is written
+void structured(const std::string &path) {
+  const std::vector<cgsize_t> nVertex = {2048, 2048, 1025};
+  check(checkedProduct(nVertex) > fourG, "zone above 2^32 vertices");
+
+  const cgsize_t ni = nVertex[0];
+  const cgsize_t nj = nVertex[1];
+  const cgsize_t nk = nVertex[2];
+
+  {
+    const fileOut f{path};
+    const int B = f.writeBaseHeader(base{"Base", 3, 3});
+    f.writeZoneInformation(
+        B, zoneStructured{"Zone", std::vector<cgsize_t>(nVertex),
+                          {ni - 1, nj - 1, nk - 1}, {0, 0, 0}, {}});
+
+    std::vector<float> plane(ni * nj);
+    for (cgsize_t j = 0; j < nj; ++j) {
+      for (cgsize_t i = 0; i < ni; ++i) {
+        plane[j * ni + i] = static_cast<float>(i + j);
+      }
+    }
+
+    const cgsize_t rangeMin[3] = {1, 1, nk};
+    const cgsize_t rangeMax[3] = {ni, nj, nk};
+    f.writeCoordinates(B, 1, "CoordinateX", RealSingle, rangeMin, rangeMax,
+                       plane.data());
+  }
+
+  const auto f = std::make_shared<fileIn>(path, parseOptions{true});
+  check(f->readZoneVertexSize(1, 1) == nVertex, "structured: vertex size");
+
+  // lazy arrays know their size without loading it
+  const zoneV read = f->readZone(1, 1);
+  const auto &zone = std::get<zoneStructured>(read);
+  check(zone.nVertex == nVertex, "structured: lazy zone size");
+  const auto &x =
+      std::get<dataArray<float>>(zone.gridCoordinates.front().dataArrays[0]);
+  check(!x.loaded(), "structured: array not loaded by a lazy parse");
+  check(static_cast<std::int64_t>(x.size()) == checkedProduct(nVertex),
+        "structured: lazy array size");
+
+  // a single k-plane per tile, the last tile is the written plane
+  tileReader<float> reader{*f, 1, 1, {ni * nj * sizeof(float), 0}};
+  check(reader.nTiles() == static_cast<std::size_t>(nk),
+        "structured: one tile per k-plane");
+
+  const auto tile = reader.read(reader.nTiles() - 1);
+  check(tile.range.rangeMin[2] == nk && tile.range.rangeMax[2] == nk,
+        "structured: range of the last tile");
+  const auto &data = tile.coordinates.front();
+  check(data[0] == 0.0f, "structured: first value of the last plane");
+  check(data[ni - 1] == static_cast<float>(ni - 1),
+        "structured: last value of the first row");
+  check(data[ni * nj - 1] == static_cast<float>(ni + nj - 2),
+        "structured: last value of the last plane");
+}
+
+/// 2^32 + 8 vertices and a single HEXA_8 over the last eight vertices
+void unstructured(const std::string &path) {
+  const cgsize_t nVertex = fourG + 8;
+
+  {
+    const fileOut f{path};
+    const int B = f.writeBaseHeader(base{"Base", 3, 3});
+
+    std::vector<cgsize_t> conn{};
+    for (cgsize_t n = nVertex - 7; n <= nVertex; ++n) {
+      conn.push_back(n);
+    }
+    std::vector<elementSection> sections{};
+    sections.emplace_back("Hexa", HEXA_8, 1, 1, std::move(conn));
+
+    f.writeZoneInformation(
+        B, zoneUnstructured{"Zone", nVertex, 1, 0, {}, std::move(sections)});
+
+    const std::vector<float> tail = {0, 1, 2, 3, 4, 5, 6, 7};
+    const cgsize_t rangeMin = nVertex - 7;
+    const cgsize_t rangeMax = nVertex;
+    f.writeCoordinates(B, 1, "CoordinateX", RealSingle, &rangeMin, &rangeMax,
+                       tail.data());
+  }
+
+  const fileIn f{path};
+  check(f.readZoneVertexSize(1, 1) == std::vector<cgsize_t>{nVertex},
+        "unstructured: vertex size");
+
+  std::vector<float> tail(8);
+  const cgsize_t rangeMin = nVertex - 7;
+  const cgsize_t rangeMax = nVertex;
+  f.readCoordinates(1, 1, "CoordinateX", RealSingle, &rangeMin, &rangeMax,
+                    tail.data());
+  bool values = true;
+  for (std::size_t n = 0; n < tail.size(); ++n) {
+    values &= tail[n] == static_cast<float>(n);
+  }
+  check(values, "unstructured: values above 2^32");
+
+  // a lazy parse leaves the connectivity in the file
+  parseOptions lazy{};
+  lazy.lazy = true;
+  const auto r = parse(path, lazy);
+  const auto &zone = std::get<zoneUnstructured>(r.bases[0].zones[0]);
+  const auto *stored =
+      std::get_if<storedConnectivity>(&zone.sections[0].connectivity);
+  check(stored != nullptr, "unstructured: lazy connectivity not read");
+  if (stored != nullptr) {
+    std::vector<cgsize_t> conn{};
+    std::vector<cgsize_t> offsets{};
+    stored->read(1, 1, conn, offsets);
+    check(conn.size() == 8 && conn.back() == nVertex,
+          "unstructured: lazy connectivity above 2^32");
+  }
+}
+
+} // namespace
+
+int main() {
+  spdlog::set_level(spdlog::level::warn);
+
+  // sizes above 2^31 require a cgns build with 64-bit cgsize_t
+  if (sizeof(cgsize_t) < 8) {
+    return 77;
+  }
+
+  const auto dir = std::filesystem::temp_directory_path();
+  const auto path = (dir / "cgns-tools-large-zone.cgns").string();
+
+  structured(path);
+  unstructured(path);
+
+  std::filesystem::remove(path);
+  return test::result();
+}
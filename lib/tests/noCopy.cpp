@@ -0,0 +1,104 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+// Bulk data is never duplicated on the write path or while parsing. All
+// arrays are drawn from an arena, which counts every byte it hands out.
+
+#include "check.hpp"
+
+#include <arena.hpp>
+#include <cgns-tools.hpp>
+#include <convert.hpp>
+#include <logger.hpp>
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace cgns_tools;
+using test::check;
+
+namespace {
+
+constexpr cgsize_t n = 17;
+constexpr unsigned nZones = 4;
+
+/// array of n^3 values drawn from the arena
+dataArray<double> array(std::string &&name,
+                        const std::shared_ptr<arena> &memory,
+                        const double value) {
+  buffer<double> data(n * n * n, arenaAllocator<double>{memory});
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    data[i] = value + static_cast<double>(i);
+  }
+  return {std::move(name), std::move(data)};
+}
+
+/// cartesian zones with coordinates and a vertex solution in the arena
+root generate(const std::shared_ptr<arena> &memory) {
+  base b{"Base", 3, 3};
+  for (unsigned z = 0; z < nZones; ++z) {
+    std::vector<gridCoordinateDataV> coordinates{};
+    for (const char *name : {"CoordinateX", "CoordinateY", "CoordinateZ"}) {
+      coordinates.emplace_back(array(name, memory, z));
+    }
+    std::vector<gridCoordinatesT> grids{};
+    grids.emplace_back("GridCoordinates", std::move(coordinates));
+
+    zoneStructured zone{"Zone" + std::to_string(z + 1),
+                        {n, n, n},
+                        {n - 1, n - 1, n - 1},
+                        {0, 0, 0},
+                        std::move(grids)};
+
+    std::vector<dataArrayV> fields{};
+    fields.emplace_back(array("Density", memory, z));
+    zone.flowSolutions.emplace_back("FlowSolution", Vertex, std::move(fields));
+
+    b.zones.emplace_back(std::move(zone));
+  }
+
+  root r{};
+  r.bases.push_back(std::move(b));
+  return r;
+}
+
+} // namespace
+
+int main() {
+  spdlog::set_level(spdlog::level::warn);
+
+  const auto path =
+      (std::filesystem::temp_directory_path() / "cgns-tools-no-copy.cgns")
+          .string();
+
+  // four arrays per zone
+  const std::size_t bytes = nZones * 4 * n * n * n * sizeof(double);
+
+  const auto memory = std::make_shared<arena>();
+  root r = generate(memory);
+  check(memory->bytesAllocated() == bytes, "generated arrays");
+
+  root moved = std::move(r);
+  writeFile(path, moved);
+  check(memory->bytesAllocated() == bytes, "writeFile copies no arrays");
+
+  parseOptions options{};
+  options.memory = std::make_shared<arena>();
+  const root parsed = parse(path, options);
+  check(parsed.bases.front().zones.size() == nZones, "parsed zones");
+  check(options.memory->bytesAllocated() == bytes,
+        "parse reads each array exactly once");
+
+  const root converted = toUnstructured(std::move(moved));
+  writeFile(path, converted);
+  check(memory->bytesAllocated() == bytes,
+        "toUnstructured and writeFile copy no arrays");
+
+  std::filesystem::remove(path);
+  return test::result();
+}
@@ -0,0 +1,122 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+// Writes zones round robin through the parallel library and reads them back
+// in slabs of vertex planes. Run with several ranks, e.g. mpirun -np 4.
+
+#include "check.hpp"
+
+#include <cgns-tools-mpi.hpp>
+#include <logger.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace cgns_tools;
+using test::check;
+
+namespace {
+
+constexpr cgsize_t n = 9;
+constexpr int nZones = 6;
+
+/// value of vertex idx (0-based, i fastest) of coordinate c of zone Z
+double value(const int Z, const int c, const std::size_t idx) {
+  return 1e6 * Z + 1e5 * c + static_cast<double>(idx);
+}
+
+/// @brief zones of n^3 vertices, the coordinates are only filled for the
+/// zones owned by the calling rank
+root generate(const ownershipFn &own) {
+  base b{"Base", 3, 3};
+  for (int Z = 1; Z <= nZones; ++Z) {
+    zoneV zone = zoneStructured{"Zone" + std::to_string(Z),
+                                {n, n, n},
+                                {n - 1, n - 1, n - 1},
+                                {0, 0, 0},
+                                {}};
+
+    const bool owned = own(1, Z, zone).has_value();
+
+    std::vector<gridCoordinateDataV> coordinates{};
+    int c = 0;
+    for (const char *name : {"CoordinateX", "CoordinateY", "CoordinateZ"}) {
+      buffer<double> data(owned ? n * n * n : 0);
+      for (std::size_t idx = 0; idx < data.size(); ++idx) {
+        data[idx] = value(Z, c, idx);
+      }
+      coordinates.emplace_back(dataArray<double>{name, std::move(data)});
+      ++c;
+    }
+    std::get<zoneStructured>(zone).gridCoordinates.emplace_back(
+        "GridCoordinates", std::move(coordinates));
+
+    b.zones.emplace_back(std::move(zone));
+  }
+
+  root r{};
+  r.bases.push_back(std::move(b));
+  return r;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  spdlog::set_level(spdlog::level::warn);
+
+  const auto path =
+      (std::filesystem::temp_directory_path() / "cgns-tools-parallel.cgns")
+          .string();
+
+  const auto roundRobin = zonesRoundRobin(MPI_COMM_WORLD);
+  writeFileParallel(MPI_COMM_WORLD, path, generate(roundRobin), roundRobin);
+
+  const auto slabs = zoneSlabs(MPI_COMM_WORLD);
+  const root r = parseParallel(MPI_COMM_WORLD, path, slabs);
+
+  const auto &zones = r.bases.front().zones;
+  check(zones.size() == nZones, "number of zones");
+
+  for (int Z = 1; Z <= static_cast<int>(zones.size()); ++Z) {
+    const auto &zone = std::get<zoneStructured>(zones[Z - 1]);
+    check(zone.nVertex == std::vector<cgsize_t>{n, n, n}, "zone size");
+
+    const auto share = slabs(1, Z, zones[Z - 1]);
+    const std::size_t first = share ? (share->begin - 1) * n * n : 0;
+    const std::size_t length =
+        share ? (share->end - share->begin + 1) * n * n : 0;
+
+    const auto &coordinates = zone.gridCoordinates.front().dataArrays;
+    for (int c = 0; c < static_cast<int>(coordinates.size()); ++c) {
+      const auto &data = std::get<dataArray<double>>(coordinates[c]).data();
+      if (!check(data.size() == length, "slab length")) {
+        continue;
+      }
+      for (std::size_t idx = 0; idx < length; ++idx) {
+        if (!check(data[idx] == value(Z, c, first + idx), "slab values")) {
+          break;
+        }
+      }
+    }
+  }
+
+  // every rank fails if one rank does
+  int failures = test::failures();
+  MPI_Allreduce(MPI_IN_PLACE, &failures, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  int rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  if (rank == 0) {
+    std::filesystem::remove(path);
+  }
+
+  MPI_Finalize();
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,112 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+// Quality of three zones with known cell shapes: a uniform cube, a cube
+// stretched geometrically in i and a mirrored, left-handed cube.
+
+#include "check.hpp"
+
+#include <logger.hpp>
+#include <quality.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace cgns_tools;
+using test::check;
+
+namespace {
+
+constexpr cgsize_t n = 6;
+constexpr double ratio = 1.5;
+
+/// zone of n^3 vertices at position(i, j, k)
+zoneStructured generate(std::string &&name,
+                        const std::function<std::array<double, 3>(
+                            std::size_t, std::size_t, std::size_t)> &position) {
+  std::array<buffer<double>, 3> coordinates{};
+  for (std::size_t k = 0; k < n; ++k) {
+    for (std::size_t j = 0; j < n; ++j) {
+      for (std::size_t i = 0; i < n; ++i) {
+        const auto p = position(i, j, k);
+        for (std::size_t d = 0; d < 3; ++d) {
+          coordinates[d].push_back(p[d]);
+        }
+      }
+    }
+  }
+
+  std::vector<gridCoordinateDataV> arrays{};
+  arrays.emplace_back(
+      dataArray<double>{"CoordinateX", std::move(coordinates[0])});
+  arrays.emplace_back(
+      dataArray<double>{"CoordinateY", std::move(coordinates[1])});
+  arrays.emplace_back(
+      dataArray<double>{"CoordinateZ", std::move(coordinates[2])});
+  std::vector<gridCoordinatesT> grids{};
+  grids.emplace_back("GridCoordinates", std::move(arrays));
+
+  return {std::move(name), {n, n, n}, {n - 1, n - 1, n - 1}, {0, 0, 0},
+          std::move(grids)};
+}
+
+bool near(const double a, const double b) { return std::abs(a - b) < 1e-12; }
+
+} // namespace
+
+int main() {
+  spdlog::set_level(spdlog::level::warn);
+
+  base b{"Base", 3, 3};
+  b.zones.emplace_back(generate("Cube", [](auto i, auto j, auto k) {
+    return std::array<double, 3>{double(i), double(j), double(k)};
+  }));
+  // cell i has the width ratio^i
+  b.zones.emplace_back(generate("Stretched", [](auto i, auto j, auto k) {
+    return std::array<double, 3>{(std::pow(ratio, i) - 1.0) / (ratio - 1.0),
+                                 double(j), double(k)};
+  }));
+  b.zones.emplace_back(generate("Mirrored", [](auto i, auto j, auto k) {
+    return std::array<double, 3>{-double(i), double(j), double(k)};
+  }));
+
+  root r{};
+  r.bases.push_back(std::move(b));
+
+  qualityOptions options{};
+  options.nThreads = 2;
+  const auto q = quality(r, options);
+
+  if (!check(q.size() == 3, "one report per zone")) {
+    return test::result();
+  }
+
+  const std::uint64_t nCell = (n - 1) * (n - 1) * (n - 1);
+  for (const auto &zq : q) {
+    check(zq.nCell == nCell, zq.name + ": number of cells");
+    check(near(zq.skewness.max, 0.0), zq.name + ": orthogonal cells");
+  }
+
+  const auto &cube = q[0];
+  check(near(cube.aspectRatio.min, 1.0) && near(cube.aspectRatio.max, 1.0),
+        "Cube: aspect ratio");
+  check(near(cube.growthRate.min, 1.0) && near(cube.growthRate.max, 1.0),
+        "Cube: growth rate");
+  check(cube.nNegativeJacobian == 0, "Cube: positive jacobians");
+
+  const auto &stretched = q[1];
+  check(near(stretched.growthRate.max, ratio), "Stretched: growth rate");
+  check(near(stretched.aspectRatio.max, std::pow(ratio, n - 2)),
+        "Stretched: aspect ratio");
+  check(stretched.nNegativeJacobian == 0, "Stretched: positive jacobians");
+
+  check(q[2].nNegativeJacobian == nCell, "Mirrored: negative jacobians");
+
+  return test::result();
+}
@@ -0,0 +1,143 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+// Freed bulk data is returned by the arena: a block is unmapped with its last
+// allocation. Released lazy arrays and zones written by writeFile(root&&)
+// thus shrink the mapped memory back to zero.
+
+#include "check.hpp"
+
+#include <arena.hpp>
+#include <cgns-tools.hpp>
+#include <logger.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace cgns_tools;
+using test::check;
+
+namespace {
+
+constexpr cgsize_t n = 17;
+constexpr unsigned nZones = 4;
+
+/// smallest block, the arrays of all zones share a few blocks
+constexpr std::size_t blockBytes = 2 * 1024 * 1024;
+
+/// array of n^3 values on the heap
+dataArray<double> array(std::string &&name, const double value) {
+  buffer<double> data(n * n * n);
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    data[i] = value + static_cast<double>(i);
+  }
+  return {std::move(name), std::move(data)};
+}
+
+/// cartesian zones with coordinates and a vertex solution
+root generate() {
+  base b{"Base", 3, 3};
+  for (unsigned z = 0; z < nZones; ++z) {
+    std::vector<gridCoordinateDataV> coordinates{};
+    for (const char *name : {"CoordinateX", "CoordinateY", "CoordinateZ"}) {
+      coordinates.emplace_back(array(name, z));
+    }
+    std::vector<gridCoordinatesT> grids{};
+    grids.emplace_back("GridCoordinates", std::move(coordinates));
+
+    zoneStructured zone{"Zone" + std::to_string(z + 1),
+                        {n, n, n},
+                        {n - 1, n - 1, n - 1},
+                        {0, 0, 0},
+                        std::move(grids)};
+
+    std::vector<dataArrayV> fields{};
+    fields.emplace_back(array("Density", z));
+    zone.flowSolutions.emplace_back("FlowSolution", Vertex, std::move(fields));
+
+    b.zones.emplace_back(std::move(zone));
+  }
+
+  root r{};
+  r.bases.push_back(std::move(b));
+  return r;
+}
+
+/// apply f to every coordinate array and field of the root
+template <typename F> void forEachArray(root &r, F &&f) {
+  for (auto &b : r.bases) {
+    for (auto &zone : b.zones) {
+      std::visit(
+          [&](auto &z) {
+            for (auto &grid : z.gridCoordinates) {
+              for (auto &array : grid.dataArrays) {
+                std::visit(f, array);
+              }
+            }
+            for (auto &solution : z.flowSolutions) {
+              for (auto &field : solution.fields) {
+                std::visit(f, field);
+              }
+            }
+          },
+          zone);
+    }
+  }
+}
+
+} // namespace
+
+int main() {
+  spdlog::set_level(spdlog::level::warn);
+
+  const auto directory = std::filesystem::temp_directory_path();
+  const auto path = (directory / "cgns-tools-release.cgns").string();
+  const auto out = (directory / "cgns-tools-release-out.cgns").string();
+
+  // the arena returns a block with its last allocation
+  {
+    arena memory{blockBytes};
+    void *a = memory.allocate(1024, alignof(double));
+    void *b = memory.allocate(1024, alignof(double));
+    const std::size_t mapped = memory.bytesMapped();
+    check(mapped == blockBytes, "arena: small allocations share a block");
+
+    memory.deallocate(a, 1024);
+    check(memory.bytesMapped() == mapped, "arena: block kept while in use");
+    memory.deallocate(b, 1024);
+    check(memory.bytesMapped() == 0, "arena: block returned when empty");
+  }
+
+  writeFile(path, generate());
+
+  const auto memory = std::make_shared<arena>(blockBytes);
+  const auto load = [](auto &array) { array.load(); };
+  const auto release = [](auto &array) { array.release(); };
+
+  parseOptions options{};
+  options.lazy = true;
+  options.memory = memory;
+  root r = parse(path, options);
+  check(memory->bytesMapped() == 0, "lazy parse reads no bulk data");
+
+  forEachArray(r, load);
+  check(memory->bytesMapped() > 0, "loaded arrays are mapped");
+
+  forEachArray(r, release);
+  check(memory->bytesMapped() == 0, "released arrays are returned");
+
+  forEachArray(r, load);
+  check(memory->bytesMapped() > 0, "reloaded arrays are mapped");
+
+  writeFile(out, std::move(r));
+  check(memory->bytesMapped() == 0, "written zones are returned");
+
+  std::filesystem::remove(path);
+  std::filesystem::remove(out);
+  return test::result();
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+// A zone with three grids read as snapshots, in stream and in delta mode, and
+// through a parse, which reads the grids after the first as plain arrays.
+
+#include "check.hpp"
+
+#include <cgns-tools.hpp>
+#include <logger.hpp>
+#include <snapshots.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace cgns_tools;
+using test::check;
+
+namespace {
+
+constexpr cgsize_t n = 4;
+constexpr int nGrids = 3;
+
+/// value of vertex i of coordinate a of grid G (1-based)
+double value(const int G, const std::size_t a, const std::size_t i) {
+  return 1000.0 * G + 100.0 * a + static_cast<double>(i) * (G + 1);
+}
+
+/// single cartesian zone with nGrids grids
+root generate() {
+  std::vector<gridCoordinatesT> grids{};
+  for (int G = 1; G <= nGrids; ++G) {
+    std::vector<gridCoordinateDataV> coordinates{};
+    for (const char *name : {"CoordinateX", "CoordinateY", "CoordinateZ"}) {
+      buffer<double> data(n * n * n);
+      for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = value(G, coordinates.size(), i);
+      }
+      coordinates.emplace_back(dataArray<double>{name, std::move(data)});
+    }
+    grids.emplace_back(G == 1 ? "GridCoordinates"
+                              : "Snapshot" + std::to_string(G),
+                       std::move(coordinates));
+  }
+
+  base b{"Base", 3, 3};
+  b.zones.emplace_back(zoneStructured{"Zone",
+                                      {n, n, n},
+                                      {n - 1, n - 1, n - 1},
+                                      {0, 0, 0},
+                                      std::move(grids)});
+
+  root r{};
+  r.bases.push_back(std::move(b));
+  return r;
+}
+
+/// true if the coordinates of grid G match f(G, a, i)
+template <typename F>
+bool matches(const std::vector<std::vector<double>> &coordinates, const int G,
+             F &&f) {
+  bool equal = coordinates.size() == 3;
+  for (std::size_t a = 0; equal && a < coordinates.size(); ++a) {
+    equal = coordinates[a].size() == static_cast<std::size_t>(n * n * n);
+    for (std::size_t i = 0; equal && i < coordinates[a].size(); ++i) {
+      equal = coordinates[a][i] == f(G, a, i);
+    }
+  }
+  return equal;
+}
+
+} // namespace
+
+int main() {
+  spdlog::set_level(spdlog::level::warn);
+
+  const auto path =
+      (std::filesystem::temp_directory_path() / "cgns-tools-snapshots.cgns")
+          .string();
+
+  writeFile(path, generate());
+
+  {
+    const fileIn file{path};
+
+    gridStream<double> stream{file, 1, 1};
+    check(stream.nGrids() == nGrids, "stream: number of grids");
+
+    int read = 0;
+    for (const auto &snapshot : stream) {
+      ++read;
+      check(snapshot.G == read, "stream: grids in order");
+      check(matches(snapshot.coordinates, snapshot.G, value),
+            "stream: values of grid " + std::to_string(snapshot.G));
+    }
+    check(read == nGrids, "stream: all grids read");
+
+    gridStream<double> delta{file, 1, 1, true};
+    for (const auto &snapshot : delta) {
+      if (snapshot.G == 1) {
+        check(matches(snapshot.coordinates, 1, value),
+              "delta: first grid as is");
+        continue;
+      }
+      check(matches(snapshot.coordinates, snapshot.G,
+                    [](const int G, const std::size_t a, const std::size_t i) {
+                      return value(G, a, i) - value(1, a, i);
+                    }),
+            "delta: displacement of grid " + std::to_string(snapshot.G));
+    }
+  }
+
+  const root r = parse(path);
+  const auto &zone = std::get<zoneStructured>(r.bases.at(0).zones.at(0));
+  check(zone.gridCoordinates.size() == nGrids, "parse: number of grids");
+  for (std::size_t G = 1; G <= zone.gridCoordinates.size(); ++G) {
+    std::vector<std::vector<double>> coordinates{};
+    for (const auto &array : zone.gridCoordinates[G - 1].dataArrays) {
+      const auto &data = std::get<dataArray<double>>(array).data();
+      coordinates.emplace_back(data.begin(), data.end());
+    }
+    check(matches(coordinates, static_cast<int>(G), value),
+          "parse: values of grid " + std::to_string(G));
+  }
+
+  std::filesystem::remove(path);
+  return test::result();
+}
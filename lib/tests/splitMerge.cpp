@@ -0,0 +1,324 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+// Round trip of a block of 4 x 2 x 2 cells: split into pieces of 4 cells,
+// numbered through the new interfaces and merged into a single unstructured
+// zone again. A cube with a surface section before its cell checks that the
+// merge keeps the cell data with the cells.
+
+#include "check.hpp"
+
+#include <logger.hpp>
+#include <merge.hpp>
+#include <numbering.hpp>
+#include <split.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace cgns_tools;
+using test::check;
+
+namespace {
+
+constexpr std::array<cgsize_t, 3> nVertex = {5, 3, 3};
+constexpr cgsize_t nCell = 16;
+
+/// block with the coordinates (i, j, k) and the cell centre x as field
+zoneStructured block() {
+  std::array<buffer<double>, 3> coordinates{};
+  for (cgsize_t k = 0; k < nVertex[2]; ++k) {
+    for (cgsize_t j = 0; j < nVertex[1]; ++j) {
+      for (cgsize_t i = 0; i < nVertex[0]; ++i) {
+        coordinates[0].push_back(double(i));
+        coordinates[1].push_back(double(j));
+        coordinates[2].push_back(double(k));
+      }
+    }
+  }
+
+  buffer<double> centre{};
+  for (cgsize_t k = 0; k + 1 < nVertex[2]; ++k) {
+    for (cgsize_t j = 0; j + 1 < nVertex[1]; ++j) {
+      for (cgsize_t i = 0; i + 1 < nVertex[0]; ++i) {
+        centre.push_back(i + 0.5);
+      }
+    }
+  }
+
+  std::vector<gridCoordinateDataV> arrays{};
+  arrays.emplace_back(
+      dataArray<double>{"CoordinateX", std::move(coordinates[0])});
+  arrays.emplace_back(
+      dataArray<double>{"CoordinateY", std::move(coordinates[1])});
+  arrays.emplace_back(
+      dataArray<double>{"CoordinateZ", std::move(coordinates[2])});
+  std::vector<gridCoordinatesT> grids{};
+  grids.emplace_back("GridCoordinates", std::move(arrays));
+
+  zoneStructured zone{"Block",
+                      {nVertex[0], nVertex[1], nVertex[2]},
+                      {nVertex[0] - 1, nVertex[1] - 1, nVertex[2] - 1},
+                      {0, 0, 0},
+                      std::move(grids)};
+
+  std::vector<dataArrayV> fields{};
+  fields.emplace_back(dataArray<double>{"CentreX", std::move(centre)});
+  zone.flowSolutions.emplace_back("Centres", CellCenter, std::move(fields));
+
+  // bottom plane by its vertices, top plane by its faces
+  zone.boundaryConditions.emplace_back(
+      "Bottom", BCWall, PointRange, Vertex,
+      std::vector<cgsize_t>{1, 1, 1, nVertex[0], nVertex[1], 1});
+  zone.boundaryConditions.emplace_back(
+      "Top", BCFarfield, PointRange, KFaceCenter,
+      std::vector<cgsize_t>{1, 1, nVertex[2], nVertex[0] - 1, nVertex[1] - 1,
+                            nVertex[2]});
+
+  return zone;
+}
+
+/// coordinates of vertex p (1-based) of a structured zone
+std::array<double, 3> coordinate(const zoneStructured &zone,
+                                 const std::array<cgsize_t, 3> &p) {
+  const auto &n = zone.nVertex;
+  const std::size_t v = (p[0] - 1) + n[0] * ((p[1] - 1) + n[1] * (p[2] - 1));
+
+  std::array<double, 3> x{};
+  for (std::size_t d = 0; d < 3; ++d) {
+    x[d] = std::get<dataArray<double>>(zone.gridCoordinates[0].dataArrays[d])
+               .data()[v];
+  }
+  return x;
+}
+
+/// true if every vertex of the interface matches its donor vertex
+bool matches(const zoneStructured &zone, const zoneStructured &donor,
+             const connectivity1to1 &conn) {
+  std::array<cgsize_t, 3> lo{};
+  std::array<cgsize_t, 3> hi{};
+  for (std::size_t x = 0; x < 3; ++x) {
+    lo[x] = std::min(conn.range[x], conn.range[3 + x]);
+    hi[x] = std::max(conn.range[x], conn.range[3 + x]);
+  }
+
+  std::array<cgsize_t, 3> p{};
+  for (p[2] = lo[2]; p[2] <= hi[2]; ++p[2]) {
+    for (p[1] = lo[1]; p[1] <= hi[1]; ++p[1]) {
+      for (p[0] = lo[0]; p[0] <= hi[0]; ++p[0]) {
+        if (coordinate(zone, p) != coordinate(donor, conn.donor(p))) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/// checks of the pieces of the block
+void pieces(const base &b) {
+  check(b.zones.size() == 4, "split: number of pieces");
+
+  std::map<std::string, const zoneStructured *> byName{};
+  for (const auto &zone : b.zones) {
+    const auto &z = std::get<zoneStructured>(zone);
+    byName[z.name] = &z;
+  }
+
+  cgsize_t cells = 0;
+  std::size_t interfaces = 0;
+  cgsize_t topFaces = 0;
+  for (const auto &[name, zone] : byName) {
+    const cgsize_t n = zone->nCell[0] * zone->nCell[1] * zone->nCell[2];
+    check(n == 4, name + ": number of cells");
+    cells += n;
+
+    const auto &centre = std::get<dataArray<double>>(
+        zone->flowSolutions.at(0).fields.at(0));
+    check(centre.size() == static_cast<std::size_t>(n),
+          name + ": cell data size");
+
+    for (const auto &conn : zone->connectivities) {
+      ++interfaces;
+      const auto donor = byName.find(conn.donorName);
+      if (check(donor != byName.end(), name + ": interface donor exists")) {
+        check(matches(*zone, *donor->second, conn),
+              name + ": interface " + conn.name + " matches its donor");
+      }
+    }
+
+    for (const auto &bc : zone->boundaryConditions) {
+      if (bc.name == "Top") {
+        topFaces += (bc.points[3] - bc.points[0] + 1) *
+                    (bc.points[4] - bc.points[1] + 1);
+        check(bc.points[2] == zone->nVertex[2] &&
+                  bc.points[5] == zone->nVertex[2],
+              name + ": top faces on the last plane");
+      }
+    }
+  }
+
+  check(cells == nCell, "split: cells of all pieces");
+  check(interfaces > 0 && interfaces % 2 == 0,
+        "split: interfaces come in pairs");
+  check(topFaces == 8, "split: faces of the top BC");
+
+  // the vertices shared by the pieces are matched through the interfaces
+  numberingOptions options{};
+  options.weld = false;
+  const auto numbering = numberVertices(b, options);
+  check(numbering.nVertex == nVertex[0] * nVertex[1] * nVertex[2],
+        "numbering: distinct vertices");
+
+  std::set<cgsize_t> bottom{};
+  for (std::size_t Z = 0; Z < b.zones.size(); ++Z) {
+    const auto &zone = std::get<zoneStructured>(b.zones[Z]);
+    for (const auto &bc : zone.boundaryConditions) {
+      if (bc.name != "Bottom") {
+        continue;
+      }
+      for (cgsize_t j = bc.points[1]; j <= bc.points[4]; ++j) {
+        for (cgsize_t i = bc.points[0]; i <= bc.points[3]; ++i) {
+          const cgsize_t v = (i - 1) + zone.nVertex[0] * (j - 1);
+          bottom.insert(numbering.ids[Z][v]);
+        }
+      }
+    }
+  }
+  check(bottom.size() == static_cast<std::size_t>(nVertex[0] * nVertex[1]),
+        "numbering: vertices of the bottom BC");
+}
+
+/// checks of the merged zone
+void merged(const base &b) {
+  if (!check(b.zones.size() == 1, "merge: single zone")) {
+    return;
+  }
+  const auto &zone = std::get<zoneUnstructured>(b.zones[0]);
+
+  check(zone.nVertex == nVertex[0] * nVertex[1] * nVertex[2],
+        "merge: vertices welded");
+  check(zone.nCell == nCell, "merge: cells");
+
+  std::map<std::string, cgsize_t> bcElements{};
+  for (const auto &bc : zone.boundaryConditions) {
+    if (check(bc.pointSet == PointRange && bc.points.size() == 2,
+              bc.name + ": element range")) {
+      check(bc.points[0] > nCell, bc.name + ": after the cells");
+      bcElements[bc.name] += bc.points[1] - bc.points[0] + 1;
+    }
+  }
+  check(bcElements["Bottom"] == 8, "merge: faces of the bottom BC");
+  check(bcElements["Top"] == 8, "merge: faces of the top BC");
+
+  // the cell data follows the cells: compare with the element centres
+  const auto &x = std::get<dataArray<double>>(
+                      zone.gridCoordinates.at(0).dataArrays.at(0))
+                      .data();
+  const auto &centre =
+      std::get<dataArray<double>>(zone.flowSolutions.at(0).fields.at(0))
+          .data();
+
+  bool centres = centre.size() == static_cast<std::size_t>(nCell);
+  for (const auto &section : zone.sections) {
+    if (section.type != HEXA_8) {
+      continue;
+    }
+    const auto &conn = std::get<std::vector<cgsize_t>>(section.connectivity);
+    for (cgsize_t e = 0; centres && e < section.nElements(); ++e) {
+      double sum = 0.0;
+      for (cgsize_t n = 0; n < 8; ++n) {
+        sum += x[conn[8 * e + n] - 1];
+      }
+      centres = std::abs(sum / 8.0 - centre[section.start - 1 + e]) < 1e-12;
+    }
+  }
+  check(centres, "merge: cell data at the cells");
+}
+
+/// @brief unit cube as single HEXA_8 after an unreferenced QUAD_4 section,
+/// the surface elements precede the cell in the element numbering
+base surfaceFirst() {
+  std::array<buffer<double>, 3> coordinates{};
+  for (int v = 0; v < 8; ++v) {
+    coordinates[0].push_back(double((v & 1) ^ ((v >> 1) & 1)));
+    coordinates[1].push_back(double((v >> 1) & 1));
+    coordinates[2].push_back(double(v >> 2));
+  }
+
+  std::vector<gridCoordinateDataV> arrays{};
+  for (std::size_t d = 0; d < 3; ++d) {
+    arrays.emplace_back(dataArray<double>{std::string{"Coordinate"} +
+                                              char('X' + d),
+                                          std::move(coordinates[d])});
+  }
+  std::vector<gridCoordinatesT> grids{};
+  grids.emplace_back("GridCoordinates", std::move(arrays));
+
+  std::vector<elementSection> sections{};
+  sections.emplace_back("Wall", QUAD_4, 1, 1,
+                        std::vector<cgsize_t>{1, 4, 3, 2});
+  sections.emplace_back("Cells", HEXA_8, 2, 2,
+                        std::vector<cgsize_t>{1, 2, 3, 4, 5, 6, 7, 8});
+
+  zoneUnstructured zone{"Cube", 8, 1, 0, std::move(grids),
+                        std::move(sections)};
+
+  std::vector<dataArrayV> fields{};
+  fields.emplace_back(dataArray<double>{"Volume", buffer<double>{1.0}});
+  zone.flowSolutions.emplace_back("Cells", CellCenter, std::move(fields));
+
+  base b{"Surface", 3, 3};
+  b.zones.emplace_back(std::move(zone));
+  return b;
+}
+
+/// checks of the merge of surfaceFirst
+void surfaceMerged(const base &b) {
+  const auto &zone = std::get<zoneUnstructured>(b.zones.at(0));
+
+  check(zone.nCell == 1, "surface: cells");
+  for (const auto &section : zone.sections) {
+    if (section.type == HEXA_8) {
+      check(section.start == 1, "surface: cells numbered first");
+    } else {
+      check(section.start > 1, section.name + ": after the cells");
+    }
+  }
+
+  const auto &volume =
+      std::get<dataArray<double>>(zone.flowSolutions.at(0).fields.at(0))
+          .data();
+  check(volume.size() == 1 && volume[0] == 1.0, "surface: cell data kept");
+}
+
+} // namespace
+
+int main() {
+  spdlog::set_level(spdlog::level::warn);
+
+  root r{};
+  r.bases.emplace_back("Base", 3, 3);
+  r.bases[0].zones.emplace_back(block());
+
+  splitOptions options{};
+  options.maxCells = 4;
+  r = split(std::move(r), options);
+  pieces(r.bases[0]);
+
+  mergeOptions mergeOptions{};
+  mergeOptions.numbering.weld = false;
+  r = merge(std::move(r), mergeOptions);
+  merged(r.bases[0]);
+
+  surfaceMerged(merge(surfaceFirst(), mergeOptions));
+
+  return test::result();
+}
@@ -0,0 +1,138 @@
+// Copyright (c) 2022 Pascal Post
+// This code is licensed under MIT license (see LICENSE.txt for details)
+
+// In-place update of a file from a lazy parse of the same file: only the
+// changed coordinate array is rewritten, with its content hash stored next to
+// it, and the arrays left in the file stay readable afterwards.
+
+#include "check.hpp"
+
+#include <cgns-tools.hpp>
+#include <hash.hpp>
+#include <logger.hpp>
+#include <update.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace cgns_tools;
+using test::check;
+
+namespace {
+
+constexpr cgsize_t n = 5;
+constexpr unsigned nZones = 2;
+
+/// value of vertex i of the arrays of zone z
+double value(const unsigned z, const std::size_t i) {
+  return 100.0 * z + static_cast<double>(i);
+}
+
+/// cartesian zones with three coordinate arrays
+root generate() {
+  base b{"Base", 3, 3};
+  for (unsigned z = 0; z < nZones; ++z) {
+    std::vector<gridCoordinateDataV> coordinates{};
+    for (const char *name : {"CoordinateX", "CoordinateY", "CoordinateZ"}) {
+      buffer<double> data(n * n * n);
+      for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = value(z, i);
+      }
+      coordinates.emplace_back(dataArray<double>{name, std::move(data)});
+    }
+    std::vector<gridCoordinatesT> grids{};
+    grids.emplace_back("GridCoordinates", std::move(coordinates));
+
+    b.zones.emplace_back(zoneStructured{"Zone" + std::to_string(z + 1),
+                                        {n, n, n},
+                                        {n - 1, n - 1, n - 1},
+                                        {0, 0, 0},
+                                        std::move(grids)});
+  }
+
+  root r{};
+  r.bases.push_back(std::move(b));
+  return r;
+}
+
+/// coordinate array A (0-based) of zone Z (0-based)
+dataArray<double> &coordinate(root &r, const std::size_t Z,
+                              const std::size_t A) {
+  return std::get<dataArray<double>>(std::get<zoneStructured>(
+                                         r.bases.at(0).zones.at(Z))
+                                         .gridCoordinates.at(0)
+                                         .dataArrays.at(A));
+}
+
+/// content hash stored with a coordinate array of zone Z (1-based), if any
+std::string storedHash(const std::string &path, const int Z,
+                       const std::string &name) {
+  int handle = 0;
+  cgnsFn<cg_open>(path.c_str(), CG_MODE_READ, &handle);
+  cgnsFn<cg_goto>(handle, 1, "Zone_t", Z, "GridCoordinates_t", 1,
+                  name.c_str(), 0, "end");
+
+  int ndescriptors = 0;
+  cgnsFn<cg_ndescriptors>(&ndescriptors);
+
+  std::string hash{};
+  for (int D = 1; D <= ndescriptors; ++D) {
+    char descname[33] = "";
+    char *text = nullptr;
+    cgnsFn<cg_descriptor_read>(D, descname, &text);
+    if (std::string_view{descname} == contentHashDescriptor) {
+      hash = text;
+    }
+    cg_free(text);
+  }
+
+  cgnsFn<cg_close>(handle);
+  return hash;
+}
+
+} // namespace
+
+int main() {
+  spdlog::set_level(spdlog::level::warn);
+
+  const auto path =
+      (std::filesystem::temp_directory_path() / "cgns-tools-update.cgns")
+          .string();
+
+  writeFile(path, generate());
+
+  parseOptions options{};
+  options.lazy = true;
+  root r = parse(path, options);
+
+  auto &changed = coordinate(r, 1, 0);
+  changed.data()[0] = -1.0;
+
+  const updateStats stats = update(path, r);
+  check(stats.nWritten == 1, "update rewrites the changed array only");
+
+  // the lazy parse reads through its reopened handle
+  check(!coordinate(r, 1, 1).loaded() &&
+            coordinate(r, 1, 1).data()[1] == value(1, 1),
+        "unloaded arrays stay readable after the update");
+
+  root updated = parse(path);
+  const auto &written = coordinate(updated, 1, 0).data();
+  check(written[0] == -1.0 && written[1] == value(1, 1),
+        "updated content in the file");
+  check(coordinate(updated, 0, 0).data()[0] == value(0, 0),
+        "unchanged zone in the file");
+
+  const std::uint64_t hash =
+      contentHash(written.data(), written.size() * sizeof(double));
+  check(storedHash(path, 2, changed.name) == fmt::format("{:016x}", hash),
+        "content hash stored with the rewritten array");
+
+  std::filesystem::remove(path);
+  return test::result();
+}
@@ -2,17 +2,212 @@
 // This code is licensed under MIT license (see LICENSE.txt for details)
 
 #include <cgns-tools.hpp>
+#include <update.hpp>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <cstring>
+#include <optional>
+#include <type_traits>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
 namespace py = pybind11;
 
+// std::vector does not propagate the move-only trait of the bulk data,
+// pybind11 would otherwise instantiate the copy constructors
+namespace pybind11::detail {
+template <>
+struct is_copy_constructible<cgns_tools::gridCoordinatesT> : std::false_type {};
+template <>
+struct is_copy_constructible<cgns_tools::flowSolution> : std::false_type {};
+template <>
+struct is_copy_constructible<cgns_tools::zoneStructured> : std::false_type {};
+template <>
+struct is_copy_constructible<cgns_tools::zoneUnstructured> : std::false_type {
+};
+template <> struct is_copy_constructible<cgns_tools::base> : std::false_type {};
+template <> struct is_copy_constructible<cgns_tools::root> : std::false_type {};
+} // namespace pybind11::detail
+
+namespace {
+
+using namespace cgns_tools;
+
+/// @brief list of references to the elements of a container owned by parent,
+/// the parent is kept alive as long as any element is referenced
+template <typename C> py::list references(C &container, py::handle parent) {
+  py::list list{};
+  for (auto &e : container) {
+    list.append(
+        py::cast(&e, py::return_value_policy::reference_internal, parent));
+  }
+  return list;
+}
+
+/// references to the active alternatives of a container of variants
+template <typename C>
+py::list variantReferences(C &container, py::handle parent) {
+  py::list list{};
+  for (auto &v : container) {
+    list.append(std::visit(
+        [&](auto &e) {
+          return py::cast(&e, py::return_value_policy::reference_internal,
+                          parent);
+        },
+        v));
+  }
+  return list;
+}
+
+/// @brief bind dataArray<T>. The data is exposed through the buffer protocol
+/// over the existing storage, numpy.asarray does not copy it.
+template <typename T> void bindDataArray(py::module_ &m, const char *name) {
+  py::class_<dataArray<T>>(m, name, py::buffer_protocol())
+      .def(py::init([](std::string name,
+                       const py::array_t<T, py::array::c_style |
+                                                py::array::forcecast> &data) {
+             buffer<T> b(static_cast<std::size_t>(data.size()));
+             std::memcpy(b.data(), data.data(), b.size() * sizeof(T));
+             return dataArray<T>{std::move(name), std::move(b)};
+           }),
+           py::arg("name"), py::arg("data"),
+           "copy a numpy array into a new data array")
+      .def_readwrite("name", &dataArray<T>::name)
+      .def_property_readonly("size", &dataArray<T>::size)
+      .def_property_readonly("loaded", &dataArray<T>::loaded)
+      .def("load", &dataArray<T>::load)
+      .def_buffer([](dataArray<T> &da) {
+        return py::buffer_info(da.data().data(), da.size());
+      });
+}
+
+/// @brief bind the members common to both zone types
+template <typename Z> void bindZone(py::class_<Z> &c) {
+  c.def_readwrite("name", &Z::name)
+      .def_readonly("nVertex", &Z::nVertex)
+      .def_readonly("nCell", &Z::nCell)
+      .def_readonly("nBoundVertex", &Z::nBoundVertex)
+      .def_property_readonly("gridCoordinates",
+                             [](py::object self) {
+                               return references(
+                                   self.cast<Z &>().gridCoordinates, self);
+                             })
+      .def_property_readonly("flowSolutions", [](py::object self) {
+        return references(self.cast<Z &>().flowSolutions, self);
+      });
+}
+
+} // namespace
+
 PYBIND11_MODULE(cgns_tools_pySDK, m) {
   m.doc() = "cgns-tools python interface module";
 
-  // py::class_<cgns::fileIn>(m, "cgnsFile")
-  //     .def(py::init<const std::string &>())
-  //     .def("baseInformation", &cgns::file::readBaseInformation);
+  bindDataArray<float>(m, "dataArrayFloat");
+  bindDataArray<double>(m, "dataArrayDouble");
+
+  py::class_<gridCoordinatesT>(m, "gridCoordinates")
+      .def(py::init<std::string &&, std::vector<gridCoordinateDataV> &&>(),
+           py::arg("name"), py::arg("dataArrays"),
+           "the data arrays are moved into the grid and left empty")
+      .def_readwrite("name", &gridCoordinatesT::name)
+      .def_property_readonly("dataArrays", [](py::object self) {
+        return variantReferences(self.cast<gridCoordinatesT &>().dataArrays,
+                                 self);
+      });
+
+  py::class_<flowSolution>(m, "flowSolution")
+      .def_readwrite("name", &flowSolution::name)
+      .def_property_readonly("location",
+                             [](const flowSolution &s) {
+                               return std::string{
+                                   cg_GridLocationName(s.location)};
+                             })
+      .def_property_readonly("fields", [](py::object self) {
+        return variantReferences(self.cast<flowSolution &>().fields, self);
+      });
+
+  py::class_<zoneStructured> structured(m, "zoneStructured");
+  structured.def(
+      py::init<std::string &&, std::vector<cgsize_t> &&,
+               std::vector<cgsize_t> &&, std::vector<cgsize_t> &&,
+               std::vector<gridCoordinatesT> &&>(),
+      py::arg("name"), py::arg("nVertex"), py::arg("nCell"),
+      py::arg("nBoundVertex"), py::arg("gridCoordinates"),
+      "the grid coordinates are moved into the zone and left empty");
+  bindZone(structured);
+
+  py::class_<zoneUnstructured> unstructured(m, "zoneUnstructured");
+  bindZone(unstructured);
+
+  py::class_<family>(m, "family").def_readwrite("name", &family::name);
+
+  py::class_<base>(m, "base")
+      .def(py::init<std::string &&, const unsigned, const unsigned,
+                    std::vector<zoneV> &&>(),
+           py::arg("name"), py::arg("cellDimension"),
+           py::arg("physicalDimension"), py::arg("zones"),
+           "the zones are moved into the base and left empty")
+      .def_readwrite("name", &base::name)
+      .def_readonly("cellDimension", &base::cellDimension)
+      .def_readonly("physicalDimension", &base::physicalDimension)
+      .def_property_readonly("zones",
+                             [](py::object self) {
+                               return variantReferences(
+                                   self.cast<base &>().zones, self);
+                             })
+      .def_property_readonly("families", [](py::object self) {
+        return references(self.cast<base &>().families, self);
+      });
+
+  py::class_<root>(m, "root")
+      .def(py::init<>())
+      .def(py::init([](std::vector<base> &&bases) {
+             return root{std::move(bases)};
+           }),
+           py::arg("bases"), "the bases are moved into the root and left empty")
+      .def_property_readonly("bases", [](py::object self) {
+        return references(self.cast<root &>().bases, self);
+      });
+
+  // the cgns calls are serialized internally, the GIL is released so that
+  // python threads can parse and write concurrently
+  m.def(
+      "parse",
+      [](const std::string &path, const bool lazy, const unsigned nThreads,
+         std::optional<std::vector<std::string>> fields) {
+        return parse(path, {lazy, nThreads, std::move(fields)});
+      },
+      py::arg("path"), py::arg("lazy") = false, py::arg("nThreads") = 1,
+      py::arg("fields") = std::nullopt,
+      py::call_guard<py::gil_scoped_release>(),
+      "parse a cgns file into a root");
+
+  m.def(
+      "writeFile",
+      [](const std::string &path, const root &r, const bool single) {
+        writeOptions options{};
+        if (single) {
+          options.precision = outputPrecision::single;
+        }
+        writeFile(path, r, options);
+      },
+      py::arg("path"), py::arg("root"), py::arg("single") = false,
+      py::call_guard<py::gil_scoped_release>(),
+      "write a root to a cgns file, optionally in single precision");
 
-  // m.def("add", &add, "A function that adds two numbers");
+  m.def(
+      "update",
+      [](const std::string &path, const root &r, const bool skipUnloaded,
+         const bool storeHashes) {
+        const auto stats = update(path, r, {skipUnloaded, storeHashes});
+        return std::make_pair(stats.nArrays, stats.nWritten);
+      },
+      py::arg("path"), py::arg("root"), py::arg("skipUnloaded") = true,
+      py::arg("storeHashes") = true, py::call_guard<py::gil_scoped_release>(),
+      "rewrite only the arrays of an existing file whose content changed, "
+      "returns the number of compared and rewritten arrays");
 }
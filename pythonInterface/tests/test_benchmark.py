@@ -0,0 +1,50 @@
+# Copyright (c) 2022 Pascal Post
+# This code is licensed under MIT license (see LICENSE.txt for details)
+
+# coordinate reads through cgns-tools compared to h5py, requires
+# pytest-benchmark and h5py:
+#   PYTHONPATH=<build>/pythonInterface pytest pythonInterface/tests/test_benchmark.py
+
+import pytest
+import numpy as np
+import cgns_tools_pySDK as m
+
+from test_module import cube
+
+h5py = pytest.importorskip("h5py")
+
+N = 65
+ZONES = 16
+NAMES = ("CoordinateX", "CoordinateY", "CoordinateZ")
+
+
+@pytest.fixture(scope="module")
+def mesh(tmp_path_factory):
+    path = str(tmp_path_factory.mktemp("bench") / "mesh.cgns")
+    m.writeFile(path, cube(N, ZONES))
+    return path
+
+
+def read_cgns_tools(path):
+    total = 0.0
+    for zone in m.parse(path).bases[0].zones:
+        for da in zone.gridCoordinates[0].dataArrays:
+            total += np.asarray(da)[-1]
+    return total
+
+
+def read_h5py(path):
+    total = 0.0
+    with h5py.File(path, "r") as f:
+        for z in range(ZONES):
+            for name in NAMES:
+                total += f[f"Base/Zone{z + 1}/GridCoordinates/{name}/ data"][()][-1]
+    return total
+
+
+def test_cgns_tools(benchmark, mesh):
+    assert benchmark(read_cgns_tools, mesh) == pytest.approx(read_h5py(mesh))
+
+
+def test_h5py(benchmark, mesh):
+    benchmark(read_h5py, mesh)
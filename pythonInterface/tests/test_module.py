@@ -0,0 +1,79 @@
+# Copyright (c) 2022 Pascal Post
+# This code is licensed under MIT license (see LICENSE.txt for details)
+
+# run with the build directory of the module on the PYTHONPATH:
+#   PYTHONPATH=<build>/pythonInterface pytest pythonInterface/tests
+
+import threading
+
+import numpy as np
+import cgns_tools_pySDK as m
+
+
+def cube(n, nZones=1):
+    """root of nZones cartesian n^3 zones"""
+    i, j, k = np.meshgrid(*(np.linspace(0.0, 1.0, n),) * 3, indexing="ij")
+    zones = []
+    for z in range(nZones):
+        # i fastest, i.e. fortran order of (i, j, k)
+        arrays = [m.dataArrayDouble(name, np.ravel(c + z * (name == "CoordinateX"), order="F"))
+                  for name, c in zip(("CoordinateX", "CoordinateY", "CoordinateZ"), (i, j, k))]
+        grid = m.gridCoordinates("GridCoordinates", arrays)
+        zones.append(m.zoneStructured(f"Zone{z + 1}", [n] * 3, [n - 1] * 3, [0] * 3, [grid]))
+    return m.root([m.base("Base", 3, 3, zones)])
+
+
+def test_roundtrip(tmp_path):
+    path = str(tmp_path / "cube.cgns")
+    m.writeFile(path, cube(9))
+
+    r = m.parse(path)
+    zone = r.bases[0].zones[0]
+    assert zone.nVertex == [9, 9, 9]
+
+    x = np.asarray(zone.gridCoordinates[0].dataArrays[0])
+    assert x.dtype == np.float64
+    assert x.size == 9**3
+    assert x[8] == 1.0
+
+
+def test_zero_copy(tmp_path):
+    path = str(tmp_path / "cube.cgns")
+    m.writeFile(path, cube(5))
+
+    da = m.parse(path).bases[0].zones[0].gridCoordinates[0].dataArrays[0]
+    a = np.asarray(da)
+    b = np.asarray(da)
+    assert np.shares_memory(a, b)
+
+    # views write through to the array
+    a[0] = 42.0
+    assert np.asarray(da)[0] == 42.0
+
+
+def test_single_precision(tmp_path):
+    path = str(tmp_path / "cube.cgns")
+    m.writeFile(path, cube(5), single=True)
+
+    da = m.parse(path).bases[0].zones[0].gridCoordinates[0].dataArrays[0]
+    assert isinstance(da, m.dataArrayFloat)
+    assert np.asarray(da).dtype == np.float32
+
+
+def test_concurrent_parse(tmp_path):
+    paths = [str(tmp_path / f"cube{n}.cgns") for n in range(4)]
+    for path in paths:
+        m.writeFile(path, cube(17, 4))
+
+    roots = [None] * len(paths)
+
+    def read(n):
+        roots[n] = m.parse(paths[n])
+
+    threads = [threading.Thread(target=read, args=(n,)) for n in range(len(paths))]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    assert all(len(r.bases[0].zones) == 4 for r in roots)